@@ -0,0 +1,56 @@
+/* Throughput benchmark (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _BENCH_H
+#define _BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define MAX_STAGES 5 /* DEGA is the longest chain */
+#define MAX_SYNTHETIC_SIZES 8
+
+typedef struct stage_t
+{
+  const char *name; /* NULL terminates lists which are shorter than MAX_STAGES */
+  int encode;
+  int adaptive;
+} stage_t;
+
+typedef struct chain_t
+{
+  const char *name;
+  stage_t stages[MAX_STAGES];
+} chain_t;
+
+typedef struct bench_parameters_t
+{
+  FILE *error_log_file;
+  FILE *output_file;
+  size_t min_repetitions;
+  double min_time; /* Seconds */
+  int csv_output;
+  const char *filter; /* Only benchmarks whose name contains this string (NULL for all) */
+  size_t synthetic_sizes[MAX_SYNTHETIC_SIZES]; /* Number of values */
+  size_t num_synthetic_sizes;
+  const char * const *input_file_names;
+  size_t num_input_files;
+} bench_parameters_t;
+
+typedef struct memory_t
+{
+  uint8_t *data;
+  size_t size; /* Used bytes */
+  size_t capacity;
+} memory_t;
+
+typedef struct bench_result_t
+{
+  size_t input_size;
+  size_t output_size;
+  size_t num_runs;
+  double min_seconds; /* Fastest run */
+} bench_result_t;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+/* Synthetic load data generators (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _SYNTH_H
+#define _SYNTH_H
+
+#include <stddef.h>
+
+typedef enum synthetic_data_type_t
+{
+  SDT_RANDOM_WALK = 0, /* Small random changes from one value to the next */
+  SDT_STEP_LOADS, /* Constant load levels (e.g., appliances switching on and off) with little noise */
+  SDT_NOISY_PLATEAUS, /* Long plateaus of random height with strong noise */
+  NUM_SYNTHETIC_DATA_TYPES
+} synthetic_data_type_t;
+
+const char *GetSyntheticDataName(const synthetic_data_type_t type);
+char *GenerateSyntheticData(const synthetic_data_type_t type, const size_t num_values, size_t * const size); /* Returns num_values lines with one value with two decimal places each (or NULL if memory allocation fails); the same parameters always yield the same data. The caller has to free the returned data */
+
+#endif
\ No newline at end of file
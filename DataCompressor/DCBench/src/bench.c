@@ -0,0 +1,504 @@
+/* Throughput benchmark for encoders/decoders and chains of them
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "err_codes.h"
+#include "io.h"
+#include "log.h"
+#include "pipeline.h"
+#include "timer.h"
+#include "synth.h"
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_BENCHMARK_NAME_LENGTH 64
+
+static const size_t DEFAULT_MIN_REPETITIONS = 3;
+static const double DEFAULT_MIN_TIME = 0.2; /* Seconds */
+static const size_t DEFAULT_SYNTHETIC_SIZES[] = { 10000, 100000, 1000000 };
+
+static const chain_t codec_inputs[] = { /* Stages which create the input of each encoder from CSV input (the decoder reads the output of the encoder). Sorted by name like the encoders/decoders of DCLib */
+  { "aggregate", { { "csv", 0, 0 } } },
+  { "bac", { { "csv", 0, 0 }, { "normalize", 1, 0 }, { "diff", 1, 0 }, { "seg", 1, 0 } } },
+  { "copy", { { NULL, 0, 0 } } },
+  { "csv", { { "csv", 0, 0 } } },
+  { "diff", { { "csv", 0, 0 }, { "normalize", 1, 0 } } },
+  { "lzmh", { { NULL, 0, 0 } } },
+  { "normalize", { { "csv", 0, 0 } } },
+  { "seg", { { "csv", 0, 0 }, { "normalize", 1, 0 }, { "diff", 1, 0 } } }
+};
+
+static const chain_t chains[] = { /* As described in the readme */
+  { "DEGA", { { "csv", 0, 0 }, { "normalize", 1, 0 }, { "diff", 1, 0 }, { "seg", 1, 0 }, { "bac", 1, 1 } } },
+  { "LZMH", { { "lzmh", 1, 0 } } },
+  { "A-XDR", { { "csv", 0, 0 }, { "normalize", 1, 0 } } }
+};
+
+static const chain_t value_chain = { "values", { { "csv", 0, 0 } } }; /* Counts the values of CSV input */
+
+static void PrintUsage(FILE * const error_log_file)
+{
+  LOG(error_log_file, "DataCompressor benchmark (DCBench)\n");
+  LOG(error_log_file, "Usage: [<options>] [<CSV input file> ...]\n");
+  LOG(error_log_file, "Measures the throughput of all encoders/decoders and of the DEGA, LZMH and A-XDR chains on the input files and on synthetic data\n");
+  LOG(error_log_file, "Options: --repetitions=<n>: Run each benchmark at least n times (default: %" SIZE_T_FORMAT ")\n", SIZE_T_CAST(DEFAULT_MIN_REPETITIONS));
+  LOG(error_log_file, "         --min_time=<s>: Run each benchmark for at least s seconds in total (default: %.1f)\n", DEFAULT_MIN_TIME);
+  LOG(error_log_file, "         --synthetic=<n>[,<n>...]: Generate synthetic data with n values each (default: 10000,100000,1000000; 0 disables synthetic data)\n");
+  LOG(error_log_file, "         --filter=<text>: Only run benchmarks whose name contains text (e.g., 'DEGA' or 'decode bac')\n");
+  LOG(error_log_file, "         --csv: Print comma-separated values instead of a table\n");
+  LOG(error_log_file, "Examples: ../../DCCLI/testdata/input.txt\n");
+  LOG(error_log_file, "          --synthetic=0 --repetitions=10 --filter=DEGA input.txt\n");
+}
+
+static int ParseSize(const char * const option_name, const char * const value, size_t * const size, FILE * const error_log_file)
+{
+  char *end_ptr;
+  *size = (size_t)IO_STRTOUL(value, &end_ptr, 10);
+  if (value[0] == '\0' || end_ptr == NULL || (end_ptr[0] != '\0' && end_ptr[0] != ','))
+  {
+    LOG_ERROR(error_log_file, "Invalid value '%s' for option '%s'\n", value, option_name);
+    return ERROR_INVALID_VALUE;
+  }
+  return NO_ERROR;
+}
+
+static int ParseSyntheticSizes(const char * const value, bench_parameters_t * const parameters)
+{
+  const char *current = value;
+  int ret;
+  parameters->num_synthetic_sizes = 0;
+  while (current != NULL)
+  {
+    size_t size;
+    if ((ret = ParseSize("--synthetic", current, &size, parameters->error_log_file)) != NO_ERROR)
+      return ret;
+    if (size != 0)
+    {
+      if (parameters->num_synthetic_sizes == MAX_SYNTHETIC_SIZES)
+      {
+        LOG_ERROR(parameters->error_log_file, "At most %d synthetic data sizes are supported\n", MAX_SYNTHETIC_SIZES);
+        return ERROR_INVALID_VALUE;
+      }
+      parameters->synthetic_sizes[parameters->num_synthetic_sizes++] = size;
+    }
+    if ((current = strchr(current, ',')) != NULL)
+      current++; /* Skip ',' */
+  }
+  return NO_ERROR;
+}
+
+static int ParseParameters(const size_t argc, const char * const * const argv, bench_parameters_t * const parameters)
+{
+  size_t i;
+  int ret;
+  parameters->min_repetitions = DEFAULT_MIN_REPETITIONS;
+  parameters->min_time = DEFAULT_MIN_TIME;
+  parameters->csv_output = 0;
+  parameters->filter = NULL;
+  parameters->num_synthetic_sizes = sizeof(DEFAULT_SYNTHETIC_SIZES) / sizeof(DEFAULT_SYNTHETIC_SIZES[0]);
+  memcpy(parameters->synthetic_sizes, DEFAULT_SYNTHETIC_SIZES, sizeof(DEFAULT_SYNTHETIC_SIZES));
+  for (i = 0; i < argc && strncmp(argv[i], "--", 2) == 0; i++)
+  {
+    if (strncmp(argv[i], "--repetitions=", strlen("--repetitions=")) == 0)
+    {
+      if ((ret = ParseSize("--repetitions", argv[i] + strlen("--repetitions="), &parameters->min_repetitions, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+      if (parameters->min_repetitions == 0)
+      {
+        LOG_ERROR(parameters->error_log_file, "The number of repetitions must be at least 1\n");
+        return ERROR_INVALID_VALUE;
+      }
+    }
+    else if (strncmp(argv[i], "--min_time=", strlen("--min_time=")) == 0)
+    {
+      char *end_ptr;
+      const char * const value = argv[i] + strlen("--min_time=");
+      parameters->min_time = strtod(value, &end_ptr);
+      if (value[0] == '\0' || end_ptr[0] != '\0' || parameters->min_time < 0)
+      {
+        LOG_ERROR(parameters->error_log_file, "Invalid value '%s' for option '--min_time'\n", value);
+        return ERROR_INVALID_VALUE;
+      }
+    }
+    else if (strncmp(argv[i], "--synthetic=", strlen("--synthetic=")) == 0)
+    {
+      if ((ret = ParseSyntheticSizes(argv[i] + strlen("--synthetic="), parameters)) != NO_ERROR)
+        return ret;
+    }
+    else if (strncmp(argv[i], "--filter=", strlen("--filter=")) == 0)
+      parameters->filter = argv[i] + strlen("--filter=");
+    else if (strcmp(argv[i], "--csv") == 0)
+      parameters->csv_output = 1;
+    else
+    {
+      LOG_ERROR(parameters->error_log_file, "Unknown option '%s'\n", argv[i]);
+      PrintUsage(parameters->error_log_file);
+      return ERROR_INVALID_FORMAT;
+    }
+  }
+  parameters->input_file_names = &argv[i];
+  parameters->num_input_files = argc - i;
+  if (parameters->num_input_files == 0 && parameters->num_synthetic_sizes == 0)
+  {
+    LOG_ERROR(parameters->error_log_file, "Neither input files nor synthetic data have been specified\n");
+    PrintUsage(parameters->error_log_file);
+    return ERROR_INVALID_FORMAT;
+  }
+  return NO_ERROR;
+}
+
+static void InitMemory(memory_t * const memory)
+{
+  memory->data = NULL;
+  memory->size = memory->capacity = 0;
+}
+
+static void UninitMemory(memory_t * const memory)
+{
+  free(memory->data);
+  InitMemory(memory);
+}
+
+static int ReserveMemory(memory_t * const memory, const size_t capacity, FILE * const error_log_file)
+{
+  uint8_t *new_data;
+  if (capacity <= memory->capacity)
+    return NO_ERROR;
+  if ((new_data = (uint8_t*)realloc(memory->data, capacity)) == NULL)
+  {
+    LOG_ERROR(error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes for benchmark data\n", SIZE_T_CAST(capacity));
+    return ERROR_MEMORY;
+  }
+  memory->data = new_data;
+  memory->capacity = capacity;
+  return NO_ERROR;
+}
+
+static int ReadInputFile(const char * const file_name, memory_t * const memory, FILE * const error_log_file)
+{
+  FILE * const file = FOPEN(file_name, "rb");
+  uint8_t buffer[4096];
+  size_t read;
+  int ret = NO_ERROR;
+  if (file == NULL)
+  {
+    LOG_ERROR(error_log_file, "Could not open input file '%s'\n", file_name);
+    return ERROR_FILE_IO;
+  }
+  memory->size = 0;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) != 0)
+  {
+    if ((ret = ReserveMemory(memory, memory->capacity < memory->size + read ? 2 * (memory->size + read) : memory->capacity, error_log_file)) != NO_ERROR)
+      break;
+    memcpy(&memory->data[memory->size], buffer, read);
+    memory->size += read;
+  }
+  if (ret == NO_ERROR && ferror(file))
+  {
+    LOG_ERROR(error_log_file, "Could not read input file '%s'\n", file_name);
+    ret = ERROR_FILE_IO;
+  }
+  fclose(file);
+  return ret;
+}
+
+static size_t GetNumberOfStages(const stage_t * const stages)
+{
+  size_t i;
+  for (i = 0; i < MAX_STAGES && stages[i].name != NULL; i++);
+  return i;
+}
+
+static int InitBenchmarkPipeline(pipeline_t * const pipeline, const stage_t * const stages, const size_t num_stages, options_t * const options, options_t ** const option_list, FILE * const error_log_file)
+{
+  size_t i;
+  for (i = 0; i < num_stages; i++)
+  {
+    if ((options[i].encoder_decoder = GetEncoder(stages[i].name)) == NULL)
+    {
+      LOG_ERROR(error_log_file, "Unknown encoder/decoder '%s'\n", stages[i].name);
+      return ERROR_INVALID_VALUE;
+    }
+    SetDefaultOptions(&options[i]);
+    options[i].error_log_file = error_log_file;
+    options[i].encode = stages[i].encode;
+    options[i].adaptive = stages[i].adaptive;
+    option_list[i] = &options[i];
+  }
+  return InitPipeline(pipeline, option_list, num_stages, 1, 0);
+}
+
+static int RunOnce(pipeline_t * const pipeline, const int compress, const memory_t * const input, memory_t * const output, FILE * const error_log_file) /* Grows the output memory if necessary */
+{
+  const size_t bound = GetPipelineOutputBound(pipeline, input->size, compress);
+  int ret;
+  if (output->capacity == 0 && (ret = ReserveMemory(output, bound <= 4 * input->size + 4096 ? bound + 1 : input->size + 4096, error_log_file)) != NO_ERROR) /* Very loose bounds would waste a lot of memory, so rather grow when necessary */
+    return ret;
+  for (;;)
+  {
+    if (compress)
+      ret = CompressToMemory(pipeline, input->data, input->size, output->data, output->capacity, &output->size);
+    else
+      ret = DecompressToMemory(pipeline, input->data, input->size, output->data, output->capacity, &output->size);
+    if (ret != ERROR_OUTPUT_FULL || output->capacity > bound) /* The bound always suffices */
+      return ret;
+    if ((ret = ReserveMemory(output, output->capacity > bound / 2 ? bound + 1 : 2 * output->capacity, error_log_file)) != NO_ERROR) /* Double the size and retry */
+      return ret;
+  }
+}
+
+static int Measure(const bench_parameters_t * const parameters, pipeline_t * const pipeline, const int compress, const memory_t * const input, memory_t * const output, bench_result_t * const result)
+{
+  double total_seconds = 0;
+  int ret;
+  if ((ret = RunOnce(pipeline, compress, input, output, parameters->error_log_file)) != NO_ERROR) /* Warm-up (caches, output memory) */
+    return ret;
+  result->input_size = input->size;
+  result->output_size = output->size;
+  result->num_runs = 0;
+  result->min_seconds = 0;
+  while (result->num_runs < parameters->min_repetitions || total_seconds < parameters->min_time)
+  {
+    const double start = GetWallClockTime();
+    double seconds;
+    if ((ret = RunOnce(pipeline, compress, input, output, parameters->error_log_file)) != NO_ERROR)
+      return ret;
+    seconds = GetWallClockTime() - start;
+    if (result->num_runs == 0 || seconds < result->min_seconds)
+      result->min_seconds = seconds;
+    total_seconds += seconds;
+    result->num_runs++;
+  }
+  return NO_ERROR;
+}
+
+static void PrintHeader(const bench_parameters_t * const parameters)
+{
+  if (parameters->csv_output)
+  {
+    LOG(parameters->output_file, "input,benchmark,values,input_bytes,output_bytes,runs,min_seconds,mb_per_s,values_per_s\n");
+  }
+  else
+  {
+    LOG(parameters->output_file, "%-22s %-24s %9s %11s %11s %5s %9s %12s\n", "Input", "Benchmark", "Values", "In [B]", "Out [B]", "Runs", "MB/s", "Values/s");
+  }
+}
+
+static void PrintResult(const bench_parameters_t * const parameters, const char * const input_name, const char * const benchmark_name, const size_t num_values, const bench_result_t * const result)
+{
+  const double seconds = result->min_seconds > 1e-9 ? result->min_seconds : 1e-9; /* Avoid division by zero with coarse timers */
+  const double mb_per_s = result->input_size / seconds / 1e6;
+  const double values_per_s = num_values / seconds;
+  if (parameters->csv_output)
+  {
+    LOG(parameters->output_file, "%s,%s,%" SIZE_T_FORMAT ",%" SIZE_T_FORMAT ",%" SIZE_T_FORMAT ",%" SIZE_T_FORMAT ",%.9f,%.3f,%.0f\n", input_name, benchmark_name, SIZE_T_CAST(num_values), SIZE_T_CAST(result->input_size), SIZE_T_CAST(result->output_size), SIZE_T_CAST(result->num_runs), result->min_seconds, mb_per_s, values_per_s);
+  }
+  else
+  {
+    LOG(parameters->output_file, "%-22s %-24s %9" SIZE_T_FORMAT " %11" SIZE_T_FORMAT " %11" SIZE_T_FORMAT " %5" SIZE_T_FORMAT " %9.2f %12.0f\n", input_name, benchmark_name, SIZE_T_CAST(num_values), SIZE_T_CAST(result->input_size), SIZE_T_CAST(result->output_size), SIZE_T_CAST(result->num_runs), mb_per_s, values_per_s);
+  }
+  fflush(parameters->output_file); /* Show progress of long runs */
+}
+
+static int IsSelected(const bench_parameters_t * const parameters, const char * const benchmark_name)
+{
+  return benchmark_name != NULL && (parameters->filter == NULL || strstr(benchmark_name, parameters->filter) != NULL);
+}
+
+static int RunStages(const bench_parameters_t * const parameters, const stage_t * const stages, const memory_t * const input, memory_t * const output) /* Runs the stages once without measuring (e.g., to create the input of a benchmark) */
+{
+  const size_t num_stages = GetNumberOfStages(stages);
+  options_t options[MAX_STAGES];
+  options_t *option_list[MAX_STAGES];
+  pipeline_t *pipeline;
+  int ret;
+  if (num_stages == 0) /* Use input as is */
+  {
+    if ((ret = ReserveMemory(output, input->size, parameters->error_log_file)) != NO_ERROR)
+      return ret;
+    memcpy(output->data, input->data, input->size);
+    output->size = input->size;
+    return NO_ERROR;
+  }
+  if ((pipeline = AllocatePipeline()) == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Could not allocate pipeline\n");
+    return ERROR_MEMORY;
+  }
+  if ((ret = InitBenchmarkPipeline(pipeline, stages, num_stages, options, option_list, parameters->error_log_file)) == NO_ERROR)
+  {
+    ret = RunOnce(pipeline, 1, input, output, parameters->error_log_file);
+    UninitPipeline(pipeline);
+  }
+  FreePipeline(pipeline);
+  return ret;
+}
+
+static int BenchmarkStages(const bench_parameters_t * const parameters, const char * const input_name, const size_t num_values, const stage_t * const stages, const char * const compress_name, const char * const decompress_name, const memory_t * const input, memory_t * const compressed, memory_t * const decompressed) /* Measures running the stages and, if decompress_name is not NULL, their inverse on the output */
+{
+  const int measure_decompression = IsSelected(parameters, decompress_name);
+  options_t options[MAX_STAGES];
+  options_t *option_list[MAX_STAGES];
+  bench_result_t result;
+  pipeline_t *pipeline;
+  int ret;
+  if (!IsSelected(parameters, compress_name) && !measure_decompression)
+    return NO_ERROR;
+  if ((pipeline = AllocatePipeline()) == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Could not allocate pipeline\n");
+    return ERROR_MEMORY;
+  }
+  if ((ret = InitBenchmarkPipeline(pipeline, stages, GetNumberOfStages(stages), options, option_list, parameters->error_log_file)) != NO_ERROR)
+  {
+    FreePipeline(pipeline);
+    return ret;
+  }
+  if (IsSelected(parameters, compress_name))
+  {
+    if ((ret = Measure(parameters, pipeline, 1, input, compressed, &result)) == NO_ERROR)
+      PrintResult(parameters, input_name, compress_name, num_values, &result);
+  }
+  else
+    ret = RunOnce(pipeline, 1, input, compressed, parameters->error_log_file); /* Only to create the input for decompression */
+  if (ret == NO_ERROR && measure_decompression && (ret = Measure(parameters, pipeline, 0, compressed, decompressed, &result)) == NO_ERROR)
+    PrintResult(parameters, input_name, decompress_name, num_values, &result);
+  if (ret != NO_ERROR)
+    LOG_ERROR(parameters->error_log_file, "%s while running benchmark '%s' on '%s'\n", ERROR_MESSAGE_STRING(ret), compress_name, input_name);
+  UninitPipeline(pipeline);
+  FreePipeline(pipeline);
+  return ret;
+}
+
+static const chain_t *FindCodecInput(const char * const encoder_name)
+{
+  size_t i;
+  for (i = 0; i < sizeof(codec_inputs) / sizeof(codec_inputs[0]); i++)
+    if (strcmp(codec_inputs[i].name, encoder_name) == 0)
+      return &codec_inputs[i];
+  return NULL;
+}
+
+static int BenchmarkEncoder(const bench_parameters_t * const parameters, const char * const input_name, const size_t num_values, const char * const encoder_name, const int adaptive, const memory_t * const input, memory_t * const temp, memory_t * const compressed, memory_t * const decompressed)
+{
+  const chain_t * const codec_input = FindCodecInput(encoder_name);
+  const enc_dec_t * const encoder_decoder = GetEncoder(encoder_name);
+  const char * const variant = adaptive ? " adaptive" : "";
+  char compress_name[MAX_BENCHMARK_NAME_LENGTH], decompress_name[MAX_BENCHMARK_NAME_LENGTH];
+  stage_t stages[MAX_STAGES];
+  int ret;
+  if (codec_input == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "No benchmark input has been defined for encoder/decoder '%s'. Skipping it\n", encoder_name);
+    return NO_ERROR;
+  }
+  sprintf(compress_name, "encode %s%s", encoder_name, variant);
+  sprintf(decompress_name, "decode %s%s", encoder_name, variant);
+  if (!IsSelected(parameters, compress_name) && !(encoder_decoder->decoder != NULL && IsSelected(parameters, decompress_name)))
+    return NO_ERROR;
+  if ((ret = RunStages(parameters, codec_input->stages, input, temp)) != NO_ERROR)
+  {
+    LOG_ERROR(parameters->error_log_file, "%s while creating the input for encoder '%s' from '%s'\n", ERROR_MESSAGE_STRING(ret), encoder_name, input_name);
+    return ret;
+  }
+  stages[0].name = encoder_name;
+  stages[0].encode = 1;
+  stages[0].adaptive = adaptive;
+  stages[1].name = NULL;
+  return BenchmarkStages(parameters, input_name, num_values, stages, compress_name, encoder_decoder->decoder != NULL ? decompress_name : NULL, temp, compressed, decompressed);
+}
+
+static int BenchmarkInput(const bench_parameters_t * const parameters, const char * const input_name, const memory_t * const input)
+{
+  const size_t num_encoders = GetNumberOfEncoders();
+  const char **encoder_names;
+  memory_t temp, compressed, decompressed;
+  size_t i, num_values;
+  int ret, failed = 0;
+  if ((encoder_names = (const char**)malloc(num_encoders * sizeof(const char*))) == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes while listing encoders/decoders\n", SIZE_T_CAST(num_encoders * sizeof(const char*)));
+    return ERROR_MEMORY;
+  }
+  GetEncoderNames(encoder_names);
+  InitMemory(&temp);
+  InitMemory(&compressed);
+  InitMemory(&decompressed);
+  if ((ret = RunStages(parameters, value_chain.stages, input, &temp)) != NO_ERROR)
+  {
+    LOG_ERROR(parameters->error_log_file, "%s while counting the values of '%s'\n", ERROR_MESSAGE_STRING(ret), input_name);
+    free((void*)encoder_names);
+    UninitMemory(&temp);
+    return ret;
+  }
+  num_values = temp.size / 4; /* 32-bit floats */
+  for (i = 0; i < num_encoders; i++)
+  {
+    if (BenchmarkEncoder(parameters, input_name, num_values, encoder_names[i], 0, input, &temp, &compressed, &decompressed) != NO_ERROR)
+      failed = 1;
+    if (EncoderSupportsOption(encoder_names[i], "adaptive") && BenchmarkEncoder(parameters, input_name, num_values, encoder_names[i], 1, input, &temp, &compressed, &decompressed) != NO_ERROR)
+      failed = 1;
+  }
+  for (i = 0; i < sizeof(chains) / sizeof(chains[0]); i++)
+  {
+    char compress_name[MAX_BENCHMARK_NAME_LENGTH], decompress_name[MAX_BENCHMARK_NAME_LENGTH];
+    sprintf(compress_name, "%s compress", chains[i].name);
+    sprintf(decompress_name, "%s decompress", chains[i].name);
+    if (BenchmarkStages(parameters, input_name, num_values, chains[i].stages, compress_name, decompress_name, input, &compressed, &decompressed) != NO_ERROR)
+      failed = 1;
+  }
+  free((void*)encoder_names);
+  UninitMemory(&temp);
+  UninitMemory(&compressed);
+  UninitMemory(&decompressed);
+  return failed ? ERROR_LIBRARY_CALL : NO_ERROR;
+}
+
+static const char *GetBaseName(const char * const file_name)
+{
+  const char * const slash = strrchr(file_name, '/');
+  const char * const backslash = strrchr(file_name, '\\');
+  const char * const separator = slash > backslash ? slash : backslash;
+  return separator == NULL ? file_name : separator + 1;
+}
+
+int main(const int argc, const char * const * const argv)
+{
+  bench_parameters_t parameters;
+  memory_t input;
+  size_t i, j;
+  int ret, failed = 0;
+  parameters.error_log_file = stderr;
+  parameters.output_file = stdout;
+  if ((ret = ParseParameters(argc - 1, &argv[1], &parameters)) != NO_ERROR)
+    return ret;
+  InitMemory(&input);
+  PrintHeader(&parameters);
+  for (i = 0; i < parameters.num_input_files; i++)
+  {
+    if ((ret = ReadInputFile(parameters.input_file_names[i], &input, parameters.error_log_file)) != NO_ERROR || (ret = BenchmarkInput(&parameters, GetBaseName(parameters.input_file_names[i]), &input)) != NO_ERROR)
+      failed = 1;
+  }
+  UninitMemory(&input);
+  for (i = 0; i < NUM_SYNTHETIC_DATA_TYPES; i++)
+  {
+    for (j = 0; j < parameters.num_synthetic_sizes; j++)
+    {
+      char input_name[MAX_BENCHMARK_NAME_LENGTH];
+      if ((input.data = (uint8_t*)GenerateSyntheticData((synthetic_data_type_t)i, parameters.synthetic_sizes[j], &input.size)) == NULL)
+      {
+        LOG_ERROR(parameters.error_log_file, "Error allocating memory for %" SIZE_T_FORMAT " synthetic values\n", SIZE_T_CAST(parameters.synthetic_sizes[j]));
+        failed = 1;
+        continue;
+      }
+      input.capacity = input.size;
+      sprintf(input_name, "%s/%" SIZE_T_FORMAT, GetSyntheticDataName((synthetic_data_type_t)i), SIZE_T_CAST(parameters.synthetic_sizes[j]));
+      if (BenchmarkInput(&parameters, input_name, &input) != NO_ERROR)
+        failed = 1;
+      UninitMemory(&input);
+    }
+  }
+  return failed ? ERROR_LIBRARY_CALL : NO_ERROR;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+/* Synthetic load data generators
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "synth.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_LINE_LENGTH 16 /* "100000.00\n" and some reserve */
+#define MAX_VALUE 100000.0
+
+static const uint32_t SEED = 2463534242U; /* Fixed so that all runs use the same data */
+
+static const double STEP_LEVELS[] = { 40.0, 120.0, 350.0, 900.0, 2200.0 }; /* Typical load levels in W */
+
+typedef struct random_state_t
+{
+  uint32_t state;
+} random_state_t;
+
+static double NextRandom(random_state_t * const random) /* Uniformly distributed in [0, 1) (xorshift32, which is identical on all platforms as opposed to rand) */
+{
+  random->state ^= random->state << 13;
+  random->state ^= random->state >> 17;
+  random->state ^= random->state << 5;
+  return random->state / 4294967296.0;
+}
+
+static double NextNoise(random_state_t * const random) /* Approximately normally distributed with mean 0 and variance 1 (sum of uniformly distributed values) */
+{
+  return (NextRandom(random) + NextRandom(random) + NextRandom(random) + NextRandom(random) - 2.0) * 1.7320508;
+}
+
+static double Clamp(const double value)
+{
+  return value < 0.0 ? 0.0 : (value > MAX_VALUE ? MAX_VALUE : value);
+}
+
+const char *GetSyntheticDataName(const synthetic_data_type_t type)
+{
+  switch (type)
+  {
+    case SDT_RANDOM_WALK:
+      return "random_walk";
+    case SDT_STEP_LOADS:
+      return "step_loads";
+    case SDT_NOISY_PLATEAUS:
+      return "noisy_plateaus";
+    case NUM_SYNTHETIC_DATA_TYPES:
+    default:
+      return "unknown";
+  }
+}
+
+static double NextValue(const synthetic_data_type_t type, random_state_t * const random, double * const level, size_t * const remaining)
+{
+  switch (type)
+  {
+    case SDT_RANDOM_WALK:
+      *level = Clamp(*level + (NextRandom(random) - 0.5) * 10.0);
+      return *level;
+    case SDT_STEP_LOADS:
+      if (*remaining == 0) /* Switch to another load level */
+      {
+        *level = STEP_LEVELS[(size_t)(NextRandom(random) * (sizeof(STEP_LEVELS) / sizeof(STEP_LEVELS[0])))];
+        *remaining = 10 + (size_t)(NextRandom(random) * 500);
+      }
+      (*remaining)--;
+      return Clamp(*level + NextNoise(random) * 0.5);
+    case SDT_NOISY_PLATEAUS:
+      if (*remaining == 0) /* Start a new plateau */
+      {
+        *level = 100.0 + NextRandom(random) * 2900.0;
+        *remaining = 1000 + (size_t)(NextRandom(random) * 9000);
+      }
+      (*remaining)--;
+      return Clamp(*level + NextNoise(random) * 25.0);
+    case NUM_SYNTHETIC_DATA_TYPES:
+    default:
+      return 0.0;
+  }
+}
+
+char *GenerateSyntheticData(const synthetic_data_type_t type, const size_t num_values, size_t * const size)
+{
+  random_state_t random;
+  double level = 300.0;
+  size_t i, remaining = 0;
+  char *data;
+  *size = 0;
+  if ((data = (char*)malloc(num_values * MAX_LINE_LENGTH + 1)) == NULL) /* Plus terminator of the last line */
+    return NULL;
+  random.state = SEED + (uint32_t)type;
+  for (i = 0; i < num_values; i++)
+    *size += (size_t)sprintf(&data[*size], "%.2f\n", NextValue(type, &random, &level, &remaining));
+  return data;
+}
\ No newline at end of file
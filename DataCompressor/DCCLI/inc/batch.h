@@ -0,0 +1,32 @@
+/* Batch manifest (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include "io.h"
+
+/* Manifest layout: one input and one output file name per line, separated by a tab. Empty lines are ignored.
+   Alternatively, all regular files of an input directory are listed with output files of the same name in an output directory */
+
+typedef struct batch_entry_t
+{
+  const char *in_file_name, *out_file_name; /* Point into the manifest data */
+} batch_entry_t;
+
+typedef struct batch_manifest_t
+{
+  char *data; /* Manifest file contents or generated file names, terminated */
+  batch_entry_t *entries;
+  size_t num_entries;
+} batch_manifest_t;
+
+void InitBatchManifest(batch_manifest_t * const manifest);
+void UninitBatchManifest(batch_manifest_t * const manifest);
+
+int ReadWholeFile(FILE * const file, char ** const data, size_t * const size); /* Reads until EOF and terminates the data. The caller frees *data, also on error */
+int ReadBatchManifest(batch_manifest_t * const manifest, const char * const file_name, FILE * const error_log_file); /* '-' reads the manifest from stdin */
+int ListBatchDirectory(batch_manifest_t * const manifest, const char * const in_dir_name, const char * const out_dir_name, FILE * const error_log_file); /* Entries are sorted by input file name */
+
+#endif
\ No newline at end of file
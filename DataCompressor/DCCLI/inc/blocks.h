@@ -0,0 +1,39 @@
+/* Block container format (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _BLOCKS_H
+#define _BLOCKS_H
+
+#include "bit_file_buffer.h"
+
+/* Container layout: block data (concatenated), block table (one entry per block), number of blocks, magic number.
+   All values are stored as little-endian 64-bit integers so that the table can be found from the end of the file */
+
+typedef struct block_entry_t
+{
+  io_uint_t end_offset; /* Offset of the first byte after the block data, relative to the start of the first block (i.e., after the header, if any) */
+  io_uint_t num_lines; /* Number of lines (values) in the uncompressed block */
+  io_uint_t first_line; /* Number of lines in all previous blocks (not stored) */
+} block_entry_t;
+
+typedef struct block_table_t
+{
+  block_entry_t *entries;
+  size_t num_blocks, capacity;
+} block_table_t;
+
+void InitBlockTable(block_table_t * const block_table);
+void UninitBlockTable(block_table_t * const block_table);
+
+int AddBlockToTable(block_table_t * const block_table, const io_uint_t size, const io_uint_t num_lines); /* Appends a block of size bytes after the last one */
+io_uint_t GetBlockSize(const block_table_t * const block_table, const size_t block);
+io_uint_t GetBlockOffset(const block_table_t * const block_table, const size_t block); /* Relative to the start of the first block */
+io_uint_t GetNumberOfLines(const block_table_t * const block_table); /* In all blocks */
+size_t FindBlockOfLine(const block_table_t * const block_table, const io_uint_t line); /* Returns the index of the block containing line, which must be less than GetNumberOfLines */
+int SeekToBlock(const block_table_t * const block_table, FILE * const input_file, const size_t block); /* Seeks from the start of the first block, which must be the current position, to the start of block */
+
+int WriteBlockTable(const block_table_t * const block_table, bit_file_buffer_t * const output); /* After all blocks. output must be at a byte boundary */
+int ReadBlockTable(block_table_t * const block_table, FILE * const input_file, FILE * const error_log_file); /* Reads the table from the end of the file and seeks back to the current position, which must be the start of the first block (i.e., after the header, if any). Requires a seekable file */
+
+#endif
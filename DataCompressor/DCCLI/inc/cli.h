@@ -6,18 +6,30 @@
 #define _CLI_H
 
 #include "bit_file_buffer.h"
+#include "pipeline.h"
+#include "params.h"
+
+typedef struct pipe_buffers_t /* Connects two consecutive encoders/decoders in pipeline mode */
+{
+  file_buffer_pipe_t *pipe;
+  file_buffer_t *write_buf, *read_buf;
+  bit_file_buffer_t *write_bit_buf, *read_bit_buf;
+} pipe_buffers_t;
 
 typedef struct buffer_environment_t
 {
   FILE *in_file, *out_file;
-  file_buffer_t *in_buf, *out_buf, *temp_read_buf, *temp_write_buf;
-  bit_file_buffer_t *in_bit_buf, *out_bit_buf, *temp_read_bit_buf, *temp_write_bit_buf;
+  file_buffer_t *in_buf, *out_buf;
+  bit_file_buffer_t *in_bit_buf, *out_bit_buf;
+  pipeline_t *pipeline; /* Runs the encoders/decoders one after another with temporary buffers in between (not used in pipeline mode) */
+  pipe_buffers_t *pipes; /* Used instead of the pipeline object in pipeline mode */
+  size_t num_pipes, num_initialized_pipes;
 } buffer_environment_t;
 
 void InitBufferEnvironment(buffer_environment_t * const buffer_env);
 void UninitBufferEnvironment(buffer_environment_t * const buffer_env);
 
-int InitBuffers(buffer_environment_t * const buffers, FILE * const error_log_file, const int use_temp_buffers);
+int InitBuffers(buffer_environment_t * const buffers, const parameters_t * const parameters, const int sequential, const size_t num_pipes); /* Without input/output file, the input/output buffers are kept in memory. The input buffer is then in writing mode until the caller has filled it and switched it to reading mode. The pipeline object is only initialized if sequential is not 0 */
 void UninitBuffers(buffer_environment_t * const buffers);
 
 int main(const int argc, const char * const * const argv);
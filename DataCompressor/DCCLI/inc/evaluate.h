@@ -0,0 +1,46 @@
+/* Evaluation of multiple chains of encoders/decoders (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _EVALUATE_H
+#define _EVALUATE_H
+
+#include "params.h"
+
+/* List layout: one chain of encoders/decoders per line as on the command line (e.g., 'encode lzmh' or 'decode csv # encode normalize'),
+   optionally preceded by a name and a tab. Arguments are separated by spaces (no quoting). Empty lines are ignored */
+
+typedef struct evaluation_chain_t
+{
+  const char *name; /* Points into the list data. Defaults to the chain itself */
+  options_t *options[MAX_OPTIONS];
+  size_t num_options;
+} evaluation_chain_t;
+
+typedef struct evaluation_list_t
+{
+  char *data, *arguments; /* List file contents (names and chains) and a copy of them split into arguments, both terminated */
+  evaluation_chain_t *chains;
+  size_t num_chains;
+} evaluation_list_t;
+
+typedef struct evaluation_result_t
+{
+  int ret; /* NO_ERROR if the chain could be run in both directions */
+  int verified; /* Set if the decompressed data is identical to the input */
+  size_t input_size, compressed_size; /* In bytes */
+  double encode_seconds, decode_seconds; /* Wall time */
+  uint64_t peak_bytes; /* Peak of the memory allocated by the evaluating thread for the chain, excluding the input and the buffers for the compressed and decompressed data */
+} evaluation_result_t;
+
+void InitEvaluationList(evaluation_list_t * const list);
+void UninitEvaluationList(evaluation_list_t * const list); /* Also frees the options of all chains */
+
+int ReadEvaluationList(evaluation_list_t * const list, const char * const file_name, FILE * const error_log_file); /* '-' reads the list from stdin */
+int CreateCandidateList(evaluation_list_t * const list, FILE * const error_log_file); /* Candidates of 'encode auto': DEGA, LZMH, A-XDR and variants with other value sizes and normalization factors */
+
+void EvaluateChain(const evaluation_chain_t * const chain, const parameters_t * const parameters, const uint8_t * const input, const size_t input_size, evaluation_result_t * const result); /* Compresses the input with the chain, decompresses the output with the inverse chain and compares it to the input. Must be called by the thread whose peak memory is to be measured */
+size_t SelectChain(const evaluation_list_t * const list, const evaluation_result_t * const results, const auto_policy_t policy); /* Index of the chain with the smallest output (AP_SIZE) or the shortest encoding time (AP_SPEED) among those which reproduce the input. list->num_chains if there is none */
+void PrintEvaluationTable(FILE * const output, const evaluation_list_t * const list, const evaluation_result_t * const results); /* One row per chain with the compressed size, the ratio (input size divided by compressed size), the encoding and decoding throughput (input size per wall time in 10^6 bytes per second; chains evaluated at the same time compete for processors and memory bandwidth, so only one thread gives numbers comparable to DCBench), peak_bytes and the round trip result */
+
+#endif
\ No newline at end of file
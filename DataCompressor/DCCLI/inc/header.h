@@ -0,0 +1,16 @@
+/* Self-describing file header (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _HEADER_H
+#define _HEADER_H
+
+#include "params.h"
+
+/* Header layout: magic number, version, flags (block container), number of encoders/decoders and, for each encoder/decoder, its mode, name and all options with their types and values.
+   Names are stored with a leading length byte, numbers as little-endian integers (floats as their IEEE 754 representation) */
+
+int WriteHeader(FILE * const output_file, const parameters_t * const parameters); /* At the current file position. All encoders/decoders must be invertible */
+int ReadHeader(FILE * const input_file, parameters_t * const parameters); /* From the current file position. Replaces the encoders/decoders in parameters by the inverse of the stored ones in reverse order and sets unblock for block containers */
+
+#endif
@@ -8,14 +8,46 @@
 #include "enc_dec.h"
 
 #define MAX_OPTIONS 16
+#define MAX_THREADS 256
+#define DEFAULT_AUTO_SAMPLE_SIZE (1024 * 1024) /* 1 MiB */
+
+typedef enum auto_policy_t /* Criterion of 'encode auto' to select one of the candidate chains of encoders */
+{
+  AP_SIZE = 0, /* Smallest output */
+  AP_SPEED /* Shortest encoding time */
+} auto_policy_t;
 
 typedef struct parameters_t
 {
   size_t num_options;
   options_t *options[MAX_OPTIONS];
   FILE *error_log_file;
+  int prefetch_input; /* Read ahead from the input file in a separate thread */
+  int write_behind_output; /* Write to the output file in a separate thread */
+  int write_header; /* Write a header describing the encoders/decoders to the output file */
+  int auto_decode; /* Read the encoders/decoders from the input file header and invert them */
+  int auto_encode; /* Select the encoders by trial compression of the start of the input file and describe them in a header */
+  size_t auto_sample_size; /* Number of bytes at the start of the input file to be trial-compressed by 'encode auto' (0 means the whole file) */
+  auto_policy_t auto_policy;
+  int pipeline; /* Run each encoder/decoder in a separate thread and pass data on through pipes */
+  int fuse_encoders; /* Process supported chains of encoders/decoders in one pass (not in pipeline mode) */
+  size_t block_lines; /* Split the input into independently processed blocks of this number of lines (0 means no blocks) */
+  int unblock; /* Input is a block container whose blocks are processed independently */
+  int select_range; /* Only process the blocks containing the selected lines and only output these lines */
+  io_uint_t range_start, range_count; /* First line (starting at 0) and number of selected lines */
+  const char *batch_manifest_name; /* Process all input and output files listed in this manifest instead of a single pair (NULL means no batch mode) */
+  const char *batch_in_dir_name, *batch_out_dir_name; /* Alternatively, process all files in the input directory and write them to the output directory (NULL means no batch mode) */
+  const char *evaluation_list_name; /* Evaluate all chains of encoders/decoders listed in this file on the input file instead of processing it (NULL means no evaluation mode) */
+  size_t num_threads; /* Number of blocks, batch files or evaluated chains to be processed in parallel (0 means the number of processors) */
+  size_t memory_budget; /* Maximum number of bytes to be kept in memory by the temporary buffers before spilling to temporary files (0 means unlimited) */
+  int json_stats; /* Print the statistics of each encoder/decoder in JSON format instead of the diagnostic output */
+  int perf_counters; /* Add hardware performance counters to the JSON statistics */
 } parameters_t;
 
-int ProcessParameters(const int argc, const char * const * const argv, parameters_t * const parameters, FILE ** const in_file, FILE ** const out_file);
+#define BATCH_MODE(parameters) ((parameters)->batch_manifest_name != NULL || (parameters)->batch_in_dir_name != NULL)
+#define EVALUATION_MODE(parameters) ((parameters)->evaluation_list_name != NULL)
+
+int ProcessParameters(const int argc, const char * const * const argv, parameters_t * const parameters, FILE ** const in_file, FILE ** const out_file); /* No files are opened in batch mode. No output file is opened in evaluation mode */
+int ParseEncoderChain(const size_t argc, const char * const * const argv, options_t ** const options, size_t * const num_options, FILE * const error_log_file); /* Appends one options_t per encoder/decoder (separated by '#') to options (MAX_OPTIONS elements). On error, num_options includes the options allocated so far so that they can be freed */
 
 #endif
\ No newline at end of file
@@ -0,0 +1,64 @@
+/* Machine-readable statistics (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _STATS_H
+#define _STATS_H
+
+#include "params.h"
+#include "perf_counters.h"
+#include "allocation.h"
+
+typedef enum stats_buffer_t /* Buffer groups whose sizes are tracked */
+{
+  SB_INPUT = 0,
+  SB_OUTPUT,
+  SB_TEMPORARY, /* Both temporary buffers of the pipeline object */
+  SB_PIPES, /* All pipes in pipeline mode */
+  SB_TOTAL,
+  NUM_STATS_BUFFERS
+} stats_buffer_t;
+
+typedef struct stage_stats_t /* One encoder/decoder or a fused chain of encoders/decoders */
+{
+  size_t first_option, num_options;
+  double start_wall_time, start_processor_time; /* Only used while running */
+  double wall_seconds, processor_seconds; /* processor_seconds is negative if unknown (stages running in parallel) */
+  io_uint_t input_bits, output_bits;
+  size_t max_buffer_sizes[NUM_STATS_BUFFERS]; /* High-water marks in bytes */
+  perf_counter_values_t perf_counter_values;
+  int allocations_known; /* Not set if the stage ran at the same time as others (pipeline mode) */
+  allocation_stats_t start_allocations; /* Only used while running */
+  allocation_stats_t allocations; /* Differences to start_allocations, except for current_bytes and peak_bytes */
+} stage_stats_t;
+
+typedef struct run_stats_t
+{
+  const char *mode;
+  const options_t * const *options;
+  size_t num_options;
+  size_t num_stages; /* 0 if only the total is known (block and batch mode) */
+  stage_stats_t stages[MAX_OPTIONS];
+  stage_stats_t total;
+  int perf_counters; /* Set if hardware performance counters are measured */
+  perf_counters_t stage_counters; /* Counts the calling thread of StartRunStatistics only */
+  perf_counters_t total_counters; /* Also counts all threads started after StartRunStatistics */
+  uint64_t peak_allocated_bytes; /* Of the run before the peak has been reset by the last stage */
+} run_stats_t;
+
+void StartRunStatistics(run_stats_t * const stats, const char * const mode, const parameters_t * const parameters);
+void FinishRunStatistics(run_stats_t * const stats); /* Also determines the total high-water marks from those of the stages. Must be called even if the run failed */
+
+void StartStageStatistics(stage_stats_t * const stage, const size_t first_option, const size_t num_options);
+void FinishStageStatistics(stage_stats_t * const stage);
+void StartStageAllocationStatistics(run_stats_t * const stats, stage_stats_t * const stage); /* Only for stages which do not run at the same time as others */
+void FinishStageAllocationStatistics(stage_stats_t * const stage);
+
+void UpdateHighWaterMarks(size_t * const max_buffer_sizes, const size_t * const buffer_sizes); /* Both with NUM_STATS_BUFFERS elements */
+
+/* Writes the mode, one object per stage in "stages" (identified by the 1-based "first" and "last" encoder/decoder and the "name") and the sum of all stages in "total". Each object contains "wall_seconds" (monotonic clock), "cpu_seconds" (processor time of the whole process), "input_bits", "output_bits", "values", "bits_per_value", "input_bytes_per_second", "values_per_second", "buffer_high_water_bytes" (sampled before and after each stage), "allocations" (of DCIOLib and DCLib, see allocation.h) and, if measured, "perf_counters".
+   "total" also contains "peak_resident_bytes" of the whole process (including memory-mapped input files), which is the better basis for memory limits than the tracked allocations.
+   Values are only known at stage boundaries with values of fixed size (e.g., after decode csv or encode diff). Unknown numbers are null, e.g., the values of a fused chain or the processor time and allocations of stages running at the same time (pipeline mode). Block and batch mode only report the total (high-water marks sampled after each round of blocks or each file) */
+void WriteStatisticsJSON(FILE * const output, const run_stats_t * const stats);
+
+#endif
\ No newline at end of file
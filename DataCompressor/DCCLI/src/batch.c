@@ -0,0 +1,278 @@
+/* Batch manifest
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "err_codes.h"
+#include "batch.h"
+#include "log.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+  #include <windows.h>
+  #define PATH_SEPARATORS "\\/"
+#else
+  #include <dirent.h>
+  #include <sys/stat.h>
+  #define PATH_SEPARATORS "/"
+#endif
+
+static const size_t INITIAL_DATA_SIZE = 64 * 1024; /* 64 KiB */
+static const size_t INITIAL_CAPACITY = 256; /* Entries */
+
+void InitBatchManifest(batch_manifest_t * const manifest)
+{
+  manifest->data = NULL;
+  manifest->entries = NULL;
+  manifest->num_entries = 0;
+}
+
+void UninitBatchManifest(batch_manifest_t * const manifest)
+{
+  free(manifest->entries);
+  free(manifest->data);
+  InitBatchManifest(manifest);
+}
+
+int ReadWholeFile(FILE * const file, char ** const data, size_t * const size)
+{
+  size_t capacity = INITIAL_DATA_SIZE, read_size;
+  char *new_data;
+  *size = 0;
+  if ((*data = (char*)malloc(capacity)) == NULL)
+    return ERROR_MEMORY;
+  while ((read_size = fread(*data + *size, 1, capacity - *size - 1, file)) != 0) /* Keep one byte for the terminator */
+  {
+    *size += read_size;
+    if (*size == capacity - 1)
+    {
+      if (capacity > MAX_USABLE_SIZE / 2)
+        return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+      if ((new_data = (char*)realloc(*data, 2 * capacity)) == NULL)
+        return ERROR_MEMORY;
+      *data = new_data;
+      capacity *= 2;
+    }
+  }
+  if (ferror(file))
+    return ERROR_FILE_IO;
+  (*data)[*size] = '\0';
+  return NO_ERROR;
+}
+
+static int AddBatchEntry(batch_manifest_t * const manifest, size_t * const capacity, const char * const in_file_name, const char * const out_file_name)
+{
+  if (manifest->num_entries == *capacity)
+  {
+    const size_t new_capacity = *capacity == 0 ? INITIAL_CAPACITY : 2 * *capacity;
+    batch_entry_t *entries;
+    if (new_capacity > MAX_USABLE_SIZE / sizeof(batch_entry_t))
+      return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+    if ((entries = (batch_entry_t*)realloc(manifest->entries, new_capacity * sizeof(batch_entry_t))) == NULL)
+      return ERROR_MEMORY;
+    manifest->entries = entries;
+    *capacity = new_capacity;
+  }
+  manifest->entries[manifest->num_entries].in_file_name = in_file_name;
+  manifest->entries[manifest->num_entries].out_file_name = out_file_name;
+  manifest->num_entries++;
+  return NO_ERROR;
+}
+
+static int ParseBatchManifest(batch_manifest_t * const manifest, const size_t size, FILE * const error_log_file)
+{
+  char *line = manifest->data;
+  size_t capacity = 0, line_number = 1;
+  int ret;
+  while (line < manifest->data + size)
+  {
+    char * const line_end = line + strcspn(line, "\n");
+    char *separator;
+    if (line_end > line && line_end[-1] == '\r') /* Allow Windows line endings */
+      line_end[-1] = '\0';
+    *line_end = '\0';
+    if (line[0] != '\0') /* Skip empty lines */
+    {
+      if ((separator = strchr(line, '\t')) == NULL || separator == line || separator[1] == '\0' || strchr(separator + 1, '\t') != NULL)
+      {
+        LOG_ERROR(error_log_file, "Expected '<input file><tab><output file>' in line %" SIZE_T_FORMAT " of the batch manifest\n", SIZE_T_CAST(line_number));
+        return ERROR_INVALID_FORMAT;
+      }
+      *separator = '\0';
+      if ((ret = AddBatchEntry(manifest, &capacity, line, separator + 1)) != NO_ERROR)
+      {
+        LOG_ERROR(error_log_file, "%s while adding line %" SIZE_T_FORMAT " of the batch manifest\n", ERROR_MESSAGE_STRING(ret), SIZE_T_CAST(line_number));
+        return ret;
+      }
+    }
+    line = line_end + 1;
+    line_number++;
+  }
+  return NO_ERROR;
+}
+
+int ReadBatchManifest(batch_manifest_t * const manifest, const char * const file_name, FILE * const error_log_file)
+{
+  const int use_stdin = strcmp(file_name, "-") == 0;
+  FILE * const manifest_file = use_stdin ? stdin : FOPEN(file_name, "rb");
+  size_t size;
+  int ret;
+  if (manifest_file == NULL)
+  {
+    LOG_ERROR(error_log_file, "Could not open batch manifest '%s'\n", file_name);
+    return ERROR_FILE_IO;
+  }
+  ret = ReadWholeFile(manifest_file, &manifest->data, &size);
+  if (!use_stdin)
+    fclose(manifest_file);
+  if (ret != NO_ERROR)
+  {
+    LOG_ERROR(error_log_file, "%s while reading batch manifest '%s'\n", ERROR_MESSAGE_STRING(ret), file_name);
+    UninitBatchManifest(manifest);
+    return ret;
+  }
+  if ((ret = ParseBatchManifest(manifest, size, error_log_file)) != NO_ERROR)
+  {
+    UninitBatchManifest(manifest);
+    return ret;
+  }
+  if (manifest->num_entries == 0)
+  {
+    LOG_ERROR(error_log_file, "The batch manifest '%s' does not contain any files\n", file_name);
+    UninitBatchManifest(manifest);
+    return ERROR_INVALID_FORMAT;
+  }
+  return NO_ERROR;
+}
+
+static int AppendPath(char ** const data, size_t * const size, size_t * const capacity, const char * const dir_name, const char * const file_name) /* Appends the terminated path of the file in the directory */
+{
+  const size_t dir_length = strlen(dir_name), file_length = strlen(file_name);
+  const int add_separator = dir_length != 0 && strchr(PATH_SEPARATORS, dir_name[dir_length - 1]) == NULL;
+  const size_t path_size = dir_length + add_separator + file_length + 1;
+  if (path_size > MAX_USABLE_SIZE - *size)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if (*size + path_size > *capacity)
+  {
+    size_t new_capacity = *capacity == 0 ? INITIAL_DATA_SIZE : *capacity;
+    char *new_data;
+    while (new_capacity < *size + path_size)
+    {
+      if (new_capacity > MAX_USABLE_SIZE / 2)
+        return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+      new_capacity *= 2;
+    }
+    if ((new_data = (char*)realloc(*data, new_capacity)) == NULL)
+      return ERROR_MEMORY;
+    *data = new_data;
+    *capacity = new_capacity;
+  }
+  memcpy(*data + *size, dir_name, dir_length);
+  if (add_separator)
+    (*data)[*size + dir_length] = PATH_SEPARATORS[0];
+  memcpy(*data + *size + dir_length + add_separator, file_name, file_length);
+  (*data)[*size + path_size - 1] = '\0';
+  *size += path_size;
+  return NO_ERROR;
+}
+
+static int AppendDirectoryEntry(batch_manifest_t * const manifest, size_t * const size, size_t * const capacity, const char * const in_dir_name, const char * const out_dir_name, const char * const file_name)
+{
+  int ret;
+  if ((ret = AppendPath(&manifest->data, size, capacity, in_dir_name, file_name)) != NO_ERROR)
+    return ret;
+  return AppendPath(&manifest->data, size, capacity, out_dir_name, file_name);
+}
+
+#ifdef _WIN32
+static int ReadDirectory(batch_manifest_t * const manifest, size_t * const size, const char * const in_dir_name, const char * const out_dir_name) /* Appends the input and output paths of all regular files in the input directory */
+{
+  WIN32_FIND_DATAA find_data;
+  HANDLE find_handle;
+  size_t capacity = 0, pattern_size = 0, pattern_capacity = 0;
+  char *pattern = NULL;
+  int ret;
+  if ((ret = AppendPath(&pattern, &pattern_size, &pattern_capacity, in_dir_name, "*")) != NO_ERROR)
+    return ret;
+  find_handle = FindFirstFileA(pattern, &find_data);
+  free(pattern);
+  if (find_handle == INVALID_HANDLE_VALUE)
+    return GetLastError() == ERROR_FILE_NOT_FOUND ? NO_ERROR : ERROR_FILE_IO;
+  do
+  {
+    if ((find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0 && (ret = AppendDirectoryEntry(manifest, size, &capacity, in_dir_name, out_dir_name, find_data.cFileName)) != NO_ERROR)
+    {
+      FindClose(find_handle);
+      return ret;
+    }
+  } while (FindNextFileA(find_handle, &find_data));
+  FindClose(find_handle);
+  return NO_ERROR;
+}
+#else
+static int IsRegularFile(const char * const path)
+{
+  struct stat file_info;
+  return stat(path, &file_info) == 0 && S_ISREG(file_info.st_mode);
+}
+
+static int ReadDirectory(batch_manifest_t * const manifest, size_t * const size, const char * const in_dir_name, const char * const out_dir_name) /* Appends the input and output paths of all regular files in the input directory */
+{
+  DIR * const dir = opendir(in_dir_name);
+  struct dirent *dir_entry;
+  size_t capacity = 0;
+  int ret;
+  if (dir == NULL)
+    return ERROR_FILE_IO;
+  while ((dir_entry = readdir(dir)) != NULL)
+  {
+    const size_t entry_start = *size;
+    if ((ret = AppendDirectoryEntry(manifest, size, &capacity, in_dir_name, out_dir_name, dir_entry->d_name)) != NO_ERROR)
+    {
+      closedir(dir);
+      return ret;
+    }
+    if (!IsRegularFile(manifest->data + entry_start)) /* Skip directories (including . and ..) and special files */
+      *size = entry_start;
+  }
+  closedir(dir);
+  return NO_ERROR;
+}
+#endif
+
+static int CompareBatchEntries(const void * const entry1, const void * const entry2)
+{
+  return strcmp(((const batch_entry_t*)entry1)->in_file_name, ((const batch_entry_t*)entry2)->in_file_name);
+}
+
+int ListBatchDirectory(batch_manifest_t * const manifest, const char * const in_dir_name, const char * const out_dir_name, FILE * const error_log_file)
+{
+  const char *path;
+  size_t size = 0, capacity = 0;
+  int ret;
+  if ((ret = ReadDirectory(manifest, &size, in_dir_name, out_dir_name)) != NO_ERROR)
+  {
+    LOG_ERROR(error_log_file, "%s while listing input directory '%s'\n", ERROR_MESSAGE_STRING(ret), in_dir_name);
+    UninitBatchManifest(manifest);
+    return ret;
+  }
+  for (path = manifest->data; path < manifest->data + size; path += strlen(path) + 1) /* Pointers are only set after the data has stopped moving */
+  {
+    const char * const out_path = path + strlen(path) + 1;
+    if ((ret = AddBatchEntry(manifest, &capacity, path, out_path)) != NO_ERROR)
+    {
+      LOG_ERROR(error_log_file, "%s while adding file '%s' of the input directory\n", ERROR_MESSAGE_STRING(ret), path);
+      UninitBatchManifest(manifest);
+      return ret;
+    }
+    path = out_path;
+  }
+  if (manifest->num_entries == 0)
+  {
+    LOG_ERROR(error_log_file, "The input directory '%s' does not contain any files\n", in_dir_name);
+    UninitBatchManifest(manifest);
+    return ERROR_INVALID_FORMAT;
+  }
+  qsort(manifest->entries, manifest->num_entries, sizeof(batch_entry_t), &CompareBatchEntries); /* Independent of the order of the file system */
+  return NO_ERROR;
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+/* Block container format
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "err_codes.h"
+#include "blocks.h"
+#include "log.h"
+
+#include <string.h>
+
+#define VALUE_SIZE 8 /* Bytes per stored value */
+#define ENTRY_SIZE (2 * VALUE_SIZE)
+#define MAGIC_SIZE 4
+#define TRAILER_SIZE (VALUE_SIZE + MAGIC_SIZE) /* Number of blocks and magic number */
+
+static const uint8_t magic[MAGIC_SIZE] = { 'D', 'C', 'B', 'K' };
+
+static const size_t INITIAL_CAPACITY = 16; /* Blocks */
+
+void InitBlockTable(block_table_t * const block_table)
+{
+  block_table->entries = NULL;
+  block_table->num_blocks = block_table->capacity = 0;
+}
+
+void UninitBlockTable(block_table_t * const block_table)
+{
+  free(block_table->entries);
+  InitBlockTable(block_table);
+}
+
+static int ReserveBlockTable(block_table_t * const block_table, const size_t capacity)
+{
+  block_entry_t *entries;
+  if (capacity > MAX_USABLE_SIZE / sizeof(block_entry_t))
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if ((entries = (block_entry_t*)realloc(block_table->entries, capacity * sizeof(block_entry_t))) == NULL)
+    return ERROR_MEMORY;
+  block_table->entries = entries;
+  block_table->capacity = capacity;
+  return NO_ERROR;
+}
+
+int AddBlockToTable(block_table_t * const block_table, const io_uint_t size, const io_uint_t num_lines)
+{
+  const io_uint_t start_offset = GetBlockOffset(block_table, block_table->num_blocks);
+  const io_uint_t first_line = GetNumberOfLines(block_table);
+  int ret;
+  if (block_table->num_blocks == block_table->capacity && (ret = ReserveBlockTable(block_table, block_table->capacity == 0 ? INITIAL_CAPACITY : 2 * block_table->capacity)) != NO_ERROR)
+    return ret;
+  block_table->entries[block_table->num_blocks].end_offset = start_offset + size;
+  block_table->entries[block_table->num_blocks].num_lines = num_lines;
+  block_table->entries[block_table->num_blocks].first_line = first_line;
+  block_table->num_blocks++;
+  return NO_ERROR;
+}
+
+io_uint_t GetBlockSize(const block_table_t * const block_table, const size_t block)
+{
+  return block_table->entries[block].end_offset - GetBlockOffset(block_table, block);
+}
+
+io_uint_t GetBlockOffset(const block_table_t * const block_table, const size_t block)
+{
+  return block == 0 ? 0 : block_table->entries[block - 1].end_offset;
+}
+
+io_uint_t GetNumberOfLines(const block_table_t * const block_table)
+{
+  if (block_table->num_blocks == 0)
+    return 0;
+  return block_table->entries[block_table->num_blocks - 1].first_line + block_table->entries[block_table->num_blocks - 1].num_lines;
+}
+
+size_t FindBlockOfLine(const block_table_t * const block_table, const io_uint_t line)
+{
+  size_t first = 0, last = block_table->num_blocks - 1;
+  while (first < last) /* Binary search for the last block starting at or before line */
+  {
+    const size_t middle = first + (last - first + 1) / 2;
+    if (block_table->entries[middle].first_line <= line)
+      first = middle;
+    else
+      last = middle - 1;
+  }
+  return first;
+}
+
+int SeekToBlock(const block_table_t * const block_table, FILE * const input_file, const size_t block)
+{
+  const io_int_t current_offset = FTELL(input_file);
+  if (current_offset < 0 || FSEEK(input_file, current_offset + (io_int_t)GetBlockOffset(block_table, block), SEEK_SET) != 0)
+    return ERROR_FILE_IO;
+  return NO_ERROR;
+}
+
+static void StoreValue(uint8_t * const bytes, const io_uint_t value)
+{
+  size_t i;
+  for (i = 0; i < VALUE_SIZE; i++) /* Little endian */
+    bytes[i] = (uint8_t)(i < sizeof(io_uint_t) ? value >> (8 * i) : 0);
+}
+
+static int LoadValue(const uint8_t * const bytes, io_uint_t * const value)
+{
+  size_t i;
+  *value = 0;
+  for (i = 0; i < VALUE_SIZE; i++)
+  {
+    if (i >= sizeof(io_uint_t))
+    {
+      if (bytes[i] != 0)
+        return ERROR_VALUE_LARGER_THAN_USABLE_SIZE; /* Does not fit into io_uint_t */
+    }
+    else
+      *value |= (io_uint_t)bytes[i] << (8 * i);
+  }
+  return NO_ERROR;
+}
+
+static int WriteBytes(bit_file_buffer_t * const output, const uint8_t * const bytes, const size_t size)
+{
+  const io_int_t ret = WriteBitFileBuffer(output, bytes, 8 * size);
+  if (ret < 0)
+    return (int)ret;
+  return (size_t)ret == 8 * size ? NO_ERROR : ERROR_FILE_IO;
+}
+
+int WriteBlockTable(const block_table_t * const block_table, bit_file_buffer_t * const output)
+{
+  uint8_t entry[ENTRY_SIZE];
+  uint8_t trailer[TRAILER_SIZE];
+  size_t i;
+  int ret;
+  for (i = 0; i < block_table->num_blocks; i++)
+  {
+    StoreValue(entry, block_table->entries[i].end_offset);
+    StoreValue(entry + VALUE_SIZE, block_table->entries[i].num_lines);
+    if ((ret = WriteBytes(output, entry, ENTRY_SIZE)) != NO_ERROR)
+      return ret;
+  }
+  StoreValue(trailer, block_table->num_blocks);
+  memcpy(trailer + VALUE_SIZE, magic, MAGIC_SIZE);
+  return WriteBytes(output, trailer, TRAILER_SIZE);
+}
+
+static int ReadBytesAt(FILE * const input_file, const io_int_t offset, uint8_t * const bytes, const size_t size)
+{
+  if (FSEEK(input_file, offset, SEEK_SET) != 0 || fread(bytes, 1, size, input_file) != size)
+    return ERROR_FILE_IO;
+  return NO_ERROR;
+}
+
+static int CheckBlockTable(block_table_t * const block_table, const io_uint_t table_offset) /* Also determines the first line of each block */
+{
+  size_t i;
+  for (i = 0; i < block_table->num_blocks; i++)
+  {
+    block_entry_t * const current_entry = &block_table->entries[i];
+    const io_uint_t first_line = i == 0 ? 0 : block_table->entries[i - 1].first_line + block_table->entries[i - 1].num_lines;
+    if (current_entry->end_offset < GetBlockOffset(block_table, i) || current_entry->end_offset > table_offset || first_line + current_entry->num_lines < first_line) /* Overlap, beyond table or overflow */
+      return ERROR_INVALID_FORMAT;
+    current_entry->first_line = first_line;
+  }
+  return NO_ERROR;
+}
+
+int ReadBlockTable(block_table_t * const block_table, FILE * const input_file, FILE * const error_log_file)
+{
+  uint8_t entry[ENTRY_SIZE];
+  uint8_t trailer[TRAILER_SIZE];
+  io_int_t start_offset, file_size;
+  io_uint_t num_blocks, table_offset;
+  size_t i;
+  int ret;
+  if ((start_offset = FTELL(input_file)) < 0 || FSEEK(input_file, 0, SEEK_END) != 0 || (file_size = FTELL(input_file)) < 0)
+  {
+    LOG_ERROR(error_log_file, "Could not determine the input file size. Block containers must be read from seekable files\n");
+    return ERROR_FILE_IO;
+  }
+  if (file_size < TRAILER_SIZE || (ret = ReadBytesAt(input_file, file_size - TRAILER_SIZE, trailer, TRAILER_SIZE)) != NO_ERROR || memcmp(trailer + VALUE_SIZE, magic, MAGIC_SIZE) != 0)
+  {
+    LOG_ERROR(error_log_file, "The input file is not a block container\n");
+    return ERROR_INVALID_FORMAT;
+  }
+  if ((ret = LoadValue(trailer, &num_blocks)) != NO_ERROR || file_size - TRAILER_SIZE < start_offset || num_blocks > ((io_uint_t)(file_size - start_offset) - TRAILER_SIZE) / ENTRY_SIZE)
+  {
+    LOG_ERROR(error_log_file, "Invalid number of blocks in block container\n");
+    return ERROR_INVALID_FORMAT;
+  }
+  table_offset = (io_uint_t)file_size - TRAILER_SIZE - num_blocks * ENTRY_SIZE;
+  if (num_blocks != 0 && (ret = ReserveBlockTable(block_table, (size_t)num_blocks)) != NO_ERROR)
+  {
+    LOG_ERROR(error_log_file, "Error allocating the table of %" IO_UINT_FORMAT " blocks\n", num_blocks);
+    return ret;
+  }
+  if (FSEEK(input_file, (io_int_t)table_offset, SEEK_SET) != 0)
+  {
+    LOG_ERROR(error_log_file, "Could not seek to the block table\n");
+    return ERROR_FILE_IO;
+  }
+  for (i = 0; i < (size_t)num_blocks; i++)
+  {
+    block_entry_t * const current_entry = &block_table->entries[i];
+    if (fread(entry, 1, ENTRY_SIZE, input_file) != ENTRY_SIZE)
+    {
+      LOG_ERROR(error_log_file, "Could not read the block table\n");
+      return ERROR_FILE_IO;
+    }
+    if (LoadValue(entry, &current_entry->end_offset) != NO_ERROR || LoadValue(entry + VALUE_SIZE, &current_entry->num_lines) != NO_ERROR)
+    {
+      LOG_ERROR(error_log_file, "Invalid block table entry\n");
+      return ERROR_INVALID_FORMAT;
+    }
+  }
+  block_table->num_blocks = (size_t)num_blocks;
+  if (CheckBlockTable(block_table, table_offset - (io_uint_t)start_offset) != NO_ERROR) /* Block offsets are relative to the start of the first block */
+  {
+    LOG_ERROR(error_log_file, "Invalid block offsets in block container\n");
+    return ERROR_INVALID_FORMAT;
+  }
+  if (FSEEK(input_file, start_offset, SEEK_SET) != 0)
+  {
+    LOG_ERROR(error_log_file, "Could not seek to the start of the first block\n");
+    return ERROR_FILE_IO;
+  }
+  return NO_ERROR;
+}
@@ -3,21 +3,33 @@
    Andreas Unterweger, 2013-2015 */
 
 #include "err_codes.h"
+#include "io.h"
 #include "log.h"
 #include "params.h"
 #include "cli.h"
+#include "blocks.h"
+#include "header.h"
+#include "batch.h"
+#include "evaluate.h"
+#include "thread.h"
+#include "timer.h"
+#include "allocation.h"
+#include "stats.h"
+
+#include <string.h>
 
 /* Prints execution time and memory consumption */
 #define LOG_DIAGNOSTICS
 
 #ifdef LOG_DIAGNOSTICS
-  #define LOG_DIAG(f, ...) LOG((f), __VA_ARGS__)
+  #define LOG_DIAG(f, ...) { if (text_diagnostics) LOG((f), __VA_ARGS__) }
 #else
   #define LOG_DIAG(f, ...) {}
 #endif
 
 #if defined(LOG_DIAGNOSTICS) || defined(_DEBUG)
-  #define LOG_DIAG_OR_DEBUG(f, ...) LOG((f), __VA_ARGS__)
+  #define LOG_DIAG_OR_DEBUG(f, ...) { if (text_diagnostics) LOG((f), __VA_ARGS__) }
+  static int text_diagnostics = 1; /* Disabled when printing statistics in JSON format instead */
 #else
   #define LOG_DIAG_OR_DEBUG(f, ...) {}
 #endif
@@ -28,15 +40,22 @@
   #include <float.h>
 #endif
 
-static const size_t READ_BUFFER_SIZE = 1024; /* 1 KiB */
+static const size_t READ_BUFFER_SIZE = 1024; /* 1 KiB (only used if the input file cannot be memory-mapped) */
+static const size_t PREFETCH_BLOCK_SIZE = 1024 * 1024; /* 1 MiB (only used when reading ahead) */
 static const size_t WRITE_BUFFER_SIZE = 1024; /* 1 KiB */
-static const size_t TEMP_BUFFER_SIZE = 2 * 1024; /* 2 KiB */
+static const size_t WRITE_BEHIND_BLOCK_SIZE = 256 * 1024; /* 256 KiB (only used when writing behind) */
+static const size_t PIPE_BUFFER_SIZE = 4 * 1024; /* 4 KiB (only used in pipeline mode) */
+static const size_t PIPE_BLOCK_SIZE = 64 * 1024; /* 64 KiB (only used in pipeline mode) */
+static const size_t NUM_PIPE_BLOCKS = 4; /* Allows stages to run ahead of each other by up to this number of blocks */
 
 void InitBufferEnvironment(buffer_environment_t * const buffer_env)
 {
   buffer_env->in_file = buffer_env->out_file = NULL;
-  buffer_env->in_buf = buffer_env->out_buf = buffer_env->temp_read_buf = buffer_env->temp_write_buf = NULL;
-  buffer_env->in_bit_buf = buffer_env->out_bit_buf = buffer_env->temp_read_bit_buf = buffer_env->temp_write_bit_buf = NULL;
+  buffer_env->in_buf = buffer_env->out_buf = NULL;
+  buffer_env->in_bit_buf = buffer_env->out_bit_buf = NULL;
+  buffer_env->pipeline = NULL;
+  buffer_env->pipes = NULL;
+  buffer_env->num_pipes = buffer_env->num_initialized_pipes = 0;
 }
 
 void UninitBufferEnvironment(buffer_environment_t * const buffer_env)
@@ -47,27 +66,76 @@ void UninitBufferEnvironment(buffer_environment_t * const buffer_env)
     fclose(buffer_env->in_file);
 }
 
+static void FreePipes(buffer_environment_t * const buffers)
+{
+  size_t i;
+  for (i = 0; i < buffers->num_pipes; i++)
+  {
+    pipe_buffers_t * const pipe = &buffers->pipes[i];
+    if (pipe->read_bit_buf != NULL)
+      FreeBitFileBuffer(pipe->read_bit_buf);
+    if (pipe->write_bit_buf != NULL)
+      FreeBitFileBuffer(pipe->write_bit_buf);
+    if (pipe->read_buf != NULL)
+      FreeFileBuffer(pipe->read_buf);
+    if (pipe->write_buf != NULL)
+      FreeFileBuffer(pipe->write_buf);
+    if (pipe->pipe != NULL)
+      FreeFileBufferPipe(pipe->pipe);
+  }
+  free(buffers->pipes);
+  buffers->pipes = NULL;
+  buffers->num_pipes = 0;
+}
+
 static void FreeBuffers(buffer_environment_t * const buffers)
 {
-  if (buffers->temp_write_bit_buf != NULL)
-    FreeBitFileBuffer(buffers->temp_write_bit_buf);
-  if (buffers->temp_read_bit_buf != NULL)
-    FreeBitFileBuffer(buffers->temp_read_bit_buf);
+  FreePipes(buffers);
+  if (buffers->pipeline != NULL)
+  {
+    FreePipeline(buffers->pipeline);
+    buffers->pipeline = NULL;
+  }
   if (buffers->out_bit_buf != NULL)
     FreeBitFileBuffer(buffers->out_bit_buf);
   if (buffers->in_bit_buf != NULL)
     FreeBitFileBuffer(buffers->in_bit_buf);
-  if (buffers->temp_write_buf != NULL)
-    FreeFileBuffer(buffers->temp_write_buf);
-  if (buffers->temp_read_buf != NULL)
-    FreeFileBuffer(buffers->temp_read_buf);
   if (buffers->out_buf != NULL)
     FreeFileBuffer(buffers->out_buf);
   if (buffers->in_buf != NULL)
     FreeFileBuffer(buffers->in_buf);
 }
 
-static int AllocateBuffers(buffer_environment_t * const buffers, FILE * const error_log_file, const int use_temp_buffers)
+static int AllocatePipes(buffer_environment_t * const buffers, FILE * const error_log_file, const size_t num_pipes)
+{
+  size_t i;
+  if ((buffers->pipes = (pipe_buffers_t*)malloc(num_pipes * sizeof(pipe_buffers_t))) == NULL)
+  {
+    LOG_ERROR(error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes for pipes\n", SIZE_T_CAST(num_pipes * sizeof(pipe_buffers_t)));
+    return ERROR_MEMORY;
+  }
+  buffers->num_pipes = num_pipes;
+  for (i = 0; i < num_pipes; i++)
+  {
+    pipe_buffers_t * const pipe = &buffers->pipes[i];
+    pipe->pipe = NULL;
+    pipe->write_buf = pipe->read_buf = NULL;
+    pipe->write_bit_buf = pipe->read_bit_buf = NULL;
+  }
+  for (i = 0; i < num_pipes; i++)
+  {
+    pipe_buffers_t * const pipe = &buffers->pipes[i];
+    if ((pipe->pipe = AllocateFileBufferPipe()) == NULL || (pipe->write_buf = AllocateFileBuffer()) == NULL || (pipe->read_buf = AllocateFileBuffer()) == NULL
+      || (pipe->write_bit_buf = AllocateBitFileBuffer()) == NULL || (pipe->read_bit_buf = AllocateBitFileBuffer()) == NULL)
+    {
+      LOG_ERROR(error_log_file, "Error allocating pipe buffers\n");
+      return ERROR_MEMORY;
+    }
+  }
+  return NO_ERROR;
+}
+
+static int AllocateBuffers(buffer_environment_t * const buffers, FILE * const error_log_file, const int sequential, const size_t num_pipes)
 {
   if ((buffers->in_buf = AllocateFileBuffer()) == NULL)
   {
@@ -81,21 +149,6 @@ static int AllocateBuffers(buffer_environment_t * const buffers, FILE * const er
     FreeBuffers(buffers);
     return ERROR_MEMORY;
   }
-  if (use_temp_buffers)
-  {
-    if ((buffers->temp_read_buf = AllocateFileBuffer()) == NULL)
-    {
-      LOG_ERROR(error_log_file, "Error allocating temporary reading buffer\n");
-      FreeBuffers(buffers);
-      return ERROR_MEMORY;
-    }
-    if ((buffers->temp_write_buf = AllocateFileBuffer()) == NULL)
-    {
-      LOG_ERROR(error_log_file, "Error allocating temporary writing buffer\n");
-      FreeBuffers(buffers);
-      return ERROR_MEMORY;
-    }
-  }
   if ((buffers->in_bit_buf = AllocateBitFileBuffer()) == NULL)
   {
     LOG_ERROR(error_log_file, "Error allocating input bit buffer\n");
@@ -108,38 +161,69 @@ static int AllocateBuffers(buffer_environment_t * const buffers, FILE * const er
     FreeBuffers(buffers);
     return ERROR_MEMORY;
   }
-  if (use_temp_buffers)
+  if (sequential && (buffers->pipeline = AllocatePipeline()) == NULL)
+  {
+    LOG_ERROR(error_log_file, "Error allocating pipeline\n");
+    FreeBuffers(buffers);
+    return ERROR_MEMORY;
+  }
+  if (num_pipes != 0 && AllocatePipes(buffers, error_log_file, num_pipes) != NO_ERROR)
   {
-    if ((buffers->temp_read_bit_buf = AllocateBitFileBuffer()) == NULL)
+    FreeBuffers(buffers);
+    return ERROR_MEMORY;
+  }
+  return NO_ERROR;
+}
+
+static void UninitPipe(pipe_buffers_t * const pipe)
+{
+  UninitBitFileBuffer(pipe->read_bit_buf);
+  UninitBitFileBuffer(pipe->write_bit_buf);
+  UninitFileBuffer(pipe->read_buf);
+  UninitFileBuffer(pipe->write_buf);
+  UninitFileBufferPipe(pipe->pipe); /* After both file buffers */
+}
+
+static int InitPipes(buffer_environment_t * const buffers, FILE * const error_log_file)
+{
+  int ret;
+  for (buffers->num_initialized_pipes = 0; buffers->num_initialized_pipes < buffers->num_pipes; buffers->num_initialized_pipes++)
+  {
+    pipe_buffers_t * const pipe = &buffers->pipes[buffers->num_initialized_pipes];
+    if ((ret = InitFileBufferPipe(pipe->pipe, NUM_PIPE_BLOCKS, PIPE_BLOCK_SIZE)) != NO_ERROR)
     {
-      LOG_ERROR(error_log_file, "Error allocating temporary reading bit buffer\n");
-      FreeBuffers(buffers);
-      return ERROR_MEMORY;
+      LOG_ERROR(error_log_file, "%s while initializing pipe\n", ERROR_MESSAGE_STRING(ret));
+      return ret;
     }
-    if ((buffers->temp_write_bit_buf = AllocateBitFileBuffer()) == NULL)
+    if ((ret = InitFileBufferPiped(pipe->write_buf, pipe->pipe, FBM_WRITING, PIPE_BUFFER_SIZE)) != NO_ERROR)
     {
-      LOG_ERROR(error_log_file, "Error allocating temporary writing bit buffer\n");
-      FreeBuffers(buffers);
-      return ERROR_MEMORY;
+      LOG_ERROR(error_log_file, "%s while initializing pipe writing buffer\n", ERROR_MESSAGE_STRING(ret));
+      UninitFileBufferPipe(pipe->pipe);
+      return ret;
+    }
+    if ((ret = InitFileBufferPiped(pipe->read_buf, pipe->pipe, FBM_READING, PIPE_BUFFER_SIZE)) != NO_ERROR)
+    {
+      LOG_ERROR(error_log_file, "%s while initializing pipe reading buffer\n", ERROR_MESSAGE_STRING(ret));
+      UninitFileBuffer(pipe->write_buf);
+      UninitFileBufferPipe(pipe->pipe);
+      return ret;
     }
+    InitBitFileBuffer(pipe->write_bit_buf, pipe->write_buf);
+    InitBitFileBuffer(pipe->read_bit_buf, pipe->read_buf);
   }
   return NO_ERROR;
 }
 
 void UninitBuffers(buffer_environment_t * const buffers)
 {
-  if (buffers->temp_write_bit_buf != NULL)
-    UninitBitFileBuffer(buffers->temp_write_bit_buf);
-  if (buffers->temp_read_bit_buf != NULL)
-    UninitBitFileBuffer(buffers->temp_read_bit_buf);
+  while (buffers->num_initialized_pipes != 0)
+    UninitPipe(&buffers->pipes[--buffers->num_initialized_pipes]);
+  if (buffers->pipeline != NULL)
+    UninitPipeline(buffers->pipeline);
   if (buffers->out_bit_buf != NULL)
     UninitBitFileBuffer(buffers->out_bit_buf);
   if (buffers->in_bit_buf != NULL)
     UninitBitFileBuffer(buffers->in_bit_buf);
-  if (buffers->temp_write_buf != NULL)
-    UninitFileBuffer(buffers->temp_write_buf);
-  if (buffers->temp_read_buf != NULL)
-    UninitFileBuffer(buffers->temp_read_buf);
   if (buffers->out_buf != NULL)
     UninitFileBuffer(buffers->out_buf);
   if (buffers->in_buf != NULL)
@@ -147,78 +231,62 @@ void UninitBuffers(buffer_environment_t * const buffers)
   FreeBuffers(buffers);
 }
 
-int InitBuffers(buffer_environment_t * const buffers, FILE * const error_log_file, const int use_temp_buffers)
+static int InitInputOutputBuffers(buffer_environment_t * const buffers, FILE * const error_log_file, const int prefetch_input, const int write_behind_output)
 {
   int ret;
-  if ((ret = AllocateBuffers(buffers, error_log_file, use_temp_buffers)) != NO_ERROR)
-    return ret;
-  if ((ret = InitFileBuffer(buffers->in_buf, buffers->in_file, FBM_READING, READ_BUFFER_SIZE)) != NO_ERROR)
+  if ((ret = (buffers->in_file == NULL ? InitFileBufferInMemory(buffers->in_buf, FBM_WRITING, READ_BUFFER_SIZE) : prefetch_input ? InitFileBufferPrefetched(buffers->in_buf, buffers->in_file, READ_BUFFER_SIZE, PREFETCH_BLOCK_SIZE) : InitFileBufferMapped(buffers->in_buf, buffers->in_file, READ_BUFFER_SIZE))) != NO_ERROR)
   {
     LOG_ERROR(error_log_file, "%s while initializing input file buffer\n", ERROR_MESSAGE_STRING(ret));
-    UninitBuffers(buffers);
     return ERROR_LIBRARY_INIT;
   }
-  if ((ret = InitFileBuffer(buffers->out_buf, buffers->out_file, FBM_WRITING, WRITE_BUFFER_SIZE)) != NO_ERROR)
+  if ((ret = (buffers->out_file == NULL ? InitFileBufferInMemory(buffers->out_buf, FBM_WRITING, WRITE_BUFFER_SIZE) : write_behind_output ? InitFileBufferWriteBehind(buffers->out_buf, buffers->out_file, WRITE_BUFFER_SIZE, WRITE_BEHIND_BLOCK_SIZE) : InitFileBuffer(buffers->out_buf, buffers->out_file, FBM_WRITING, WRITE_BUFFER_SIZE))) != NO_ERROR)
   {
     LOG_ERROR(error_log_file, "%s while initializing output file buffer\n", ERROR_MESSAGE_STRING(ret));
+    return ERROR_LIBRARY_INIT;
+  }
+  return NO_ERROR;
+}
+
+int InitBuffers(buffer_environment_t * const buffers, const parameters_t * const parameters, const int sequential, const size_t num_pipes)
+{
+  int ret;
+  if ((ret = AllocateBuffers(buffers, parameters->error_log_file, sequential, num_pipes)) != NO_ERROR)
+    return ret;
+  if (sequential && (ret = InitPipeline(buffers->pipeline, parameters->options, parameters->num_options, parameters->fuse_encoders, parameters->memory_budget)) != NO_ERROR) /* Initialize first so that uninitializing is always possible */
+  {
+    LOG_ERROR(parameters->error_log_file, "%s while initializing pipeline\n", ERROR_MESSAGE_STRING(ret));
+    FreeBuffers(buffers);
+    return ERROR_LIBRARY_INIT;
+  }
+  if (InitInputOutputBuffers(buffers, parameters->error_log_file, parameters->prefetch_input, parameters->write_behind_output) != NO_ERROR)
+  {
     UninitBuffers(buffers);
     return ERROR_LIBRARY_INIT;
   }
-  if (use_temp_buffers)
+  if ((ret = InitPipes(buffers, parameters->error_log_file)) != NO_ERROR)
   {
-    if ((ret = InitFileBufferInMemory(buffers->temp_read_buf, FBM_READING, TEMP_BUFFER_SIZE)) != NO_ERROR)
-    {
-      LOG_ERROR(error_log_file, "%s while initializing temporary reading buffer\n", ERROR_MESSAGE_STRING(ret));
-      UninitBuffers(buffers);
-      return ERROR_LIBRARY_INIT;
-    }
-    if ((ret = InitFileBufferInMemory(buffers->temp_write_buf, FBM_WRITING, TEMP_BUFFER_SIZE)) != NO_ERROR)
-    {
-      LOG_ERROR(error_log_file, "%s while initializing temporary writing buffer\n", ERROR_MESSAGE_STRING(ret));
-      UninitBuffers(buffers);
-      return ERROR_LIBRARY_INIT;
-    }
+    UninitBuffers(buffers);
+    return ERROR_LIBRARY_INIT;
   }
   InitBitFileBuffer(buffers->in_bit_buf, buffers->in_buf);
   InitBitFileBuffer(buffers->out_bit_buf, buffers->out_buf);
-  if (use_temp_buffers)
-  {
-    InitBitFileBuffer(buffers->temp_read_bit_buf, buffers->temp_read_buf);
-    InitBitFileBuffer(buffers->temp_write_bit_buf, buffers->temp_write_buf);
-  }
   return NO_ERROR;
 }
 
-static void SwapTempFileBuffers(buffer_environment_t * const buffers)
-{
-  file_buffer_t *temp = buffers->temp_read_buf;
-  buffers->temp_read_buf = buffers->temp_write_buf;
-  buffers->temp_write_buf = temp;
-}
-
-static void SwapTempBitBuffers(buffer_environment_t * const buffers)
-{
-  bit_file_buffer_t *temp = buffers->temp_read_bit_buf;
-  buffers->temp_read_bit_buf = buffers->temp_write_bit_buf;
-  buffers->temp_write_bit_buf = temp;
-}
-
-static void SwapTempBuffers(buffer_environment_t * const buffers)
-{
-  SwapTempFileBuffers(buffers); /* Swap original file buffer pointers as well so that they point to the correct buffers */
-  SwapTempBitBuffers(buffers);
-}
-
-static int SwitchTempBuffers(buffer_environment_t * const buffers, FILE * const error_log_file)
+static int ReplaceBufferFiles(buffer_environment_t * const buffers, FILE * const error_log_file, FILE * const in_file, FILE * const out_file, const int prefetch_input, const int write_behind_output) /* Reuses initialized buffers (without pipes) for other input and output files. The previous files are closed. The pipeline object discards left-overs from previous errors itself */
 {
   int ret;
-  if ((ret = SetBitFileBufferMode(buffers->temp_write_bit_buf, FBM_READING)) != NO_ERROR)
-  {
-    LOG_ERROR(error_log_file, "Could not switch mode of temporary buffer\n");
+  UninitBitFileBuffer(buffers->out_bit_buf);
+  UninitBitFileBuffer(buffers->in_bit_buf);
+  UninitFileBuffer(buffers->out_buf);
+  UninitFileBuffer(buffers->in_buf);
+  UninitBufferEnvironment(buffers);
+  buffers->in_file = in_file;
+  buffers->out_file = out_file;
+  if ((ret = InitInputOutputBuffers(buffers, error_log_file, prefetch_input, write_behind_output)) != NO_ERROR)
     return ret;
-  }
-  SwapTempBuffers(buffers); /* Old data can now be read from the reading buffer; the writing buffer has to be reset */
-  ResetBitFileBuffer(buffers->temp_write_bit_buf, FBM_WRITING);
+  InitBitFileBuffer(buffers->in_bit_buf, buffers->in_buf);
+  InitBitFileBuffer(buffers->out_bit_buf, buffers->out_buf);
   return NO_ERROR;
 }
 
@@ -384,90 +452,1021 @@ static void PrintBufferSize(const char * const buffer_name, const size_t buffer_
   LOG_DIAG(stdout, " (%" SIZE_T_FORMAT " bytes) \n", SIZE_T_CAST(buffer_size));
 }
 
+static void PrintAllocatedSize(const char * const name, const uint64_t size)
+{
+  LOG_DIAG(stdout, "    %s allocated memory: ", name);
+  PrintByte((io_uint_t)size);
+  LOG_DIAG(stdout, " (%" PRIu64 " bytes) \n", size);
+}
+
 static void PrintBufferSizes(const buffer_environment_t * buffers)
 {
-  size_t current_size, total_size = 0;
+  allocation_stats_t allocations;
+  size_t i, current_size, temp_read_size, temp_write_size, total_size = 0;
   LOG_DIAG(stdout, "  Buffer use (without structural overhead):\n")
   total_size += (current_size = GetFileBufferSize(buffers->in_buf));
   PrintBufferSize("Input", current_size);
   total_size += (current_size = GetFileBufferSize(buffers->out_buf));
   PrintBufferSize("Output", current_size);
-  if (buffers->temp_read_buf && buffers->temp_write_buf)
+  if (buffers->pipeline != NULL && GetPipelineBufferSizes(buffers->pipeline, &temp_read_size, &temp_write_size))
   {
-    total_size += (current_size = GetFileBufferSize(buffers->temp_read_buf));
-    PrintBufferSize("Temporary read", current_size);
-    total_size += (current_size = GetFileBufferSize(buffers->temp_write_buf));
-    PrintBufferSize("Temporary write", current_size);
+    total_size += temp_read_size;
+    PrintBufferSize("Temporary read", temp_read_size);
+    total_size += temp_write_size;
+    PrintBufferSize("Temporary write", temp_write_size);
+  }
+  for (i = 0; i < buffers->num_initialized_pipes; i++)
+  {
+    total_size += (current_size = GetFileBufferSize(buffers->pipes[i].write_buf) + GetFileBufferSize(buffers->pipes[i].read_buf));
+    PrintBufferSize("Pipe", current_size);
   }
   PrintBufferSize("Total", total_size);
+  GetAllocationStatistics(&allocations);
+  LOG_DIAG(stdout, "  Allocations of DCIOLib and DCLib (all threads, including structural overhead):\n")
+  PrintAllocatedSize("Current", allocations.current_bytes);
+  PrintAllocatedSize("Peak", allocations.peak_bytes);
+  LOG_DIAG(stdout, "    %" PRIu64 " allocations, %" PRIu64 " reallocations, %" PRIu64 " frees, %" PRIu64 " buffer growths\n", allocations.num_allocations, allocations.num_reallocations, allocations.num_frees, allocations.num_buffer_growths);
 }
 
 #endif
 
-int main(const int argc, const char * const * const argv)
+#if defined(LOG_DIAGNOSTICS) || defined(_DEBUG)
+static void PrintStageDiagnostics(const options_t * const * const options, const size_t first_stage, const size_t num_stages, const size_t total_stages, bit_file_buffer_t * const read_bit_buf, bit_file_buffer_t * const write_bit_buf, const int finished, void * const caller_info) /* Called by the pipeline object before and after each encoder/decoder */
 {
-  buffer_environment_t buffer_env;
-  parameters_t parameters;
+  const options_t * const first_options = options[first_stage];
+  const options_t * const last_options = options[first_stage + num_stages - 1];
+  enc_dec_function_t * const first_enc_dec = first_options->encode ? first_options->encoder_decoder->encoder : first_options->encoder_decoder->decoder;
+#ifdef LOG_DIAGNOSTICS
+  static clock_t start; /* Only used by the main thread */
+  if (finished)
+  {
+    PrintTimeStatistics(clock(), start);
+    PrintIOStatistics(read_bit_buf, write_bit_buf, first_stage == 0);
+    PrintBufferSizes((const buffer_environment_t * const)caller_info);
+    return;
+  }
+#else
+  (void)read_bit_buf;
+  (void)write_bit_buf;
+  (void)caller_info;
+  if (finished)
+    return;
+#endif
+  if (num_stages > 1)
+    LOG_DIAG_OR_DEBUG(stdout, "Executing fused encoders/decoders %s to %s (%" SIZE_T_FORMAT " to %" SIZE_T_FORMAT " of %" SIZE_T_FORMAT " total)...\n", GetEncoderDecoderName(first_enc_dec), GetEncoderDecoderName(last_options->encode ? last_options->encoder_decoder->encoder : last_options->encoder_decoder->decoder), SIZE_T_CAST(first_stage + 1), SIZE_T_CAST(first_stage + num_stages), SIZE_T_CAST(total_stages))
+  else
+    LOG_DIAG_OR_DEBUG(stdout, "Executing %s %s (%" SIZE_T_FORMAT " of %" SIZE_T_FORMAT " total)...\n", first_options->encode ? "encoder" : "decoder", GetEncoderDecoderName(first_enc_dec), SIZE_T_CAST(first_stage + 1), SIZE_T_CAST(total_stages));
+#ifdef _DEBUG
+  PrintEncoderConfiguration(stdout, first_options->error_log_file, first_options);
+#endif
+#ifdef LOG_DIAGNOSTICS
+  start = clock();
+#endif
+}
+#endif
+
+static void AddBufferSizes(const buffer_environment_t * const buffers, size_t * const buffer_sizes) /* Adds the current sizes of all buffers (see stats_buffer_t) */
+{
+  size_t i, temp_read_size, temp_write_size, pipe_size = 0;
+  const size_t temp_size = buffers->pipeline != NULL && GetPipelineBufferSizes(buffers->pipeline, &temp_read_size, &temp_write_size) ? temp_read_size + temp_write_size : 0;
+  const size_t in_size = GetFileBufferSize(buffers->in_buf);
+  const size_t out_size = GetFileBufferSize(buffers->out_buf);
+  for (i = 0; i < buffers->num_initialized_pipes; i++)
+    pipe_size += GetFileBufferSize(buffers->pipes[i].write_buf) + GetFileBufferSize(buffers->pipes[i].read_buf);
+  buffer_sizes[SB_INPUT] += in_size;
+  buffer_sizes[SB_OUTPUT] += out_size;
+  buffer_sizes[SB_TEMPORARY] += temp_size;
+  buffer_sizes[SB_PIPES] += pipe_size;
+  buffer_sizes[SB_TOTAL] += in_size + out_size + temp_size + pipe_size;
+}
+
+static void UpdateBufferHighWaterMarks(const buffer_environment_t * const buffers, size_t * const max_buffer_sizes)
+{
+  size_t buffer_sizes[NUM_STATS_BUFFERS] = { 0 };
+  AddBufferSizes(buffers, buffer_sizes);
+  UpdateHighWaterMarks(max_buffer_sizes, buffer_sizes);
+}
+
+static io_uint_t GetBitOffset(const bit_file_buffer_t * const bit_file_buffer)
+{
+  io_int_t bytes;
+  uint8_t bits;
+  GetActualBitFileOffset(bit_file_buffer, &bytes, &bits);
+  return (io_uint_t)bytes * 8 + bits;
+}
+
+typedef struct stats_collector_t /* Caller information of CollectStageStatistics */
+{
+  const buffer_environment_t *buffers;
+  run_stats_t *stats;
+} stats_collector_t;
+
+static void CollectStageStatistics(const options_t * const * const options, const size_t first_stage, const size_t num_stages, const size_t total_stages, bit_file_buffer_t * const read_bit_buf, bit_file_buffer_t * const write_bit_buf, const int finished, void * const caller_info) /* Called by the pipeline object before and after each encoder/decoder instead of PrintStageDiagnostics */
+{
+  const stats_collector_t * const collector = (const stats_collector_t * const)caller_info;
+  run_stats_t * const stats = collector->stats;
+  stage_stats_t * const stage = &stats->stages[stats->num_stages];
+  (void)options;
+  (void)total_stages;
+  if (!finished)
+  {
+    StartStageStatistics(stage, first_stage, num_stages);
+    UpdateBufferHighWaterMarks(collector->buffers, stage->max_buffer_sizes); /* The temporary reading buffer is full */
+    StartStageAllocationStatistics(stats, stage);
+    if (stats->perf_counters)
+      StartPerfCounters(&stats->stage_counters);
+    return;
+  }
+  if (stats->perf_counters)
+    StopPerfCounters(&stats->stage_counters, &stage->perf_counter_values);
+  FinishStageAllocationStatistics(stage);
+  FinishStageStatistics(stage);
+  stage->input_bits = stats->num_stages == 0 ? GetBitOffset(read_bit_buf) : stats->stages[stats->num_stages - 1].output_bits; /* The temporary reading buffer holds the output of the previous stage */
+  stage->output_bits = GetBitOffset(write_bit_buf);
+  UpdateBufferHighWaterMarks(collector->buffers, stage->max_buffer_sizes); /* The temporary writing buffer is full */
+  stats->num_stages++;
+}
+
+static int RunSequentially(buffer_environment_t * const buffer_env, const int print_diagnostics, run_stats_t * const stats) /* Collects statistics instead of printing diagnostics if stats is not NULL */
+{
+  stats_collector_t collector;
+  int ret = NO_ERROR;
+  collector.buffers = buffer_env;
+  collector.stats = stats;
+  if (stats != NULL)
+    SetPipelineStageFunction(buffer_env->pipeline, &CollectStageStatistics, &collector);
+  else
+  {
+#if defined(LOG_DIAGNOSTICS) || defined(_DEBUG)
+    SetPipelineStageFunction(buffer_env->pipeline, print_diagnostics ? &PrintStageDiagnostics : NULL, buffer_env);
+#else
+    (void)print_diagnostics;
+#endif
+  }
+  if (RunPipelineStages(buffer_env->pipeline, buffer_env->in_bit_buf, buffer_env->out_bit_buf) != NO_ERROR) /* Errors have already been logged */
+    ret = ERROR_LIBRARY_CALL;
+  if (stats != NULL)
+    SetPipelineStageFunction(buffer_env->pipeline, NULL, NULL); /* The collector is about to go out of scope */
+  return ret;
+}
+
+typedef struct stage_t /* Encoder/decoder running in its own thread in pipeline mode */
+{
+  thread_t thread;
+  enc_dec_function_t *enc_dec;
+  const options_t *options;
+  bit_file_buffer_t *read_bit_buf, *write_bit_buf;
+  int read_from_pipe, write_to_pipe; /* Not set for the first and last stage, respectively, which use the input and output file instead */
+  double start_wall_time, end_wall_time;
+  int measure_perf_counters;
+  perf_counter_values_t perf_counter_values; /* Of this thread only */
+  io_int_t ret;
+} stage_t;
+
+static void RunStage(void * const caller_info)
+{
+  stage_t * const stage = (stage_t * const)caller_info;
+  perf_counters_t counters;
   int ret;
+  ClearPerfCounterValues(&stage->perf_counter_values);
+  if (stage->measure_perf_counters && OpenPerfCounters(&counters, 0))
+    StartPerfCounters(&counters);
+  else
+    stage->measure_perf_counters = 0;
+  stage->start_wall_time = GetWallClockTime();
+  stage->ret = (*stage->enc_dec)(stage->read_bit_buf, stage->write_bit_buf, stage->options);
+  if (stage->write_to_pipe && (ret = CloseBitFileBufferPipe(stage->write_bit_buf)) != NO_ERROR && stage->ret == NO_ERROR) /* Signal EOF to the next stage (also after errors so that it does not wait forever) */
+    stage->ret = ret;
+  if (stage->read_from_pipe)
+    CloseBitFileBufferPipe(stage->read_bit_buf); /* Ignore result. Allows the previous stage to finish even if not all of its output has been read */
+  stage->end_wall_time = GetWallClockTime();
+  if (stage->measure_perf_counters)
+  {
+    StopPerfCounters(&counters, &stage->perf_counter_values);
+    ClosePerfCounters(&counters);
+  }
+}
+
+static void CollectPipelineStatistics(const buffer_environment_t * const buffer_env, const stage_t * const stages, const size_t num_stages, run_stats_t * const stats)
+{
   size_t i;
-  LOG_DEBUG(stdout, BITSIZE_INFO_PRINT_ARGS);
-  InitBufferEnvironment(&buffer_env);
-  parameters.error_log_file = stderr; /* Default: Log errors to stderr */
-  if ((ret = ProcessParameters(argc - 1, &argv[1], &parameters, &buffer_env.in_file, &buffer_env.out_file)) != NO_ERROR)
+  for (i = 0; i < num_stages; i++)
   {
-    UninitBufferEnvironment(&buffer_env);
+    stage_stats_t * const stage = &stats->stages[i];
+    StartStageStatistics(stage, i, 1);
+    stage->wall_seconds = stages[i].end_wall_time - stages[i].start_wall_time;
+    stage->processor_seconds = -1; /* Unknown since all stages run at the same time */
+    stage->input_bits = i == 0 ? GetBitOffset(stages[i].read_bit_buf) : stats->stages[i - 1].output_bits;
+    stage->output_bits = GetBitOffset(stages[i].write_bit_buf);
+    UpdateBufferHighWaterMarks(buffer_env, stage->max_buffer_sizes); /* The pipes have a fixed size */
+    stage->perf_counter_values = stages[i].perf_counter_values;
+  }
+  stats->num_stages = num_stages;
+}
+
+static int RunPipeline(buffer_environment_t * const buffer_env, const parameters_t * const parameters, run_stats_t * const stats) /* stats may be NULL */
+{
+  stage_t stages[MAX_OPTIONS];
+  size_t i, num_started;
+  int ret = NO_ERROR;
+#ifdef LOG_DIAGNOSTICS
+  clock_t start, end;
+  start = clock();
+#endif
+  for (num_started = 0; num_started < parameters->num_options; num_started++)
+  {
+    stage_t * const stage = &stages[num_started];
+    const options_t * const options = parameters->options[num_started];
+    stage->enc_dec = options->encode ? options->encoder_decoder->encoder : options->encoder_decoder->decoder;
+    stage->options = options;
+    stage->read_from_pipe = num_started != 0;
+    stage->write_to_pipe = num_started != parameters->num_options - 1;
+    stage->read_bit_buf = stage->read_from_pipe ? buffer_env->pipes[num_started - 1].read_bit_buf : buffer_env->in_bit_buf;
+    stage->write_bit_buf = stage->write_to_pipe ? buffer_env->pipes[num_started].write_bit_buf : buffer_env->out_bit_buf;
+    stage->measure_perf_counters = stats != NULL && stats->perf_counters;
+    LOG_DIAG_OR_DEBUG(stdout, "Starting %s %s (%" SIZE_T_FORMAT " of %" SIZE_T_FORMAT " total)...\n", options->encode ? "encoder" : "decoder", GetEncoderDecoderName(stage->enc_dec), SIZE_T_CAST(num_started + 1), SIZE_T_CAST(parameters->num_options));
+#ifdef _DEBUG
+    PrintEncoderConfiguration(stdout, parameters->error_log_file, options);
+#endif
+    if (StartThread(&stage->thread, &RunStage, stage) != NO_ERROR)
+    {
+      LOG_ERROR(parameters->error_log_file, "Could not start thread for encoder/decoder %" SIZE_T_FORMAT " of %" SIZE_T_FORMAT "\n", SIZE_T_CAST(num_started + 1), SIZE_T_CAST(parameters->num_options));
+      if (stage->read_from_pipe)
+        CloseBitFileBufferPipe(stage->read_bit_buf); /* Ignore result. Allows the previous stage to finish */
+      ret = ERROR_LIBRARY_CALL;
+      break;
+    }
+  }
+  for (i = 0; i < num_started; i++)
+  {
+    JoinThread(&stages[i].thread); /* Ignore result */
+    if (stages[i].ret != NO_ERROR)
+    {
+      LOG_ERROR(parameters->error_log_file, "%s while executing encoder/decoder %" SIZE_T_FORMAT " of %" SIZE_T_FORMAT "\n", ERROR_MESSAGE_STRING(stages[i].ret), SIZE_T_CAST(i + 1), SIZE_T_CAST(parameters->num_options));
+      ret = ERROR_LIBRARY_CALL;
+    }
+  }
+  if (ret == NO_ERROR && stats != NULL)
+    CollectPipelineStatistics(buffer_env, stages, num_started, stats);
+#ifdef LOG_DIAGNOSTICS
+  end = clock();
+  if (ret == NO_ERROR)
+  {
+    for (i = 0; i < num_started; i++)
+    {
+      LOG_DIAG(stdout, "Stage %" SIZE_T_FORMAT " (%s %s):\n", SIZE_T_CAST(i + 1), stages[i].options->encode ? "encoder" : "decoder", GetEncoderDecoderName(stages[i].enc_dec));
+      PrintIOStatistics(stages[i].read_bit_buf, stages[i].write_bit_buf, i == 0);
+    }
+    PrintTimeStatistics(end, start); /* Processor time of all stages together */
+    PrintBufferSizes(buffer_env);
+  }
+#endif
+  return ret;
+}
+
+static int WriteBlockBytes(bit_file_buffer_t * const output, const uint8_t * const input, const size_t size)
+{
+  size_t written = 0;
+  int ret;
+  while (written < size)
+  {
+    uint8_t *span;
+    const io_int_t available = ReserveBitFileBufferWriteSpan(output, &span, 1);
+    size_t current_size;
+    if (available < 0)
+      return (int)available;
+    current_size = (size_t)available < size - written ? (size_t)available : size - written;
+    memcpy(span, input + written, current_size);
+    if ((ret = CommitBitFileBufferWriteSpan(output, current_size)) != NO_ERROR)
+      return ret;
+    written += current_size;
+  }
+  return NO_ERROR;
+}
+
+static int CopyBlockBytes(bit_file_buffer_t * const input, bit_file_buffer_t * const output, const io_uint_t max_size, io_uint_t * const size) /* Copies up to max_size bytes (less at EOF) */
+{
+  int ret;
+  *size = 0;
+  while (*size < max_size)
+  {
+    const uint8_t *span;
+    const io_int_t available = AcquireBitFileBufferReadSpan(input, &span, max_size - *size < MAX_USABLE_SIZE ? (size_t)(max_size - *size) : MAX_USABLE_SIZE);
+    if (available < 0)
+      return (int)available;
+    if (available == 0) /* EOF */
+      break;
+    if ((ret = WriteBlockBytes(output, span, (size_t)available)) != NO_ERROR || (ret = ReleaseBitFileBufferReadSpan(input, (size_t)available)) != NO_ERROR)
+      return ret;
+    *size += (io_uint_t)available;
+  }
+  return NO_ERROR;
+}
+
+static int CopyBlockLines(bit_file_buffer_t * const input, bit_file_buffer_t * const output, const io_uint_t max_lines, io_uint_t * const num_lines) /* Copies up to max_lines lines (less at EOF) or skips them if output is NULL. An incomplete last line counts as a line */
+{
+  int ret, line_started = 0;
+  *num_lines = 0;
+  while (*num_lines < max_lines)
+  {
+    const uint8_t *span;
+    size_t size = 0;
+    const io_int_t available = AcquireBitFileBufferReadSpan(input, &span, MAX_USABLE_SIZE);
+    if (available < 0)
+      return (int)available;
+    if (available == 0) /* EOF */
+    {
+      if (line_started)
+        (*num_lines)++;
+      break;
+    }
+    while (size < (size_t)available && *num_lines < max_lines)
+    {
+      const uint8_t * const line_end = (const uint8_t*)memchr(span + size, '\n', (size_t)available - size);
+      if (line_end == NULL) /* Line continues in the next span */
+      {
+        size = (size_t)available;
+        line_started = 1;
+      }
+      else
+      {
+        size = (size_t)(line_end - span) + 1;
+        line_started = 0;
+        (*num_lines)++;
+      }
+    }
+    if ((output != NULL && (ret = WriteBlockBytes(output, span, size)) != NO_ERROR) || (ret = ReleaseBitFileBufferReadSpan(input, size)) != NO_ERROR)
+      return ret;
+  }
+  return NO_ERROR;
+}
+
+typedef struct block_job_t /* Block processed independently by a worker thread in block mode */
+{
+  thread_t thread;
+  buffer_environment_t buffers; /* In-memory input and output buffers */
+  const parameters_t *parameters;
+  io_uint_t num_lines;
+  int ret;
+} block_job_t;
+
+typedef struct block_range_t /* Blocks to be processed in block mode and lines of their output to be written */
+{
+  size_t first_block, end_block; /* Only used with --unblock */
+  io_uint_t skip_lines; /* At the start of the output of the first block */
+  io_uint_t num_lines; /* Maximum number of lines to be written (MAX_IO_UINT_VALUE means all) */
+} block_range_t;
+
+static int PadToByteBoundary(bit_file_buffer_t * const bit_file_buffer) /* Pads with zeros like when writing to a file so that blocks can be concatenated */
+{
+  const uint8_t zero = 0;
+  io_int_t byte_offset;
+  uint8_t bit_offset;
+  io_int_t ret;
+  GetActualBitFileOffset(bit_file_buffer, &byte_offset, &bit_offset);
+  if (bit_offset != 0 && (ret = WriteBitFileBuffer(bit_file_buffer, &zero, 8 - bit_offset)) != 8 - bit_offset)
+    return ret < 0 ? (int)ret : ERROR_FILE_IO;
+  return NO_ERROR;
+}
+
+static void RunBlockJob(void * const caller_info)
+{
+  block_job_t * const job = (block_job_t * const)caller_info;
+  if ((job->ret = RunSequentially(&job->buffers, 0, NULL)) == NO_ERROR && (job->ret = PadToByteBoundary(job->buffers.out_bit_buf)) == NO_ERROR)
+    job->ret = SetBitFileBufferMode(job->buffers.out_bit_buf, FBM_READING); /* So that the output can be copied */
+}
+
+static int PrepareBlockJob(block_job_t * const job, buffer_environment_t * const buffer_env, const parameters_t * const parameters, const block_table_t * const block_table, const size_t block)
+{
+  int ret;
+  InitBufferEnvironment(&job->buffers); /* No files, i.e., in memory */
+  job->parameters = parameters;
+  if ((ret = InitBuffers(&job->buffers, parameters, 1, 0)) != NO_ERROR)
     return ret;
+  if (parameters->unblock)
+  {
+    io_uint_t size;
+    job->num_lines = block_table->entries[block].num_lines;
+    if ((ret = CopyBlockBytes(buffer_env->in_bit_buf, job->buffers.in_bit_buf, GetBlockSize(block_table, block), &size)) == NO_ERROR && size != GetBlockSize(block_table, block))
+      ret = ERROR_INVALID_FORMAT; /* Truncated */
   }
-  if ((ret = InitBuffers(&buffer_env, parameters.error_log_file, parameters.num_options > 1)) != NO_ERROR)
+  else
+    ret = CopyBlockLines(buffer_env->in_bit_buf, job->buffers.in_bit_buf, parameters->block_lines, &job->num_lines);
+  if (ret == NO_ERROR)
+    ret = SetBitFileBufferMode(job->buffers.in_bit_buf, FBM_READING);
+  if (ret != NO_ERROR)
   {
-    UninitBuffers(&buffer_env);
-    UninitBufferEnvironment(&buffer_env);
+    LOG_ERROR(parameters->error_log_file, "%s while reading block %" SIZE_T_FORMAT "\n", ERROR_MESSAGE_STRING(ret), SIZE_T_CAST(block + 1));
+    UninitBuffers(&job->buffers);
+  }
+  return ret;
+}
+
+static int CopyBlockOutputRange(bit_file_buffer_t * const input, bit_file_buffer_t * const output, block_range_t * const range)
+{
+  io_uint_t num_lines;
+  int ret;
+  if (range->skip_lines != 0)
+  {
+    if ((ret = CopyBlockLines(input, NULL, range->skip_lines, &num_lines)) != NO_ERROR)
+      return ret;
+    range->skip_lines -= num_lines;
+  }
+  if ((ret = CopyBlockLines(input, output, range->num_lines, &num_lines)) != NO_ERROR)
     return ret;
+  range->num_lines -= num_lines;
+  return NO_ERROR;
+}
+
+static int FinishBlockJob(block_job_t * const job, buffer_environment_t * const buffer_env, const parameters_t * const parameters, block_table_t * const block_table, block_range_t * const range, const size_t block)
+{
+  io_uint_t size;
+  int ret;
+  if (job->ret != NO_ERROR)
+  {
+    LOG_ERROR(parameters->error_log_file, "%s while processing block %" SIZE_T_FORMAT "\n", ERROR_MESSAGE_STRING(job->ret), SIZE_T_CAST(block + 1));
+    return job->ret;
   }
+  if ((ret = (range->num_lines != MAX_IO_UINT_VALUE ? CopyBlockOutputRange(job->buffers.out_bit_buf, buffer_env->out_bit_buf, range) : CopyBlockBytes(job->buffers.out_bit_buf, buffer_env->out_bit_buf, MAX_IO_UINT_VALUE, &size))) != NO_ERROR)
+  {
+    LOG_ERROR(parameters->error_log_file, "%s while writing block %" SIZE_T_FORMAT "\n", ERROR_MESSAGE_STRING(ret), SIZE_T_CAST(block + 1));
+    return ret;
+  }
+  if (parameters->block_lines != 0 && (ret = AddBlockToTable(block_table, size, job->num_lines)) != NO_ERROR)
+  {
+    LOG_ERROR(parameters->error_log_file, "%s while adding block %" SIZE_T_FORMAT " to the block table\n", ERROR_MESSAGE_STRING(ret), SIZE_T_CAST(block + 1));
+    return ret;
+  }
+  return NO_ERROR;
+}
+
+static int MoreBlocks(buffer_environment_t * const buffer_env, const parameters_t * const parameters, const block_range_t * const range, const size_t next_block)
+{
+  if (parameters->unblock)
+    return next_block < range->end_block;
+  else
+    return !EndOfBitFileBuffer(buffer_env->in_bit_buf);
+}
+
+static size_t GetNumberOfThreads(const parameters_t * const parameters)
+{
+  const size_t num_processors = GetNumberOfProcessors();
+  return parameters->num_threads != 0 ? parameters->num_threads : (num_processors < MAX_THREADS ? num_processors : MAX_THREADS);
+}
+
+static int RunBlocks(buffer_environment_t * const buffer_env, const parameters_t * const parameters, block_table_t * const block_table, block_range_t * const range, run_stats_t * const stats) /* stats may be NULL */
+{
+  const size_t num_threads = GetNumberOfThreads(parameters);
+  block_job_t *jobs;
+  size_t next_block = range->first_block;
+  int ret = NO_ERROR;
 #ifdef LOG_DIAGNOSTICS
-  PrintBufferSizes(&buffer_env);
+  clock_t start, end;
+  start = clock();
 #endif
-  for (i = 0; i < parameters.num_options; i++)
+  if ((jobs = (block_job_t*)malloc(num_threads * sizeof(block_job_t))) == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes for block jobs\n", SIZE_T_CAST(num_threads * sizeof(block_job_t)));
+    return ERROR_MEMORY;
+  }
+  while (ret == NO_ERROR && MoreBlocks(buffer_env, parameters, range, next_block)) /* Process up to num_threads blocks at a time and write them in order */
   {
-    options_t * const options = parameters.options[i];
-    io_int_t enc_ret;
-    bit_file_buffer_t * const read_bit_buf = i == 0 ? buffer_env.in_bit_buf : buffer_env.temp_read_bit_buf; /* First read from input (file), rest from memory */
-    bit_file_buffer_t * const write_bit_buf = i == parameters.num_options - 1 ? buffer_env.out_bit_buf : buffer_env.temp_write_bit_buf; /* Last write to output (file), rest to memory */
+    const size_t first_block = next_block;
+    size_t num_jobs, num_started, i;
+    for (num_jobs = 0; num_jobs < num_threads && MoreBlocks(buffer_env, parameters, range, next_block); num_jobs++, next_block++)
+    {
+      if ((ret = PrepareBlockJob(&jobs[num_jobs], buffer_env, parameters, block_table, next_block)) != NO_ERROR)
+        break;
+    }
+    if (ret == NO_ERROR)
+    {
+      for (num_started = 0; num_started < num_jobs; num_started++)
+      {
+        if (StartThread(&jobs[num_started].thread, &RunBlockJob, &jobs[num_started]) != NO_ERROR)
+          break;
+      }
+      for (i = num_started; i < num_jobs; i++) /* Process the remaining blocks in this thread if no more threads can be started */
+        RunBlockJob(&jobs[i]);
+      for (i = 0; i < num_started; i++)
+        JoinThread(&jobs[i].thread); /* Ignore result */
+      if (stats != NULL) /* All blocks of this round are in memory at the same time */
+      {
+        size_t buffer_sizes[NUM_STATS_BUFFERS] = { 0 };
+        AddBufferSizes(buffer_env, buffer_sizes);
+        for (i = 0; i < num_jobs; i++)
+          AddBufferSizes(&jobs[i].buffers, buffer_sizes);
+        UpdateHighWaterMarks(stats->total.max_buffer_sizes, buffer_sizes);
+      }
+    }
+    for (i = 0; i < num_jobs; i++)
+    {
+      if (ret == NO_ERROR)
+        ret = FinishBlockJob(&jobs[i], buffer_env, parameters, block_table, range, first_block + i);
+      UninitBuffers(&jobs[i].buffers);
+    }
+  }
+  free(jobs);
+  if (ret == NO_ERROR && parameters->block_lines != 0 && (ret = WriteBlockTable(block_table, buffer_env->out_bit_buf)) != NO_ERROR)
+    LOG_ERROR(parameters->error_log_file, "%s while writing the block table\n", ERROR_MESSAGE_STRING(ret));
+  if (ret != NO_ERROR)
+    return ERROR_LIBRARY_CALL;
+  if (stats != NULL)
+  {
+    stats->total.input_bits = GetBitOffset(buffer_env->in_bit_buf);
+    stats->total.output_bits = GetBitOffset(buffer_env->out_bit_buf);
+  }
 #ifdef LOG_DIAGNOSTICS
-    clock_t start, end;
+  end = clock();
+  LOG_DIAG(stdout, "Processed %" SIZE_T_FORMAT " blocks with up to %" SIZE_T_FORMAT " threads\n", SIZE_T_CAST(next_block - range->first_block), SIZE_T_CAST(num_threads));
+  PrintTimeStatistics(end, start); /* Processor time of all threads together */
+  PrintIOStatistics(buffer_env->in_bit_buf, buffer_env->out_bit_buf, 1);
+  PrintBufferSizes(buffer_env);
 #endif
-    enc_dec_function_t * const enc_dec = options->encode ? options->encoder_decoder->encoder : options->encoder_decoder->decoder;
-    LOG_DIAG_OR_DEBUG(stdout, "Executing %s %s (%" SIZE_T_FORMAT " of %" SIZE_T_FORMAT " total)...\n", options->encode ? "encoder" : "decoder", GetEncoderDecoderName(enc_dec), SIZE_T_CAST(i + 1), SIZE_T_CAST(parameters.num_options));
-#ifdef _DEBUG
-    PrintEncoderConfiguration(stdout, parameters.error_log_file, options);
+  return NO_ERROR;
+}
+
+typedef struct batch_t /* Shared by all workers in batch mode */
+{
+  const batch_manifest_t *manifest;
+  const parameters_t *parameters;
+  mutex_t mutex;
+  size_t next_entry, num_failed; /* Protected by mutex */
+} batch_t;
+
+typedef struct batch_worker_t
+{
+  thread_t thread;
+  batch_t *batch;
+  buffer_environment_t buffers; /* Reused for all files processed by this worker */
+  io_uint_t input_bits, output_bits; /* Of all files processed successfully by this worker */
+  size_t max_buffer_sizes[NUM_STATS_BUFFERS];
+} batch_worker_t;
+
+static int ProcessBatchFile(buffer_environment_t * const buffers, const parameters_t * const parameters, const batch_entry_t * const entry) /* Returns ERROR_LIBRARY_INIT if the buffers cannot be reused */
+{
+  FILE *in_file, *out_file;
+  int ret;
+  if ((in_file = FOPEN(entry->in_file_name, "rb")) == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Could not open input file '%s'\n", entry->in_file_name);
+    return ERROR_FILE_IO;
+  }
+  if ((out_file = FOPEN(entry->out_file_name, "wb")) == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Could not open output file '%s'\n", entry->out_file_name);
+    fclose(in_file);
+    return ERROR_FILE_IO;
+  }
+  if (parameters->write_header && (ret = WriteHeader(out_file, parameters)) != NO_ERROR) /* Before the file buffers so that they start after the header */
+  {
+    fclose(out_file);
+    fclose(in_file);
+    return ret;
+  }
+  if (ReplaceBufferFiles(buffers, parameters->error_log_file, in_file, out_file, parameters->prefetch_input, parameters->write_behind_output) != NO_ERROR) /* The buffers own the files from now on */
+    return ERROR_LIBRARY_INIT;
+  if ((ret = RunSequentially(buffers, 0, NULL)) != NO_ERROR)
+    return ret;
+  if ((ret = PadToByteBoundary(buffers->out_bit_buf)) != NO_ERROR || (ret = FlushBitFileBuffer(buffers->out_bit_buf)) != NO_ERROR) /* Check for write errors which would be ignored when closing the file */
+  {
+    LOG_ERROR(parameters->error_log_file, "%s while writing output file '%s'\n", ERROR_MESSAGE_STRING(ret), entry->out_file_name);
+    return ret;
+  }
+  return NO_ERROR;
+}
+
+static void RunBatchWorker(void * const caller_info)
+{
+  batch_worker_t * const worker = (batch_worker_t * const)caller_info;
+  batch_t * const batch = worker->batch;
+  for (;;)
+  {
+    size_t entry;
+    int ret;
+    LockMutex(&batch->mutex);
+    entry = batch->next_entry < batch->manifest->num_entries ? batch->next_entry++ : batch->manifest->num_entries;
+    UnlockMutex(&batch->mutex);
+    if (entry == batch->manifest->num_entries)
+      break;
+    if ((ret = ProcessBatchFile(&worker->buffers, batch->parameters, &batch->manifest->entries[entry])) != NO_ERROR)
+    {
+      LOG_ERROR(batch->parameters->error_log_file, "Could not process input file '%s'\n", batch->manifest->entries[entry].in_file_name);
+      LockMutex(&batch->mutex);
+      batch->num_failed++;
+      UnlockMutex(&batch->mutex);
+      if (ret == ERROR_LIBRARY_INIT) /* Leave the remaining files to the other workers */
+        break;
+    }
+    else
+    {
+      worker->input_bits += GetBitOffset(worker->buffers.in_bit_buf);
+      worker->output_bits += GetBitOffset(worker->buffers.out_bit_buf);
+      UpdateBufferHighWaterMarks(&worker->buffers, worker->max_buffer_sizes);
+    }
+  }
+}
+
+static int RunBatch(const parameters_t * const parameters, run_stats_t * const stats)
+{
+  batch_manifest_t manifest;
+  batch_t batch;
+  batch_worker_t *workers;
+  size_t num_workers, num_initialized, num_started, num_unprocessed, i;
+  int ret;
+#ifdef LOG_DIAGNOSTICS
+  clock_t start, end;
+  start = clock();
 #endif
+  InitBatchManifest(&manifest);
+  if ((ret = (parameters->batch_manifest_name != NULL ? ReadBatchManifest(&manifest, parameters->batch_manifest_name, parameters->error_log_file) : ListBatchDirectory(&manifest, parameters->batch_in_dir_name, parameters->batch_out_dir_name, parameters->error_log_file))) != NO_ERROR)
+    return ret;
+  num_workers = GetNumberOfThreads(parameters) < manifest.num_entries ? GetNumberOfThreads(parameters) : manifest.num_entries;
+  if ((workers = (batch_worker_t*)malloc(num_workers * sizeof(batch_worker_t))) == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes for batch workers\n", SIZE_T_CAST(num_workers * sizeof(batch_worker_t)));
+    UninitBatchManifest(&manifest);
+    return ERROR_MEMORY;
+  }
+  if ((ret = InitMutex(&batch.mutex)) != NO_ERROR)
+  {
+    LOG_ERROR(parameters->error_log_file, "Could not initialize batch mutex\n");
+    free(workers);
+    UninitBatchManifest(&manifest);
+    return ret;
+  }
+  batch.manifest = &manifest;
+  batch.parameters = parameters;
+  batch.next_entry = batch.num_failed = 0;
+  for (num_initialized = 0; num_initialized < num_workers; num_initialized++)
+  {
+    batch_worker_t * const worker = &workers[num_initialized];
+    worker->batch = &batch;
+    worker->input_bits = worker->output_bits = 0;
+    memset(worker->max_buffer_sizes, 0, sizeof(worker->max_buffer_sizes));
+    InitBufferEnvironment(&worker->buffers); /* No files, i.e., in memory until the first file is processed */
+    if ((ret = InitBuffers(&worker->buffers, parameters, 1, 0)) != NO_ERROR)
+      break;
+  }
+  if (ret == NO_ERROR)
+  {
+    for (num_started = 0; num_started < num_workers; num_started++)
+    {
+      if (StartThread(&workers[num_started].thread, &RunBatchWorker, &workers[num_started]) != NO_ERROR)
+        break;
+    }
+    if (num_started < num_workers) /* Process files in this thread as well if not all threads can be started */
+      RunBatchWorker(&workers[num_started]);
+    for (i = 0; i < num_started; i++)
+      JoinThread(&workers[i].thread); /* Ignore result */
+  }
+  for (i = 0; i < num_initialized; i++)
+  {
+    size_t j;
+    stats->total.input_bits += workers[i].input_bits;
+    stats->total.output_bits += workers[i].output_bits;
+    for (j = 0; j < NUM_STATS_BUFFERS; j++) /* All workers run at the same time */
+      stats->total.max_buffer_sizes[j] += workers[i].max_buffer_sizes[j];
+    UninitBuffers(&workers[i].buffers);
+    UninitBufferEnvironment(&workers[i].buffers); /* Closes the last files */
+  }
+  free(workers);
+  UninitMutex(&batch.mutex);
+  num_unprocessed = manifest.num_entries - batch.next_entry;
+  UninitBatchManifest(&manifest);
+  if (ret == NO_ERROR && num_unprocessed != 0)
+    LOG_ERROR(parameters->error_log_file, "%" SIZE_T_FORMAT " files were not processed since no worker was left\n", SIZE_T_CAST(num_unprocessed));
+  if (ret != NO_ERROR || batch.num_failed != 0 || num_unprocessed != 0)
+    return ERROR_LIBRARY_CALL;
 #ifdef LOG_DIAGNOSTICS
-    start = clock();
+  end = clock();
+  LOG_DIAG(stdout, "Processed %" SIZE_T_FORMAT " files with up to %" SIZE_T_FORMAT " threads\n", SIZE_T_CAST(batch.next_entry), SIZE_T_CAST(num_workers));
+  PrintTimeStatistics(end, start); /* Processor time of all threads together */
+  PrintTotalTimeStatistics();
 #endif
-    if ((enc_ret = (*enc_dec)(read_bit_buf, write_bit_buf, options)) != NO_ERROR)
+  return NO_ERROR;
+}
+
+typedef struct evaluation_t /* Shared by all workers in evaluation mode */
+{
+  const evaluation_list_t *list;
+  const parameters_t *parameters;
+  const uint8_t *input;
+  size_t input_size;
+  evaluation_result_t *results; /* One per chain, each written by one worker only */
+  mutex_t mutex;
+  size_t next_chain; /* Protected by mutex */
+} evaluation_t;
+
+typedef struct evaluation_worker_t
+{
+  thread_t thread;
+  evaluation_t *evaluation;
+} evaluation_worker_t;
+
+static void RunEvaluationWorker(void * const caller_info)
+{
+  evaluation_t * const evaluation = ((evaluation_worker_t * const)caller_info)->evaluation;
+  for (;;)
+  {
+    size_t chain;
+    LockMutex(&evaluation->mutex);
+    chain = evaluation->next_chain < evaluation->list->num_chains ? evaluation->next_chain++ : evaluation->list->num_chains;
+    UnlockMutex(&evaluation->mutex);
+    if (chain == evaluation->list->num_chains)
+      break;
+    EvaluateChain(&evaluation->list->chains[chain], evaluation->parameters, evaluation->input, evaluation->input_size, &evaluation->results[chain]);
+  }
+}
+
+static int EvaluateChains(const parameters_t * const parameters, const evaluation_list_t * const list, const uint8_t * const input, const size_t input_size, evaluation_result_t * const results, size_t * const num_workers) /* Evaluates all chains of the list in parallel */
+{
+  evaluation_t evaluation;
+  evaluation_worker_t *workers;
+  size_t num_started, i;
+  int ret;
+  *num_workers = GetNumberOfThreads(parameters) < list->num_chains ? GetNumberOfThreads(parameters) : list->num_chains;
+  if ((workers = (evaluation_worker_t*)malloc(*num_workers * sizeof(evaluation_worker_t))) == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes for evaluation workers\n", SIZE_T_CAST(*num_workers * sizeof(evaluation_worker_t)));
+    return ERROR_MEMORY;
+  }
+  if ((ret = InitMutex(&evaluation.mutex)) != NO_ERROR)
+  {
+    LOG_ERROR(parameters->error_log_file, "Could not initialize evaluation mutex\n");
+    free(workers);
+    return ret;
+  }
+  evaluation.list = list;
+  evaluation.parameters = parameters;
+  evaluation.input = input;
+  evaluation.input_size = input_size;
+  evaluation.results = results;
+  evaluation.next_chain = 0;
+  for (num_started = 0; num_started < *num_workers; num_started++)
+  {
+    workers[num_started].evaluation = &evaluation;
+    if (StartThread(&workers[num_started].thread, &RunEvaluationWorker, &workers[num_started]) != NO_ERROR)
+      break;
+  }
+  if (num_started < *num_workers) /* Evaluate chains in this thread as well if not all threads can be started */
+    RunEvaluationWorker(&workers[num_started]);
+  for (i = 0; i < num_started; i++)
+    JoinThread(&workers[i].thread); /* Ignore result */
+  UninitMutex(&evaluation.mutex);
+  free(workers);
+  return NO_ERROR;
+}
+
+static int RunEvaluation(const parameters_t * const parameters, FILE * const in_file)
+{
+  evaluation_list_t list;
+  evaluation_result_t *results;
+  char *input;
+  size_t input_size, num_workers, num_failed = 0, i;
+  int ret;
+  InitEvaluationList(&list);
+  if ((ret = ReadEvaluationList(&list, parameters->evaluation_list_name, parameters->error_log_file)) != NO_ERROR)
+    return ret;
+  if ((ret = ReadWholeFile(in_file, &input, &input_size)) != NO_ERROR) /* Shared by all workers */
+  {
+    LOG_ERROR(parameters->error_log_file, "%s while reading the input file\n", ERROR_MESSAGE_STRING(ret));
+    free(input);
+    UninitEvaluationList(&list);
+    return ret;
+  }
+  if ((results = (evaluation_result_t*)malloc(list.num_chains * sizeof(evaluation_result_t))) == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes for evaluation results\n", SIZE_T_CAST(list.num_chains * sizeof(evaluation_result_t)));
+    free(input);
+    UninitEvaluationList(&list);
+    return ERROR_MEMORY;
+  }
+  if ((ret = EvaluateChains(parameters, &list, (const uint8_t*)input, input_size, results, &num_workers)) == NO_ERROR)
+  {
+    LOG(stdout, "Evaluated %" SIZE_T_FORMAT " chains on %" SIZE_T_FORMAT " bytes of input with up to %" SIZE_T_FORMAT " threads\n", SIZE_T_CAST(list.num_chains), SIZE_T_CAST(input_size), SIZE_T_CAST(num_workers));
+    PrintEvaluationTable(stdout, &list, results);
+    for (i = 0; i < list.num_chains; i++)
     {
-      LOG_ERROR(parameters.error_log_file, "%s while executing encoder/decoder %" SIZE_T_FORMAT " of %" SIZE_T_FORMAT "\n", ERROR_MESSAGE_STRING(enc_ret), SIZE_T_CAST(i + 1), SIZE_T_CAST(parameters.num_options));
-      UninitBuffers(&buffer_env);
-      UninitBufferEnvironment(&buffer_env);
-      return ERROR_LIBRARY_CALL;
+      if (results[i].ret != NO_ERROR || !results[i].verified)
+        num_failed++;
     }
+  }
+  free(results);
+  free(input);
+  UninitEvaluationList(&list);
+  if (ret != NO_ERROR)
+    return ret;
+  if (num_failed != 0)
+  {
+    LOG_ERROR(parameters->error_log_file, "%" SIZE_T_FORMAT " chains could not be evaluated or did not reproduce the input\n", SIZE_T_CAST(num_failed));
+    return ERROR_LIBRARY_CALL;
+  }
+  return NO_ERROR;
+}
+
+static int ReadSample(const parameters_t * const parameters, FILE * const in_file, char ** const sample, size_t * const sample_size) /* Reads the sample of 'encode auto' from the current position, cuts it after the last complete line and seeks back */
+{
+  const io_int_t start_offset = FTELL(in_file);
+  int ret = NO_ERROR;
+  if (start_offset < 0)
+  {
+    LOG_ERROR(parameters->error_log_file, "'encode auto' requires a seekable input file\n");
+    *sample = NULL;
+    return ERROR_FILE_IO;
+  }
+  if (parameters->auto_sample_size == 0)
+    ret = ReadWholeFile(in_file, sample, sample_size);
+  else if ((*sample = (char*)malloc(parameters->auto_sample_size)) == NULL)
+    ret = ERROR_MEMORY;
+  else
+  {
+    *sample_size = fread(*sample, 1, parameters->auto_sample_size, in_file);
+    if (ferror(in_file))
+      ret = ERROR_FILE_IO;
+    else if (*sample_size == parameters->auto_sample_size) /* The input may continue in the middle of a line */
+    {
+      size_t line_end = *sample_size;
+      while (line_end != 0 && (*sample)[line_end - 1] != '\n')
+        line_end--;
+      if (line_end != 0) /* Keep the whole sample if it has no line break (e.g., binary input) */
+        *sample_size = line_end;
+    }
+  }
+  if (ret != NO_ERROR)
+  {
+    LOG_ERROR(parameters->error_log_file, "%s while reading the sample of the input file\n", ERROR_MESSAGE_STRING(ret));
+    return ret;
+  }
+  if (FSEEK(in_file, start_offset, SEEK_SET) != 0)
+  {
+    LOG_ERROR(parameters->error_log_file, "'encode auto' requires a seekable input file\n");
+    return ERROR_FILE_IO;
+  }
+  return NO_ERROR;
+}
+
+static int SelectEncoders(parameters_t * const parameters, FILE * const in_file) /* Selects the encoders of 'encode auto' by trial compression of a sample of the input file. Each worker thread holds the compressed and the decompressed sample (both as large as the sample unless a candidate expands it) and the pipeline of its candidate, e.g., the peak allocated memory for the 571 KiB test input is about 1.6 MiB with one thread and about 11 MiB with one thread per candidate */
+{
+  evaluation_list_t list;
+  evaluation_result_t *results;
+  char *sample;
+  size_t sample_size, num_workers, best;
+  int ret;
+  if ((ret = ReadSample(parameters, in_file, &sample, &sample_size)) != NO_ERROR)
+  {
+    free(sample);
+    return ret;
+  }
+  InitEvaluationList(&list);
+  if ((ret = CreateCandidateList(&list, parameters->error_log_file)) != NO_ERROR)
+  {
+    free(sample);
+    return ret;
+  }
+  if ((results = (evaluation_result_t*)malloc(list.num_chains * sizeof(evaluation_result_t))) == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes for evaluation results\n", SIZE_T_CAST(list.num_chains * sizeof(evaluation_result_t)));
+    UninitEvaluationList(&list);
+    free(sample);
+    return ERROR_MEMORY;
+  }
+  if ((ret = EvaluateChains(parameters, &list, (const uint8_t*)sample, sample_size, results, &num_workers)) == NO_ERROR)
+  {
 #ifdef LOG_DIAGNOSTICS
-    end = clock();
-    PrintTimeStatistics(end, start);
-    PrintIOStatistics(read_bit_buf, write_bit_buf, i == 0);
-    PrintBufferSizes(&buffer_env);
+    LOG_DIAG(stdout, "Trial-compressed %" SIZE_T_FORMAT " bytes of input with %" SIZE_T_FORMAT " candidate chains and up to %" SIZE_T_FORMAT " threads\n", SIZE_T_CAST(sample_size), SIZE_T_CAST(list.num_chains), SIZE_T_CAST(num_workers));
+    if (text_diagnostics)
+      PrintEvaluationTable(stdout, &list, results);
 #endif
-    if (parameters.num_options > 1 && i < parameters.num_options - 1 && (ret = SwitchTempBuffers(&buffer_env, parameters.error_log_file)) != NO_ERROR) /* Switch temporary buffer from reading to reading after all but the last encoding process (only required when the temporary buffer is needed, i.e., with at least two encoders) */
+    if ((best = SelectChain(&list, results, parameters->auto_policy)) == list.num_chains)
     {
-      UninitBuffers(&buffer_env);
-      UninitBufferEnvironment(&buffer_env);
-      return ERROR_LIBRARY_CALL;
+      LOG_ERROR(parameters->error_log_file, "None of the candidate chains reproduces the sample of the input file\n");
+      ret = ERROR_INVALID_FORMAT;
     }
+    else
+    {
+      evaluation_chain_t * const chain = &list.chains[best];
+      memcpy(parameters->options, chain->options, chain->num_options * sizeof(options_t*)); /* The parameters own the options of the selected chain from now on */
+      parameters->num_options = chain->num_options;
+      chain->num_options = 0;
+      parameters->write_header = 1; /* Records the selected chain for 'decode auto' */
+      LOG_DIAG(stdout, "Selected chain '%s' (%s)\n", chain->name, parameters->auto_policy == AP_SPEED ? "shortest encoding time" : "smallest output");
+    }
+  }
+  free(results);
+  UninitEvaluationList(&list);
+  free(sample);
+  return ret;
+}
+
+static int SelectBlocks(const block_table_t * const block_table, const parameters_t * const parameters, FILE * const in_file, block_range_t * const range) /* Determines the blocks covering the selected lines and seeks to the first one */
+{
+  io_uint_t num_lines, end_line;
+  range->first_block = 0;
+  range->end_block = block_table->num_blocks;
+  range->skip_lines = 0;
+  range->num_lines = MAX_IO_UINT_VALUE;
+  if (!parameters->select_range)
+    return NO_ERROR;
+  if (!parameters->unblock) /* Only checked here since 'decode auto' determines whether the input file is a block container */
+  {
+    LOG_ERROR(parameters->error_log_file, "The global option '--range' requires '--unblock' or a block container with a header\n");
+    return ERROR_INVALID_VALUE;
+  }
+  if (parameters->range_start >= (num_lines = GetNumberOfLines(block_table)))
+  {
+    LOG_ERROR(parameters->error_log_file, "The first line of the range must be less than the number of lines in the block container (%" IO_UINT_FORMAT ")\n", num_lines);
+    return ERROR_INVALID_VALUE;
+  }
+  end_line = parameters->range_count < num_lines - parameters->range_start ? parameters->range_start + parameters->range_count : num_lines; /* Exclusive */
+  range->first_block = FindBlockOfLine(block_table, parameters->range_start);
+  range->end_block = FindBlockOfLine(block_table, end_line - 1) + 1;
+  range->skip_lines = parameters->range_start - block_table->entries[range->first_block].first_line;
+  range->num_lines = end_line - parameters->range_start;
+  if (SeekToBlock(block_table, in_file, range->first_block) != NO_ERROR)
+  {
+    LOG_ERROR(parameters->error_log_file, "Could not seek to block %" SIZE_T_FORMAT "\n", SIZE_T_CAST(range->first_block + 1));
+    return ERROR_FILE_IO;
+  }
+  return NO_ERROR;
+}
+
+int main(const int argc, const char * const * const argv)
+{
+  buffer_environment_t buffer_env;
+  parameters_t parameters;
+  block_table_t block_table;
+  block_range_t block_range;
+  run_stats_t stats;
+  int ret, block_mode;
+  LOG_DEBUG(stdout, BITSIZE_INFO_PRINT_ARGS);
+  InitBufferEnvironment(&buffer_env);
+  InitBlockTable(&block_table);
+  parameters.error_log_file = stderr; /* Default: Log errors to stderr */
+  if ((ret = ProcessParameters(argc - 1, &argv[1], &parameters, &buffer_env.in_file, &buffer_env.out_file)) != NO_ERROR)
+  {
+    UninitBufferEnvironment(&buffer_env);
+    return ret;
+  }
+#if defined(LOG_DIAGNOSTICS) || defined(_DEBUG)
+  text_diagnostics = !parameters.json_stats;
+#endif
+  if (BATCH_MODE(&parameters)) /* No files have been opened */
+  {
+    StartRunStatistics(&stats, "batch", &parameters);
+    ret = RunBatch(&parameters, &stats);
+    FinishRunStatistics(&stats);
+    if (ret == NO_ERROR && parameters.json_stats)
+      WriteStatisticsJSON(stdout, &stats);
+    return ret;
+  }
+  if (EVALUATION_MODE(&parameters)) /* Only the input file has been opened */
+  {
+    ret = RunEvaluation(&parameters, buffer_env.in_file);
+    UninitBufferEnvironment(&buffer_env);
+    return ret;
+  }
+  if ((parameters.auto_decode && (ret = ReadHeader(buffer_env.in_file, &parameters)) != NO_ERROR) /* Before the block table since it determines whether the input file is a block container */
+    || (parameters.unblock && (ret = ReadBlockTable(&block_table, buffer_env.in_file, parameters.error_log_file)) != NO_ERROR) /* Before the input file buffer starts reading */
+    || (parameters.auto_encode && (ret = SelectEncoders(&parameters, buffer_env.in_file)) != NO_ERROR) || (parameters.write_header && (ret = WriteHeader(buffer_env.out_file, &parameters)) != NO_ERROR) /* Before the file buffers so that they start after the header */
+    || (ret = SelectBlocks(&block_table, &parameters, buffer_env.in_file, &block_range)) != NO_ERROR) /* Skips unselected blocks before the input file buffer starts reading (only with --range, i.e., with blocks) */
+  {
+    UninitBlockTable(&block_table);
+    UninitBufferEnvironment(&buffer_env);
+    return ret;
+  }
+  block_mode = parameters.block_lines != 0 || parameters.unblock;
+  if ((ret = InitBuffers(&buffer_env, &parameters, !(parameters.pipeline && parameters.num_options > 1) && !block_mode, parameters.pipeline ? parameters.num_options - 1 : 0)) != NO_ERROR)
+  {
+    UninitBuffers(&buffer_env);
+    UninitBlockTable(&block_table);
+    UninitBufferEnvironment(&buffer_env);
+    return ret;
+  }
+#ifdef LOG_DIAGNOSTICS
+  PrintBufferSizes(&buffer_env);
+#endif
+  StartRunStatistics(&stats, block_mode ? "blocks" : (parameters.pipeline && parameters.num_options > 1 ? "pipeline" : "sequential"), &parameters);
+  if (block_mode)
+    ret = RunBlocks(&buffer_env, &parameters, &block_table, &block_range, parameters.json_stats ? &stats : NULL);
+  else if (parameters.pipeline && parameters.num_options > 1)
+    ret = RunPipeline(&buffer_env, &parameters, parameters.json_stats ? &stats : NULL);
+  else
+    ret = RunSequentially(&buffer_env, 1, parameters.json_stats ? &stats : NULL);
+  FinishRunStatistics(&stats);
+  if (ret != NO_ERROR)
+  {
+    UninitBuffers(&buffer_env);
+    UninitBlockTable(&block_table);
+    UninitBufferEnvironment(&buffer_env);
+    return ret;
   }
+  if (parameters.json_stats)
+    WriteStatisticsJSON(stdout, &stats);
 #ifdef LOG_DIAGNOSTICS
   PrintTotalTimeStatistics();
 #endif
   UninitBuffers(&buffer_env);
+  UninitBlockTable(&block_table);
   UninitBufferEnvironment(&buffer_env);
   return 0;
 }
\ No newline at end of file
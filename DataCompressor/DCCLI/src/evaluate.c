@@ -0,0 +1,319 @@
+/* Evaluation of multiple chains of encoders/decoders
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "err_codes.h"
+#include "evaluate.h"
+#include "log.h"
+#include "batch.h"
+#include "pipeline.h"
+#include "timer.h"
+#include "allocation.h"
+
+#include <string.h>
+
+#define MAX_CHAIN_ARGUMENTS 256
+
+static const char * const candidate_chains[] = { /* Candidates of 'encode auto' in list layout. Variants with other decimal places only reproduce inputs with this number of decimal places */
+  "DEGA\tdecode csv # encode normalize # encode diff # encode seg # encode bac adaptive",
+  "DEGA/int\tdecode csv num_decimal_places=0 # encode normalize normalization_factor=1 # encode diff # encode seg # encode bac adaptive",
+  "DEGA/3dp\tdecode csv num_decimal_places=3 # encode normalize normalization_factor=1000 # encode diff # encode seg # encode bac adaptive",
+  "LZMH\tencode lzmh",
+  "A-XDR\tdecode csv # encode normalize",
+  "A-XDR/16\tdecode csv # encode normalize valuesize=16",
+  "A-XDR/int\tdecode csv num_decimal_places=0 # encode normalize normalization_factor=1",
+  "A-XDR/int16\tdecode csv num_decimal_places=0 # encode normalize normalization_factor=1 valuesize=16",
+  "A-XDR/3dp\tdecode csv num_decimal_places=3 # encode normalize normalization_factor=1000"
+};
+
+static const size_t num_candidate_chains = sizeof(candidate_chains) / sizeof(candidate_chains[0]);
+
+void InitEvaluationList(evaluation_list_t * const list)
+{
+  list->data = list->arguments = NULL;
+  list->chains = NULL;
+  list->num_chains = 0;
+}
+
+void UninitEvaluationList(evaluation_list_t * const list)
+{
+  size_t i, j;
+  for (i = 0; i < list->num_chains; i++)
+  {
+    for (j = 0; j < list->chains[i].num_options; j++)
+      free(list->chains[i].options[j]);
+  }
+  free(list->chains);
+  free(list->arguments);
+  free(list->data);
+  InitEvaluationList(list);
+}
+
+static size_t CountLines(const char * const data)
+{
+  const char *line_end = data;
+  size_t num_lines = 1;
+  while ((line_end = strchr(line_end, '\n')) != NULL)
+  {
+    line_end++;
+    num_lines++;
+  }
+  return num_lines;
+}
+
+static int SplitArguments(char * const chain, const char ** const argv, size_t * const argc) /* Splits the chain at spaces in place */
+{
+  char *argument = chain;
+  *argc = 0;
+  for (;;)
+  {
+    argument += strspn(argument, " ");
+    if (argument[0] == '\0')
+      return NO_ERROR;
+    if (*argc == MAX_CHAIN_ARGUMENTS)
+      return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+    argv[(*argc)++] = argument;
+    argument += strcspn(argument, " ");
+    if (argument[0] != '\0')
+      *argument++ = '\0';
+  }
+}
+
+static int ParseEvaluationList(evaluation_list_t * const list, const size_t size, FILE * const error_log_file)
+{
+  const char *argv[MAX_CHAIN_ARGUMENTS];
+  char *line = list->data, *arguments = list->arguments;
+  size_t line_number = 1;
+  int ret;
+  while (line < list->data + size)
+  {
+    char * const line_end = line + strcspn(line, "\n");
+    evaluation_chain_t * const chain = &list->chains[list->num_chains];
+    char *separator;
+    size_t argc;
+    if (line_end > line && line_end[-1] == '\r') /* Allow Windows line endings */
+      line_end[-1] = '\0';
+    *line_end = '\0';
+    separator = strchr(line, '\t');
+    if (line[strspn(line, " ")] != '\0') /* Skip empty lines */
+    {
+      if (separator != NULL && (separator == line || strchr(separator + 1, '\t') != NULL))
+      {
+        LOG_ERROR(error_log_file, "Expected '[<name><tab>]<encoders/decoders>' in line %" SIZE_T_FORMAT " of the pipeline list\n", SIZE_T_CAST(line_number));
+        return ERROR_INVALID_FORMAT;
+      }
+      chain->name = line;
+      chain->num_options = 0;
+      strcpy(arguments, separator != NULL ? separator + 1 : line);
+      if (separator != NULL)
+        *separator = '\0';
+      list->num_chains++; /* Free the options of this chain in any case */
+      if ((ret = SplitArguments(arguments, argv, &argc)) != NO_ERROR)
+      {
+        LOG_ERROR(error_log_file, "The number of arguments in line %" SIZE_T_FORMAT " of the pipeline list is limited to %d\n", SIZE_T_CAST(line_number), MAX_CHAIN_ARGUMENTS);
+        return ret;
+      }
+      if (argc == 0 || (ret = ParseEncoderChain(argc, argv, chain->options, &chain->num_options, error_log_file)) != NO_ERROR)
+      {
+        LOG_ERROR(error_log_file, "Invalid encoders/decoders in line %" SIZE_T_FORMAT " of the pipeline list\n", SIZE_T_CAST(line_number));
+        return argc == 0 ? ERROR_INVALID_FORMAT : ret;
+      }
+      arguments += strlen(arguments) + 1;
+    }
+    line = line_end + 1;
+    line_number++;
+  }
+  return NO_ERROR;
+}
+
+static int ProcessEvaluationData(evaluation_list_t * const list, const size_t size, const char * const list_name, FILE * const error_log_file) /* Parses list->data. Uninitializes the list on error */
+{
+  const size_t num_lines = CountLines(list->data);
+  int ret;
+  if ((list->arguments = (char*)malloc(size + 1)) == NULL || (list->chains = (evaluation_chain_t*)malloc(num_lines * sizeof(evaluation_chain_t))) == NULL)
+  {
+    LOG_ERROR(error_log_file, "Error allocating memory for the pipeline list '%s'\n", list_name);
+    UninitEvaluationList(list);
+    return ERROR_MEMORY;
+  }
+  if ((ret = ParseEvaluationList(list, size, error_log_file)) != NO_ERROR)
+  {
+    UninitEvaluationList(list);
+    return ret;
+  }
+  if (list->num_chains == 0)
+  {
+    LOG_ERROR(error_log_file, "The pipeline list '%s' does not contain any chains of encoders/decoders\n", list_name);
+    UninitEvaluationList(list);
+    return ERROR_INVALID_FORMAT;
+  }
+  return NO_ERROR;
+}
+
+int ReadEvaluationList(evaluation_list_t * const list, const char * const file_name, FILE * const error_log_file)
+{
+  const int use_stdin = strcmp(file_name, "-") == 0;
+  FILE * const list_file = use_stdin ? stdin : FOPEN(file_name, "rb");
+  size_t size;
+  int ret;
+  if (list_file == NULL)
+  {
+    LOG_ERROR(error_log_file, "Could not open pipeline list '%s'\n", file_name);
+    return ERROR_FILE_IO;
+  }
+  ret = ReadWholeFile(list_file, &list->data, &size);
+  if (!use_stdin)
+    fclose(list_file);
+  if (ret != NO_ERROR)
+  {
+    LOG_ERROR(error_log_file, "%s while reading pipeline list '%s'\n", ERROR_MESSAGE_STRING(ret), file_name);
+    UninitEvaluationList(list);
+    return ret;
+  }
+  return ProcessEvaluationData(list, size, file_name, error_log_file);
+}
+
+int CreateCandidateList(evaluation_list_t * const list, FILE * const error_log_file)
+{
+  size_t size = 0, i;
+  for (i = 0; i < num_candidate_chains; i++)
+    size += strlen(candidate_chains[i]) + 1; /* Line break or terminator */
+  if ((list->data = (char*)malloc(size)) == NULL)
+  {
+    LOG_ERROR(error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes for the candidate list\n", SIZE_T_CAST(size));
+    return ERROR_MEMORY;
+  }
+  list->data[0] = '\0';
+  for (i = 0; i < num_candidate_chains; i++)
+  {
+    strcat(list->data, candidate_chains[i]);
+    if (i != num_candidate_chains - 1)
+      strcat(list->data, "\n");
+  }
+  return ProcessEvaluationData(list, size - 1, "candidates", error_log_file);
+}
+
+static int Compress(pipeline_t * const pipeline, const uint8_t * const input, const size_t input_size, uint8_t ** const output, size_t * const output_capacity, size_t * const output_size, double * const seconds) /* Doubles the output buffer (up to the output bound) and repeats the run if it is too small. Only the last run is timed */
+{
+  const size_t bound = GetPipelineOutputBound(pipeline, input_size, 1);
+  int ret;
+  for (;;)
+  {
+    const double start = GetWallClockTime();
+    ret = CompressToMemory(pipeline, input, input_size, *output, *output_capacity, output_size);
+    *seconds = GetWallClockTime() - start;
+    if (ret != ERROR_OUTPUT_FULL || *output_capacity >= bound) /* The bound always suffices */
+      return ret;
+    *output_capacity = *output_capacity > bound / 2 ? bound : 2 * *output_capacity;
+    free(*output); /* The incomplete output is discarded */
+    if ((*output = (uint8_t*)malloc(*output_capacity)) == NULL)
+    {
+      *output_capacity = 0;
+      return ERROR_MEMORY;
+    }
+  }
+}
+
+void EvaluateChain(const evaluation_chain_t * const chain, const parameters_t * const parameters, const uint8_t * const input, const size_t input_size, evaluation_result_t * const result)
+{
+  pipeline_t *pipeline;
+  uint8_t *compressed, *decompressed;
+  const size_t initial_capacity = input_size != 0 ? input_size : 1; /* The compressed data is usually smaller than the input (Compress grows the buffer otherwise). Larger decompressed data cannot be identical to the input */
+  size_t compressed_capacity = initial_capacity, decompressed_size;
+  uint64_t start_bytes;
+  result->verified = 0;
+  result->input_size = input_size;
+  result->compressed_size = 0;
+  result->encode_seconds = result->decode_seconds = 0;
+  result->peak_bytes = 0;
+  if ((compressed = (uint8_t*)malloc(initial_capacity)) == NULL || (decompressed = (uint8_t*)malloc(initial_capacity)) == NULL) /* Not allocated with AllocateMemory so that only the allocations of the chain count towards the tracked peak */
+  {
+    LOG_ERROR(parameters->error_log_file, "Error allocating output buffers for '%s'\n", chain->name);
+    free(compressed);
+    result->ret = ERROR_MEMORY;
+    return;
+  }
+  ResetThreadPeakAllocatedBytes();
+  start_bytes = GetThreadPeakAllocatedBytes(); /* Allocated by the thread before */
+  if ((pipeline = AllocatePipeline()) == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Could not allocate pipeline object for '%s'\n", chain->name);
+    result->ret = ERROR_MEMORY;
+  }
+  else if ((result->ret = InitPipeline(pipeline, chain->options, chain->num_options, parameters->fuse_encoders, parameters->memory_budget)) != NO_ERROR)
+  {
+    LOG_ERROR(parameters->error_log_file, "Could not initialize pipeline object for '%s'\n", chain->name);
+    FreePipeline(pipeline);
+    pipeline = NULL;
+  }
+  else if ((result->ret = Compress(pipeline, input, input_size, &compressed, &compressed_capacity, &result->compressed_size, &result->encode_seconds)) != NO_ERROR)
+  {
+    LOG_ERROR(parameters->error_log_file, "%s while compressing with '%s'\n", ERROR_MESSAGE_STRING(result->ret), chain->name);
+  }
+  else
+  {
+    const double start = GetWallClockTime();
+    result->ret = DecompressToMemory(pipeline, compressed, result->compressed_size, decompressed, initial_capacity, &decompressed_size);
+    result->decode_seconds = GetWallClockTime() - start;
+    if (result->ret == ERROR_OUTPUT_FULL) /* Not identical */
+      result->ret = NO_ERROR;
+    else if (result->ret != NO_ERROR)
+    {
+      LOG_ERROR(parameters->error_log_file, "%s while decompressing with the inverse of '%s'\n", ERROR_MESSAGE_STRING(result->ret), chain->name);
+    }
+    else
+      result->verified = decompressed_size == input_size && memcmp(decompressed, input, input_size) == 0;
+  }
+  result->peak_bytes = GetThreadPeakAllocatedBytes() - start_bytes;
+  free(decompressed);
+  free(compressed);
+  if (pipeline != NULL)
+  {
+    UninitPipeline(pipeline);
+    FreePipeline(pipeline);
+  }
+}
+
+size_t SelectChain(const evaluation_list_t * const list, const evaluation_result_t * const results, const auto_policy_t policy)
+{
+  size_t best = list->num_chains, i;
+  for (i = 0; i < list->num_chains; i++)
+  {
+    int better;
+    if (results[i].ret != NO_ERROR || !results[i].verified)
+      continue;
+    if (best == list->num_chains)
+      better = 1;
+    else if (policy == AP_SPEED)
+      better = results[i].encode_seconds < results[best].encode_seconds || (results[i].encode_seconds == results[best].encode_seconds && results[i].compressed_size < results[best].compressed_size);
+    else
+      better = results[i].compressed_size < results[best].compressed_size || (results[i].compressed_size == results[best].compressed_size && results[i].encode_seconds < results[best].encode_seconds);
+    if (better)
+      best = i;
+  }
+  return best;
+}
+
+static double GetMegabytesPerSecond(const size_t size, const double seconds)
+{
+  return seconds > 0 ? (double)size / seconds / 1e6 : 0;
+}
+
+void PrintEvaluationTable(FILE * const output, const evaluation_list_t * const list, const evaluation_result_t * const results)
+{
+  size_t i;
+  LOG(output, "%-24s %12s %8s %12s %12s %14s  %s\n", "Pipeline", "Size [B]", "Ratio", "Enc. [MB/s]", "Dec. [MB/s]", "Peak mem. [B]", "Round trip");
+  for (i = 0; i < list->num_chains; i++)
+  {
+    const evaluation_result_t * const result = &results[i];
+    if (result->ret != NO_ERROR)
+    {
+      LOG(output, "%-24s %12s %8s %12s %12s %14s  %s\n", list->chains[i].name, "-", "-", "-", "-", "-", ERROR_MESSAGE_STRING(result->ret));
+    }
+    else
+    {
+      LOG(output, "%-24s %12" SIZE_T_FORMAT " %8.3f %12.2f %12.2f %14" PRIu64 "  %s\n", list->chains[i].name, SIZE_T_CAST(result->compressed_size), result->compressed_size != 0 ? (double)result->input_size / result->compressed_size : 0,
+        GetMegabytesPerSecond(result->input_size, result->encode_seconds), GetMegabytesPerSecond(result->input_size, result->decode_seconds), result->peak_bytes, result->verified ? "verified" : "MISMATCH");
+    }
+  }
+}
\ No newline at end of file
@@ -0,0 +1,297 @@
+/* Self-describing file header
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "err_codes.h"
+#include "header.h"
+#include "log.h"
+
+#include <string.h>
+
+#define MAGIC_SIZE 4
+#define HEADER_VERSION 2
+#define MAX_NAME_LENGTH UINT8_MAX
+#define MAX_VALUE_SIZE 8 /* Bytes */
+
+/* Header flags */
+#define HF_BLOCKS 1 /* Block container (see --blocks) */
+
+static const uint8_t magic[MAGIC_SIZE] = { 'D', 'C', 'H', 'D' };
+
+static int WriteValue(FILE * const output_file, const io_uint_t value, const size_t size)
+{
+  uint8_t bytes[MAX_VALUE_SIZE];
+  size_t i;
+  for (i = 0; i < size; i++) /* Little endian */
+    bytes[i] = (uint8_t)(i < sizeof(io_uint_t) ? value >> (8 * i) : 0);
+  return fwrite(bytes, 1, size, output_file) == size ? NO_ERROR : ERROR_FILE_IO;
+}
+
+static int ReadValue(FILE * const input_file, io_uint_t * const value, const size_t size)
+{
+  uint8_t bytes[MAX_VALUE_SIZE];
+  size_t i;
+  if (fread(bytes, 1, size, input_file) != size)
+    return ERROR_INVALID_FORMAT; /* Truncated */
+  *value = 0;
+  for (i = 0; i < size; i++)
+  {
+    if (i >= sizeof(io_uint_t))
+    {
+      if (bytes[i] != 0)
+        return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+    }
+    else
+      *value |= (io_uint_t)bytes[i] << (8 * i);
+  }
+  return NO_ERROR;
+}
+
+static int WriteName(FILE * const output_file, const char * const name)
+{
+  const size_t length = strlen(name);
+  int ret;
+  if (length > MAX_NAME_LENGTH)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if ((ret = WriteValue(output_file, length, 1)) != NO_ERROR)
+    return ret;
+  return fwrite(name, 1, length, output_file) == length ? NO_ERROR : ERROR_FILE_IO;
+}
+
+static int ReadName(FILE * const input_file, char * const name) /* name must have space for MAX_NAME_LENGTH characters plus terminator */
+{
+  io_uint_t length;
+  int ret;
+  if ((ret = ReadValue(input_file, &length, 1)) != NO_ERROR)
+    return ret;
+  if (fread(name, 1, (size_t)length, input_file) != (size_t)length)
+    return ERROR_INVALID_FORMAT; /* Truncated */
+  name[length] = '\0';
+  return NO_ERROR;
+}
+
+static int WriteOption(FILE * const output_file, const options_t * const options, const char * const option_name)
+{
+  const option_type_t type = GetOptionType(option_name);
+  int ret, bool_value;
+  size_t size_value;
+  float float_value;
+  uint32_t float_bits;
+  char char_value;
+  if ((ret = WriteName(output_file, option_name)) != NO_ERROR || (ret = WriteValue(output_file, type, 1)) != NO_ERROR)
+    return ret;
+  switch (type)
+  {
+    case OT_BOOL:
+      if ((ret = GetOptionValueBool(options, option_name, &bool_value)) != NO_ERROR)
+        return ret;
+      return WriteValue(output_file, bool_value != 0, 1);
+    case OT_SIZE:
+      if ((ret = GetOptionValueSize(options, option_name, &size_value)) != NO_ERROR)
+        return ret;
+      return WriteValue(output_file, size_value, 8);
+    case OT_FLOAT:
+      if ((ret = GetOptionValueFloat(options, option_name, &float_value)) != NO_ERROR)
+        return ret;
+      memcpy(&float_bits, &float_value, sizeof(float_bits)); /* Assumes IEEE 754 single precision floats */
+      return WriteValue(output_file, float_bits, sizeof(float_bits));
+    case OT_CHAR:
+      if ((ret = GetOptionValueChar(options, option_name, &char_value)) != NO_ERROR)
+        return ret;
+      return WriteValue(output_file, (uint8_t)char_value, 1);
+    case OT_INVALID:
+    default:
+      return ERROR_INVALID_VALUE;
+  }
+}
+
+static int ReadOption(FILE * const input_file, options_t * const options)
+{
+  char option_name[MAX_NAME_LENGTH + 1];
+  io_uint_t type, value;
+  float float_value;
+  uint32_t float_bits;
+  int ret;
+  if ((ret = ReadName(input_file, option_name)) != NO_ERROR || (ret = ReadValue(input_file, &type, 1)) != NO_ERROR)
+    return ret;
+  if (!OptionNameExists(option_name) || (io_uint_t)GetOptionType(option_name) != type)
+  {
+    LOG_ERROR(options->error_log_file, "Unknown option '%s' in header\n", option_name);
+    return ERROR_INVALID_FORMAT;
+  }
+  switch (type)
+  {
+    case OT_BOOL:
+      if ((ret = ReadValue(input_file, &value, 1)) != NO_ERROR)
+        return ret;
+      return SetOptionValueBool(options, option_name, value != 0);
+    case OT_SIZE:
+      if ((ret = ReadValue(input_file, &value, 8)) != NO_ERROR)
+        return ret;
+      if (value > SIZE_MAX)
+        return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+      return SetOptionValueSize(options, option_name, (size_t)value);
+    case OT_FLOAT:
+      if ((ret = ReadValue(input_file, &value, sizeof(float_bits))) != NO_ERROR)
+        return ret;
+      float_bits = (uint32_t)value;
+      memcpy(&float_value, &float_bits, sizeof(float_value));
+      return SetOptionValueFloat(options, option_name, float_value);
+    case OT_CHAR:
+      if ((ret = ReadValue(input_file, &value, 1)) != NO_ERROR)
+        return ret;
+      return SetOptionValueChar(options, option_name, (char)value);
+    default:
+      return ERROR_INVALID_FORMAT;
+  }
+}
+
+static const char *GetFunctionName(const options_t * const options)
+{
+  return GetEncoderNameFromFunction(options->encode ? options->encoder_decoder->encoder : options->encoder_decoder->decoder, options->encode);
+}
+
+static int WriteEncoder(FILE * const output_file, const options_t * const options, const char ** const option_names, const size_t num_option_names)
+{
+  enc_dec_function_t * const inverse_function = options->encode ? options->encoder_decoder->decoder : options->encoder_decoder->encoder;
+  const char * const name = GetFunctionName(options);
+  size_t i;
+  int ret;
+  if (inverse_function == NULL)
+  {
+    LOG_ERROR(options->error_log_file, "The %s '%s' cannot be inverted, i.e., its output cannot be decoded automatically\n", options->encode ? "encoder" : "decoder", name);
+    return ERROR_INVALID_MODE;
+  }
+  if ((ret = WriteValue(output_file, options->encode != 0, 1)) != NO_ERROR || (ret = WriteName(output_file, name)) != NO_ERROR || (ret = WriteValue(output_file, num_option_names, 1)) != NO_ERROR)
+    return ret;
+  for (i = 0; i < num_option_names; i++)
+  {
+    if ((ret = WriteOption(output_file, options, option_names[i])) != NO_ERROR)
+      return ret;
+  }
+  return NO_ERROR;
+}
+
+static int ReadInverseEncoder(FILE * const input_file, options_t * const options)
+{
+  char name[MAX_NAME_LENGTH + 1];
+  io_uint_t encode, num_option_names, i;
+  int ret;
+  if ((ret = ReadValue(input_file, &encode, 1)) != NO_ERROR || (ret = ReadName(input_file, name)) != NO_ERROR)
+    return ret;
+  if ((options->encoder_decoder = GetEncoder(name)) == NULL)
+  {
+    LOG_ERROR(options->error_log_file, "Unknown encoder/decoder '%s' in header\n", name);
+    return ERROR_INVALID_FORMAT;
+  }
+  options->encode = !encode; /* Inverse */
+  if ((options->encode ? options->encoder_decoder->encoder : options->encoder_decoder->decoder) == NULL)
+  {
+    LOG_ERROR(options->error_log_file, "The %s '%s' in the header cannot be inverted\n", encode ? "encoder" : "decoder", name);
+    return ERROR_INVALID_MODE;
+  }
+  SetDefaultOptions(options); /* For options which are not stored */
+  if ((ret = ReadValue(input_file, &num_option_names, 1)) != NO_ERROR)
+    return ret;
+  for (i = 0; i < num_option_names; i++)
+  {
+    if ((ret = ReadOption(input_file, options)) != NO_ERROR)
+      return ret;
+  }
+  return NO_ERROR;
+}
+
+int WriteHeader(FILE * const output_file, const parameters_t * const parameters)
+{
+  const size_t num_option_names = GetNumberOfOptions();
+  const char **option_names = (const char**)malloc(num_option_names * sizeof(const char*));
+  const io_uint_t flags = parameters->block_lines != 0 ? HF_BLOCKS : 0;
+  size_t i = 0;
+  int ret;
+  if (option_names == NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes while writing the header\n", SIZE_T_CAST(num_option_names * sizeof(const char*)));
+    return ERROR_MEMORY;
+  }
+  GetOptionNames(option_names);
+  if ((ret = fwrite(magic, 1, MAGIC_SIZE, output_file) == MAGIC_SIZE ? NO_ERROR : ERROR_FILE_IO) == NO_ERROR && (ret = WriteValue(output_file, HEADER_VERSION, 1)) == NO_ERROR && (ret = WriteValue(output_file, flags, 1)) == NO_ERROR && (ret = WriteValue(output_file, parameters->num_options, 1)) == NO_ERROR)
+  {
+    for (i = 0; i < parameters->num_options; i++)
+    {
+      if ((ret = WriteEncoder(output_file, parameters->options[i], option_names, num_option_names)) != NO_ERROR)
+        break;
+    }
+  }
+  free((void*)option_names);
+  if (ret != NO_ERROR)
+  {
+    if (i < parameters->num_options) /* Name the encoder/decoder which cannot be described */
+    {
+      LOG_ERROR(parameters->error_log_file, "%s while writing %s %" SIZE_T_FORMAT " of %" SIZE_T_FORMAT " ('%s') to the header\n", ERROR_MESSAGE_STRING(ret), parameters->options[i]->encode ? "encoder" : "decoder", SIZE_T_CAST(i + 1), SIZE_T_CAST(parameters->num_options), GetFunctionName(parameters->options[i]));
+    }
+    else
+      LOG_ERROR(parameters->error_log_file, "%s while writing the header\n", ERROR_MESSAGE_STRING(ret));
+  }
+  return ret;
+}
+
+int ReadHeader(FILE * const input_file, parameters_t * const parameters)
+{
+  uint8_t file_magic[MAGIC_SIZE];
+  io_uint_t version, flags, num_options;
+  size_t i;
+  int ret;
+  if (fread(file_magic, 1, MAGIC_SIZE, input_file) != MAGIC_SIZE || memcmp(file_magic, magic, MAGIC_SIZE) != 0)
+  {
+    LOG_ERROR(parameters->error_log_file, "The input file has no header. Specify the decoders explicitly\n");
+    return ERROR_INVALID_FORMAT;
+  }
+  if ((ret = ReadValue(input_file, &version, 1)) != NO_ERROR || version != HEADER_VERSION)
+  {
+    LOG_ERROR(parameters->error_log_file, "Unsupported header version\n");
+    return ERROR_INVALID_FORMAT;
+  }
+  if ((ret = ReadValue(input_file, &flags, 1)) != NO_ERROR || (flags & ~(io_uint_t)HF_BLOCKS) != 0)
+  {
+    LOG_ERROR(parameters->error_log_file, "Unsupported header flags\n");
+    return ERROR_INVALID_FORMAT;
+  }
+  if (flags & HF_BLOCKS) /* Decode each block separately */
+  {
+    if (parameters->block_lines != 0 || parameters->pipeline)
+    {
+      LOG_ERROR(parameters->error_log_file, "The input file is a block container, which cannot be decoded with the global options '--blocks' or '--pipeline'\n");
+      return ERROR_INVALID_MODE;
+    }
+    parameters->unblock = 1;
+  }
+  if ((ret = ReadValue(input_file, &num_options, 1)) != NO_ERROR || num_options == 0 || num_options > MAX_OPTIONS)
+  {
+    LOG_ERROR(parameters->error_log_file, "Invalid number of encoders/decoders in header\n");
+    return ERROR_INVALID_FORMAT;
+  }
+  for (parameters->num_options = 0; parameters->num_options < (size_t)num_options; parameters->num_options++)
+  {
+    options_t * const options = (options_t*)malloc(sizeof(options_t));
+    if (options == NULL)
+    {
+      LOG_ERROR(parameters->error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes while reading the header\n", SIZE_T_CAST(sizeof(options_t)));
+      return ERROR_MEMORY;
+    }
+    options->error_log_file = parameters->error_log_file;
+    if ((ret = ReadInverseEncoder(input_file, options)) != NO_ERROR)
+    {
+      free(options);
+      LOG_ERROR(parameters->error_log_file, "%s while reading the header\n", ERROR_MESSAGE_STRING(ret));
+      return ret;
+    }
+    parameters->options[parameters->num_options] = options;
+  }
+  for (i = 0; i < parameters->num_options / 2; i++) /* Decode in reverse order */
+  {
+    options_t * const temp = parameters->options[i];
+    parameters->options[i] = parameters->options[parameters->num_options - 1 - i];
+    parameters->options[parameters->num_options - 1 - i] = temp;
+  }
+  return NO_ERROR;
+}
@@ -12,9 +12,41 @@
 static void PrintUsage(FILE * const error_log_file)
 {
   LOG(error_log_file, "DataCompressor CLI (DCCLI)\n");
-  LOG(error_log_file, "Usage: <input file> <output file> ('encode'|'decode') <encoder/decoder> [<options>] [# ('encode'|'decode') <encoder/decoder> [<options>] ...]\n");
+  LOG(error_log_file, "Usage: [<global options>] <input file> <output file> ('encode'|'decode') <encoder/decoder> [<options>] [# ('encode'|'decode') <encoder/decoder> [<options>] ...]\n");
+  LOG(error_log_file, "Global options: --prefetch: Read ahead from the input file in a separate thread instead of memory-mapping it\n");
+  LOG(error_log_file, "                --write_behind: Write to the output file in a separate thread\n");
+  LOG(error_log_file, "                --memory_budget=<n>: Keep at most n bytes of intermediate data in memory and move the rest to temporary files\n");
+  LOG(error_log_file, "                --header: Describe the encoders/decoders and their options in a header so that 'decode auto' can decode the output\n");
+  LOG(error_log_file, "                --pipeline: Run all encoders/decoders at the same time in separate threads, passing intermediate data on in blocks\n");
+  LOG(error_log_file, "                --no_fusion: Run each encoder/decoder separately even if it is part of a chain which can be processed in one pass (e.g., decode csv # encode normalize # encode diff # encode seg # encode bac)\n");
+  LOG(error_log_file, "                --blocks=<n>: Split the input into blocks of n lines, process them independently and in parallel, and write a block container\n");
+  LOG(error_log_file, "                --unblock: Read a block container written with --blocks and process its blocks independently and in parallel\n");
+  LOG(error_log_file, "                --range=<start>:<count>: With --unblock or 'decode auto' of a block container, only decode the blocks containing count lines starting at line start (the first line is 0) and only output these lines\n");
+  LOG(error_log_file, "                --batch=<manifest>: Process all input and output files listed in the manifest (one '<input file><tab><output file>' per line, '-' for stdin) in parallel instead of a single pair\n");
+  LOG(error_log_file, "                --batch_dir=<input directory> --batch_out=<output directory>: Process all files in the input directory in parallel and write files of the same name to the output directory\n");
+  LOG(error_log_file, "                --evaluate=<pipeline list>: Compress and decompress the input file with all chains of encoders/decoders in the list (one '[<name><tab>]('encode'|'decode') <encoder/decoder> [<options>] [# ...]' per line) in parallel, verify the round trip and print a comparison table\n");
+  LOG(error_log_file, "                --threads=<n>: Process up to n blocks, batch files or evaluated chains at the same time (default: number of processors)\n");
+  LOG(error_log_file, "                --stats=json: Print wall and processor time, sizes, values, buffer high-water marks and allocations of each encoder/decoder in JSON format instead of the diagnostic output\n");
+  LOG(error_log_file, "                --perf_counters: With --stats=json, also measure cycles, instructions, branch misses and L1 data/last level cache misses of each encoder/decoder (Linux only)\n");
+  LOG(error_log_file, "Automatic decoding: <input file> <output file> decode auto (requires an input file written with --header)\n");
+  LOG(error_log_file, "Automatic encoding: <input file> <output file> encode auto [sample=<n>] [policy=(size|speed)]: Compress and decompress the first n bytes (default: %d; 0 means all) of the input file with DEGA, LZMH, A-XDR and variants of them in parallel, encode with the chain with the smallest output or the shortest encoding time among those which reproduce the input and describe it in a header (implies --header)\n", DEFAULT_AUTO_SAMPLE_SIZE);
+  LOG(error_log_file, "Evaluation mode: --evaluate=<pipeline list> [<global options>] <input file> (without output file and encoders/decoders)\n");
+  LOG(error_log_file, "Batch mode: (--batch=<manifest>|--batch_dir=<input directory> --batch_out=<output directory>) [<global options>] ('encode'|'decode') <encoder/decoder> [<options>] [# ...] (without input and output file)\n");
   LOG(error_log_file, "Examples: input.dat output.dat encode copy\n");
   LOG(error_log_file, "          input.dat output.dat encode copy # decode copy\n");
+  LOG(error_log_file, "          --prefetch --write_behind input.dat output.dat encode copy\n");
+  LOG(error_log_file, "          --memory_budget=67108864 input.dat output.dat encode copy # decode copy\n");
+  LOG(error_log_file, "          --header input.dat output.dat encode seg # encode bac adaptive\n");
+  LOG(error_log_file, "          output.dat input.dat decode auto\n");
+  LOG(error_log_file, "          input.txt output.dat encode auto sample=65536 policy=size\n");
+  LOG(error_log_file, "          --pipeline input.dat output.dat encode copy # decode copy\n");
+  LOG(error_log_file, "          --blocks=86400 input.txt output.dat decode csv # encode normalize # encode diff # encode seg # encode bac adaptive\n");
+  LOG(error_log_file, "          --unblock output.dat input.txt decode bac adaptive # decode seg # decode diff # decode normalize # encode csv\n");
+  LOG(error_log_file, "          --unblock --range=3600:3600 output.dat second_hour.txt decode bac adaptive # decode seg # decode diff # decode normalize # encode csv\n");
+  LOG(error_log_file, "          --batch=channels.txt --threads=4 decode csv # encode normalize # encode diff # encode seg # encode bac adaptive\n");
+  LOG(error_log_file, "          --batch_dir=channels --batch_out=compressed decode csv # encode normalize # encode diff # encode seg # encode bac adaptive\n");
+  LOG(error_log_file, "          --evaluate=pipelines.txt --threads=3 input.txt\n");
+  LOG(error_log_file, "          --stats=json --perf_counters --no_fusion input.txt output.dat decode csv # encode normalize # encode diff # encode seg # encode bac adaptive\n");
 }
 
 static int PrintEncoders(FILE * const error_log_file)
@@ -74,6 +106,23 @@ static int ParseOptionValueFloat(const char * const option_name, const char * ar
   return NO_ERROR;
 }
 
+static int ParseOptionValueString(const char * const option_name, const char * argument, const char ** value, FILE * const error_log_file)
+{
+  const char * const argument_start = argument + 1; /* Parse over '=' for value */
+  if (strlen(argument) == 0 || argument[0] != '=')
+  {
+    LOG_ERROR(error_log_file, "Expected '=' after option '%s'\n", option_name);
+    return ERROR_INVALID_FORMAT;
+  }
+  if (strlen(argument_start) == 0)
+  {
+    LOG_ERROR(error_log_file, "Expected value after '=' in option '%s'\n", option_name);
+    return ERROR_INVALID_FORMAT;
+  }
+  *value = argument_start;
+  return NO_ERROR;
+}
+
 static int ParseOptionValueChar(const char * const option_name, const char * argument, char * value, FILE * const error_log_file)
 {
   const char * const argument_start = argument + 1; /* Parse over '=' for value */
@@ -257,35 +306,312 @@ static int ProcessEncoder(const size_t argc, const char * const * const argv, op
   return NO_ERROR;
 }
 
-int ProcessParameters(const int argc, const char * const * const argv, parameters_t * const parameters, FILE ** const in_file, FILE ** const out_file)
+static int ParseRange(const char * const argument, parameters_t * const parameters)
 {
-  size_t current_argc;
-  parameters->num_options = 0;
-  if (argc < 2) /* At least input/output files are required */
+  const char * const argument_start = argument + 1; /* Parse over '=' for value */
+  const char *count_start;
+  char *end_ptr;
+  if (strlen(argument) == 0 || argument[0] != '=')
   {
-    PrintUsage(parameters->error_log_file);
+    LOG_ERROR(parameters->error_log_file, "Expected '=' after option '--range'\n");
     return ERROR_INVALID_FORMAT;
   }
-  current_argc = 2; /* Skip input and output file for now (check when other parameters are o.k.) */
+  parameters->range_start = IO_STRTOUL(argument_start, &end_ptr, 10);
+  if (end_ptr == argument_start || end_ptr[0] != ':')
+  {
+    LOG_ERROR(parameters->error_log_file, "Expected '<start>:<count>' after '=' in option '--range'\n");
+    return ERROR_INVALID_FORMAT;
+  }
+  count_start = end_ptr + 1;
+  parameters->range_count = IO_STRTOUL(count_start, &end_ptr, 10);
+  if (end_ptr == count_start || end_ptr[0] != '\0' || parameters->range_count == 0)
+  {
+    LOG_ERROR(parameters->error_log_file, "Invalid number of lines '%s' in option '--range'. At least one line must be selected\n", count_start);
+    return ERROR_INVALID_VALUE;
+  }
+  parameters->select_range = 1;
+  return NO_ERROR;
+}
+
+static int ProcessGlobalOptions(const int argc, const char * const * const argv, parameters_t * const parameters, size_t * const processed_argc)
+{
+  parameters->prefetch_input = parameters->write_behind_output = parameters->write_header = parameters->pipeline = 0;
+  parameters->fuse_encoders = 1;
+  parameters->block_lines = parameters->num_threads = parameters->memory_budget = 0;
+  parameters->unblock = parameters->select_range = 0;
+  parameters->range_start = parameters->range_count = 0;
+  parameters->batch_manifest_name = parameters->batch_in_dir_name = parameters->batch_out_dir_name = NULL;
+  parameters->evaluation_list_name = NULL;
+  parameters->json_stats = parameters->perf_counters = 0;
+  for (*processed_argc = 0; *processed_argc < (size_t)argc && strncmp("--", argv[*processed_argc], strlen("--")) == 0; (*processed_argc)++) /* Global options precede the input file */
+  {
+    if (strcmp("--prefetch", argv[*processed_argc]) == 0)
+      parameters->prefetch_input = 1;
+    else if (strcmp("--write_behind", argv[*processed_argc]) == 0)
+      parameters->write_behind_output = 1;
+    else if (strcmp("--header", argv[*processed_argc]) == 0)
+      parameters->write_header = 1;
+    else if (strcmp("--pipeline", argv[*processed_argc]) == 0)
+      parameters->pipeline = 1;
+    else if (strcmp("--no_fusion", argv[*processed_argc]) == 0)
+      parameters->fuse_encoders = 0;
+    else if (strcmp("--unblock", argv[*processed_argc]) == 0)
+      parameters->unblock = 1;
+    else if (strcmp("--perf_counters", argv[*processed_argc]) == 0)
+      parameters->perf_counters = 1;
+    else if (strncmp("--range", argv[*processed_argc], strlen("--range")) == 0)
+    {
+      int ret;
+      if ((ret = ParseRange(argv[*processed_argc] + strlen("--range"), parameters)) != NO_ERROR)
+        return ret;
+    }
+    else if (strncmp("--blocks", argv[*processed_argc], strlen("--blocks")) == 0)
+    {
+      io_uint_t block_lines;
+      int ret;
+      if ((ret = ParseOptionValueLong("--blocks", argv[*processed_argc] + strlen("--blocks"), &block_lines, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+      if (block_lines == 0 || block_lines > MAX_USABLE_SIZE)
+      {
+        LOG_ERROR(parameters->error_log_file, "The number of lines per block must be between 1 and %" SIZE_T_FORMAT "\n", SIZE_T_CAST(MAX_USABLE_SIZE));
+        return ERROR_INVALID_VALUE;
+      }
+      parameters->block_lines = (size_t)block_lines;
+    }
+    else if (strncmp("--batch_dir", argv[*processed_argc], strlen("--batch_dir")) == 0) /* Before '--batch' which is a prefix */
+    {
+      int ret;
+      if ((ret = ParseOptionValueString("--batch_dir", argv[*processed_argc] + strlen("--batch_dir"), &parameters->batch_in_dir_name, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+    }
+    else if (strncmp("--batch_out", argv[*processed_argc], strlen("--batch_out")) == 0)
+    {
+      int ret;
+      if ((ret = ParseOptionValueString("--batch_out", argv[*processed_argc] + strlen("--batch_out"), &parameters->batch_out_dir_name, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+    }
+    else if (strncmp("--batch", argv[*processed_argc], strlen("--batch")) == 0)
+    {
+      int ret;
+      if ((ret = ParseOptionValueString("--batch", argv[*processed_argc] + strlen("--batch"), &parameters->batch_manifest_name, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+    }
+    else if (strncmp("--evaluate", argv[*processed_argc], strlen("--evaluate")) == 0)
+    {
+      int ret;
+      if ((ret = ParseOptionValueString("--evaluate", argv[*processed_argc] + strlen("--evaluate"), &parameters->evaluation_list_name, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+    }
+    else if (strncmp("--threads", argv[*processed_argc], strlen("--threads")) == 0)
+    {
+      io_uint_t num_threads;
+      int ret;
+      if ((ret = ParseOptionValueLong("--threads", argv[*processed_argc] + strlen("--threads"), &num_threads, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+      if (num_threads == 0 || num_threads > MAX_THREADS)
+      {
+        LOG_ERROR(parameters->error_log_file, "The number of threads must be between 1 and %d\n", MAX_THREADS);
+        return ERROR_INVALID_VALUE;
+      }
+      parameters->num_threads = (size_t)num_threads;
+    }
+    else if (strncmp("--stats", argv[*processed_argc], strlen("--stats")) == 0)
+    {
+      const char *format;
+      int ret;
+      if ((ret = ParseOptionValueString("--stats", argv[*processed_argc] + strlen("--stats"), &format, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+      if (strcmp("json", format) != 0)
+      {
+        LOG_ERROR(parameters->error_log_file, "Unknown statistics format '%s'. Only 'json' is supported\n", format);
+        return ERROR_INVALID_VALUE;
+      }
+      parameters->json_stats = 1;
+    }
+    else if (strncmp("--memory_budget", argv[*processed_argc], strlen("--memory_budget")) == 0)
+    {
+      io_uint_t memory_budget;
+      int ret;
+      if ((ret = ParseOptionValueLong("--memory_budget", argv[*processed_argc] + strlen("--memory_budget"), &memory_budget, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+      if (memory_budget > MAX_USABLE_SIZE)
+      {
+        LOG_ERROR(parameters->error_log_file, "The memory budget must not exceed %" SIZE_T_FORMAT " bytes\n", SIZE_T_CAST(MAX_USABLE_SIZE));
+        return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+      }
+      parameters->memory_budget = (size_t)memory_budget;
+    }
+    else
+    {
+      LOG_ERROR(parameters->error_log_file, "Unknown global option '%s'\n", argv[*processed_argc]);
+      PrintUsage(parameters->error_log_file);
+      return ERROR_INVALID_VALUE;
+    }
+  }
+  if ((parameters->block_lines != 0 && parameters->unblock) || ((parameters->block_lines != 0 || parameters->unblock) && parameters->pipeline))
+  {
+    LOG_ERROR(parameters->error_log_file, "The global options '--blocks', '--unblock' and '--pipeline' cannot be combined\n");
+    return ERROR_INVALID_VALUE;
+  }
+  if (parameters->batch_manifest_name != NULL && parameters->batch_in_dir_name != NULL)
+  {
+    LOG_ERROR(parameters->error_log_file, "The global options '--batch' and '--batch_dir' cannot be combined\n");
+    return ERROR_INVALID_VALUE;
+  }
+  if ((parameters->batch_in_dir_name == NULL) != (parameters->batch_out_dir_name == NULL))
+  {
+    LOG_ERROR(parameters->error_log_file, "The global options '--batch_dir' and '--batch_out' must be specified together\n");
+    return ERROR_INVALID_VALUE;
+  }
+  if (BATCH_MODE(parameters) && (parameters->block_lines != 0 || parameters->unblock || parameters->pipeline))
+  {
+    LOG_ERROR(parameters->error_log_file, "The global options '--batch' and '--batch_dir' cannot be combined with '--blocks', '--unblock' or '--pipeline'\n");
+    return ERROR_INVALID_VALUE;
+  }
+  if (EVALUATION_MODE(parameters) && (BATCH_MODE(parameters) || parameters->block_lines != 0 || parameters->unblock || parameters->pipeline || parameters->write_header || parameters->prefetch_input || parameters->write_behind_output || parameters->json_stats))
+  {
+    LOG_ERROR(parameters->error_log_file, "The global option '--evaluate' can only be combined with '--threads', '--no_fusion' and '--memory_budget'\n");
+    return ERROR_INVALID_VALUE;
+  }
+  if (parameters->perf_counters && !parameters->json_stats)
+  {
+    LOG_ERROR(parameters->error_log_file, "The global option '--perf_counters' requires '--stats=json'\n");
+    return ERROR_INVALID_VALUE;
+  }
+  return NO_ERROR;
+}
+
+int ParseEncoderChain(const size_t argc, const char * const * const argv, options_t ** const options, size_t * const num_options, FILE * const error_log_file)
+{
+  size_t current_argc = 0;
   do
   {
     int ret;
     size_t processed_argc;
-    if (parameters->num_options >= MAX_OPTIONS)
+    if (*num_options >= MAX_OPTIONS)
     {
-      LOG_ERROR(parameters->error_log_file, "The number of encoders/decoders to be used at once is limited to %d. Reduce the number of encoders/decoders\n", MAX_OPTIONS);
+      LOG_ERROR(error_log_file, "The number of encoders/decoders to be used at once is limited to %d. Reduce the number of encoders/decoders\n", MAX_OPTIONS);
       return ERROR_MEMORY;
     }
-    if ((parameters->options[parameters->num_options] = (options_t * const)malloc(sizeof(options_t))) == NULL)
+    if ((options[*num_options] = (options_t * const)malloc(sizeof(options_t))) == NULL)
     {
-      LOG_ERROR(parameters->error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes while processing parameters\n", SIZE_T_CAST(sizeof(options_t)));
+      LOG_ERROR(error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes while processing parameters\n", SIZE_T_CAST(sizeof(options_t)));
       return ERROR_MEMORY;
     }
-    parameters->options[parameters->num_options++]->error_log_file = parameters->error_log_file;
-    if ((ret = ProcessEncoder(argc - current_argc, &argv[current_argc], parameters->options[parameters->num_options - 1], &processed_argc)) != NO_ERROR)
+    options[(*num_options)++]->error_log_file = error_log_file;
+    if ((ret = ProcessEncoder(argc - current_argc, &argv[current_argc], options[*num_options - 1], &processed_argc)) != NO_ERROR)
       return ret;
     current_argc += processed_argc;
-  } while (current_argc < (size_t)argc);
+  } while (current_argc < argc);
+  return NO_ERROR;
+}
+
+static int ProcessEncoders(const int argc, const char * const * const argv, parameters_t * const parameters)
+{
+  return ParseEncoderChain((size_t)argc, argv, parameters->options, &parameters->num_options, parameters->error_log_file);
+}
+
+static int ProcessAutoEncodeOptions(const int argc, const char * const * const argv, parameters_t * const parameters)
+{
+  int i;
+  for (i = 0; i < argc; i++)
+  {
+    int ret;
+    if (strncmp("sample", argv[i], strlen("sample")) == 0)
+    {
+      io_uint_t sample_size;
+      if ((ret = ParseOptionValueLong("sample", argv[i] + strlen("sample"), &sample_size, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+      if (sample_size > MAX_USABLE_SIZE)
+      {
+        LOG_ERROR(parameters->error_log_file, "The sample size must not exceed %" SIZE_T_FORMAT " bytes\n", SIZE_T_CAST(MAX_USABLE_SIZE));
+        return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+      }
+      parameters->auto_sample_size = (size_t)sample_size;
+    }
+    else if (strncmp("policy", argv[i], strlen("policy")) == 0)
+    {
+      const char *policy;
+      if ((ret = ParseOptionValueString("policy", argv[i] + strlen("policy"), &policy, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+      if (strcmp("size", policy) == 0)
+        parameters->auto_policy = AP_SIZE;
+      else if (strcmp("speed", policy) == 0)
+        parameters->auto_policy = AP_SPEED;
+      else
+      {
+        LOG_ERROR(parameters->error_log_file, "Unknown policy '%s'. Only 'size' and 'speed' are supported\n", policy);
+        return ERROR_INVALID_VALUE;
+      }
+    }
+    else
+    {
+      LOG_ERROR(parameters->error_log_file, "Unknown option '%s' of 'encode auto'. Only 'sample=<n>' and 'policy=(size|speed)' are supported\n", argv[i]);
+      return ERROR_INVALID_VALUE;
+    }
+  }
+  return NO_ERROR;
+}
+
+static int ProcessFilesAndEncoders(const int argc, const char * const * const argv, parameters_t * const parameters, FILE ** const in_file, FILE ** const out_file)
+{
+  int ret;
+  parameters->num_options = 0;
+  parameters->auto_decode = parameters->auto_encode = 0;
+  parameters->auto_sample_size = DEFAULT_AUTO_SAMPLE_SIZE;
+  parameters->auto_policy = AP_SIZE;
+  if (BATCH_MODE(parameters)) /* Files are listed in the manifest or the input directory */
+  {
+    if (argc < 2) /* At least mode and encoder name are required */
+    {
+      PrintUsage(parameters->error_log_file);
+      return ERROR_INVALID_FORMAT;
+    }
+    if (strcmp("auto", argv[1]) == 0)
+    {
+      LOG_ERROR(parameters->error_log_file, "'%s auto' is not supported in batch mode\n", argv[0]);
+      return ERROR_INVALID_MODE;
+    }
+    return ProcessEncoders(argc, argv, parameters);
+  }
+  if (EVALUATION_MODE(parameters)) /* Encoders/decoders are listed in the pipeline list */
+  {
+    if (argc != 1)
+    {
+      PrintUsage(parameters->error_log_file);
+      return ERROR_INVALID_FORMAT;
+    }
+    *out_file = NULL;
+    if (strlen(argv[0]) == 1 && argv[0][0] == '-')
+      *in_file = stdin;
+    else if ((*in_file = FOPEN(argv[0], "rb")) == NULL)
+    {
+      LOG_ERROR(parameters->error_log_file, "Could not open input file '%s'\n", argv[0]);
+      return ERROR_FILE_IO;
+    }
+    return NO_ERROR;
+  }
+  if (argc < 2) /* At least input/output files are required */
+  {
+    PrintUsage(parameters->error_log_file);
+    return ERROR_INVALID_FORMAT;
+  }
+  parameters->auto_decode = argc == 4 && strcmp("decode", argv[2]) == 0 && strcmp("auto", argv[3]) == 0; /* Encoders/decoders are read from the header of the input file later */
+  parameters->auto_encode = argc >= 4 && strcmp("encode", argv[2]) == 0 && strcmp("auto", argv[3]) == 0; /* Encoders are selected by trial compression later */
+  if (parameters->select_range && !parameters->unblock && !parameters->auto_decode) /* 'decode auto' may find a block container */
+  {
+    LOG_ERROR(parameters->error_log_file, "The global option '--range' requires '--unblock'\n");
+    return ERROR_INVALID_VALUE;
+  }
+  if (parameters->auto_encode && parameters->unblock)
+  {
+    LOG_ERROR(parameters->error_log_file, "'encode auto' cannot be combined with the global option '--unblock'\n");
+    return ERROR_INVALID_MODE;
+  }
+  if (parameters->auto_encode && (ret = ProcessAutoEncodeOptions(argc - 4, &argv[4], parameters)) != NO_ERROR)
+    return ret;
+  if (!parameters->auto_decode && !parameters->auto_encode && (ret = ProcessEncoders(argc - 2, &argv[2], parameters)) != NO_ERROR) /* Skip input and output file for now (check when other parameters are o.k.) */
+    return ret;
   if (strlen(argv[0]) == 1 && argv[0][0] == '-')
     *in_file = stdin;
   else if ((*in_file = FOPEN(argv[0], "rb")) == NULL)
@@ -304,3 +630,12 @@ int ProcessParameters(const int argc, const char * const * const argv, parameter
   }
   return NO_ERROR;
 }
+
+int ProcessParameters(const int argc, const char * const * const argv, parameters_t * const parameters, FILE ** const in_file, FILE ** const out_file)
+{
+  int ret;
+  size_t processed_argc;
+  if ((ret = ProcessGlobalOptions(argc, argv, parameters, &processed_argc)) != NO_ERROR)
+    return ret;
+  return ProcessFilesAndEncoders(argc - (int)processed_argc, &argv[processed_argc], parameters, in_file, out_file);
+}
@@ -0,0 +1,268 @@
+/* Machine-readable statistics
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "log.h"
+#include "timer.h"
+#include "stats.h"
+
+static const size_t FLOAT_VALUE_SIZE_BITS = 8 * sizeof(float); /* Values between csv, normalize and aggregate */
+
+static const char * const buffer_names[NUM_STATS_BUFFERS] = { "input", "output", "temporary", "pipes", "total" };
+
+void StartStageStatistics(stage_stats_t * const stage, const size_t first_option, const size_t num_options)
+{
+  size_t i;
+  stage->first_option = first_option;
+  stage->num_options = num_options;
+  stage->wall_seconds = stage->processor_seconds = 0;
+  stage->input_bits = stage->output_bits = 0;
+  for (i = 0; i < NUM_STATS_BUFFERS; i++)
+    stage->max_buffer_sizes[i] = 0;
+  ClearPerfCounterValues(&stage->perf_counter_values);
+  stage->allocations_known = 0;
+  stage->start_processor_time = GetProcessorTime();
+  stage->start_wall_time = GetWallClockTime();
+}
+
+void FinishStageStatistics(stage_stats_t * const stage)
+{
+  stage->wall_seconds = GetWallClockTime() - stage->start_wall_time;
+  stage->processor_seconds = GetProcessorTime() - stage->start_processor_time;
+}
+
+void StartStageAllocationStatistics(run_stats_t * const stats, stage_stats_t * const stage)
+{
+  const uint64_t previous_peak_bytes = ResetPeakAllocatedBytes();
+  if (previous_peak_bytes > stats->peak_allocated_bytes) /* Keep the peak of the run */
+    stats->peak_allocated_bytes = previous_peak_bytes;
+  GetAllocationStatistics(&stage->start_allocations);
+}
+
+void FinishStageAllocationStatistics(stage_stats_t * const stage)
+{
+  allocation_stats_t allocations;
+  GetAllocationStatistics(&allocations);
+  stage->allocations.num_allocations = allocations.num_allocations - stage->start_allocations.num_allocations;
+  stage->allocations.num_reallocations = allocations.num_reallocations - stage->start_allocations.num_reallocations;
+  stage->allocations.num_frees = allocations.num_frees - stage->start_allocations.num_frees;
+  stage->allocations.allocated_bytes = allocations.allocated_bytes - stage->start_allocations.allocated_bytes;
+  stage->allocations.num_buffer_growths = allocations.num_buffer_growths - stage->start_allocations.num_buffer_growths;
+  stage->allocations.current_bytes = allocations.current_bytes;
+  stage->allocations.peak_bytes = allocations.peak_bytes; /* Since the start of the stage */
+  stage->allocations_known = 1;
+}
+
+void StartRunStatistics(run_stats_t * const stats, const char * const mode, const parameters_t * const parameters)
+{
+  stats->mode = mode;
+  stats->options = (const options_t * const *)parameters->options;
+  stats->num_options = parameters->num_options;
+  stats->num_stages = 0;
+  stats->peak_allocated_bytes = 0;
+  stats->perf_counters = parameters->perf_counters;
+  if (stats->perf_counters)
+  {
+    OpenPerfCounters(&stats->stage_counters, 0); /* Unavailable counters are reported as unknown */
+    OpenPerfCounters(&stats->total_counters, 1);
+  }
+  StartStageStatistics(&stats->total, 0, parameters->num_options);
+  StartStageAllocationStatistics(stats, &stats->total);
+  stats->peak_allocated_bytes = 0; /* Ignore the peak before the run */
+  if (stats->perf_counters)
+    StartPerfCounters(&stats->total_counters);
+}
+
+void FinishRunStatistics(run_stats_t * const stats)
+{
+  size_t i;
+  if (stats->perf_counters)
+  {
+    StopPerfCounters(&stats->total_counters, &stats->total.perf_counter_values);
+    ClosePerfCounters(&stats->total_counters);
+    ClosePerfCounters(&stats->stage_counters);
+  }
+  FinishStageAllocationStatistics(&stats->total);
+  if (stats->peak_allocated_bytes > stats->total.allocations.peak_bytes) /* The peak has been reset by a stage */
+    stats->total.allocations.peak_bytes = stats->peak_allocated_bytes;
+  FinishStageStatistics(&stats->total);
+  if (stats->num_stages == 0) /* Only the total is known */
+    return;
+  stats->total.input_bits = stats->stages[0].input_bits;
+  stats->total.output_bits = stats->stages[stats->num_stages - 1].output_bits;
+  for (i = 0; i < stats->num_stages; i++)
+    UpdateHighWaterMarks(stats->total.max_buffer_sizes, stats->stages[i].max_buffer_sizes);
+}
+
+void UpdateHighWaterMarks(size_t * const max_buffer_sizes, const size_t * const buffer_sizes)
+{
+  size_t i;
+  for (i = 0; i < NUM_STATS_BUFFERS; i++)
+  {
+    if (buffer_sizes[i] > max_buffer_sizes[i])
+      max_buffer_sizes[i] = buffer_sizes[i];
+  }
+}
+
+static size_t GetValueSizeBits(const options_t * const options, const int input) /* Size of each value read (input is not 0) or written by the encoder/decoder (0 if the values have no fixed size, e.g., text or variable-length codes) */
+{
+  const enc_dec_t * const enc_dec = options->encoder_decoder;
+  const int float_side = options->encode ? input : !input; /* The side of csv and normalize which has float values */
+  if (enc_dec == GetEncoder("csv"))
+    return float_side ? FLOAT_VALUE_SIZE_BITS : 0;
+  if (enc_dec == GetEncoder("normalize"))
+    return float_side ? FLOAT_VALUE_SIZE_BITS : options->value_size_bits;
+  if (enc_dec == GetEncoder("diff"))
+    return options->value_size_bits;
+  if (enc_dec == GetEncoder("aggregate"))
+    return FLOAT_VALUE_SIZE_BITS;
+  return 0;
+}
+
+static int GetBoundaryValues(const options_t * const * const options, const stage_stats_t * const stages, const size_t num_stages, const size_t boundary, io_uint_t * const num_values) /* Number of values before stage boundary (after the last stage if boundary is num_stages). Returns 0 if neither adjacent stage has values of fixed size there */
+{
+  size_t value_size_bits = 0;
+  io_uint_t bits = 0;
+  if (boundary < num_stages)
+  {
+    value_size_bits = GetValueSizeBits(options[stages[boundary].first_option], 1);
+    bits = stages[boundary].input_bits;
+  }
+  if (value_size_bits == 0 && boundary != 0)
+  {
+    const stage_stats_t * const previous = &stages[boundary - 1];
+    value_size_bits = GetValueSizeBits(options[previous->first_option + previous->num_options - 1], 0);
+    bits = previous->output_bits;
+  }
+  if (value_size_bits == 0)
+    return 0;
+  *num_values = bits / value_size_bits;
+  return 1;
+}
+
+static int GetStageValues(const options_t * const * const options, const stage_stats_t * const stages, const size_t num_stages, const size_t stage, io_uint_t * const num_values) /* Values read by the stage or, if unknown, written by it */
+{
+  return GetBoundaryValues(options, stages, num_stages, stage, num_values) || GetBoundaryValues(options, stages, num_stages, stage + 1, num_values);
+}
+
+static int GetTotalValues(const run_stats_t * const stats, io_uint_t * const num_values) /* Values of the first stage where they are known */
+{
+  size_t i;
+  if (stats->num_stages == 0)
+    return GetStageValues(stats->options, &stats->total, 1, 0, num_values);
+  for (i = 0; i < stats->num_stages; i++)
+  {
+    if (GetStageValues(stats->options, stats->stages, stats->num_stages, i, num_values))
+      return 1;
+  }
+  return 0;
+}
+
+static void WriteStageName(FILE * const output, const run_stats_t * const stats, const stage_stats_t * const stage)
+{
+  size_t i;
+  LOG(output, "\"name\": \"");
+  for (i = stage->first_option; i < stage->first_option + stage->num_options; i++)
+  {
+    const options_t * const options = stats->options[i];
+    const char * const name = GetEncoderNameFromFunction(options->encode ? options->encoder_decoder->encoder : options->encoder_decoder->decoder, options->encode);
+    LOG(output, "%s%s %s", i != stage->first_option ? " # " : "", options->encode ? "encode" : "decode", name != NULL ? name : "unknown");
+  }
+  LOG(output, "\", ");
+}
+
+static void WriteRate(FILE * const output, const char * const name, const int known, const double amount, const double seconds)
+{
+  if (known && seconds > 0)
+  {
+    LOG(output, "\"%s\": %.0f, ", name, amount / seconds);
+  }
+  else
+    LOG(output, "\"%s\": null, ", name);
+}
+
+static void WriteStage(FILE * const output, const run_stats_t * const stats, const stage_stats_t * const stage, const int values_known, const io_uint_t num_values, const int is_total)
+{
+  size_t i;
+  LOG(output, "{ ");
+  if (!is_total)
+  {
+    LOG(output, "\"first\": %" SIZE_T_FORMAT ", \"last\": %" SIZE_T_FORMAT ", ", SIZE_T_CAST(stage->first_option + 1), SIZE_T_CAST(stage->first_option + stage->num_options));
+    WriteStageName(output, stats, stage);
+  }
+  LOG(output, "\"wall_seconds\": %.6f, ", stage->wall_seconds);
+  if (stage->processor_seconds >= 0)
+  {
+    LOG(output, "\"cpu_seconds\": %.6f, ", stage->processor_seconds);
+  }
+  else
+    LOG(output, "\"cpu_seconds\": null, ");
+  LOG(output, "\"input_bits\": %" IO_UINT_FORMAT ", \"output_bits\": %" IO_UINT_FORMAT ", ", stage->input_bits, stage->output_bits);
+  if (values_known)
+  {
+    LOG(output, "\"values\": %" IO_UINT_FORMAT ", ", num_values);
+    if (num_values != 0)
+    {
+      LOG(output, "\"bits_per_value\": %.4f, ", (double)stage->output_bits / num_values);
+    }
+    else
+      LOG(output, "\"bits_per_value\": null, ");
+  }
+  else
+    LOG(output, "\"values\": null, \"bits_per_value\": null, ");
+  WriteRate(output, "input_bytes_per_second", 1, stage->input_bits / 8.0, stage->wall_seconds);
+  WriteRate(output, "values_per_second", values_known, (double)num_values, stage->wall_seconds);
+  LOG(output, "\"buffer_high_water_bytes\": { ");
+  for (i = 0; i < NUM_STATS_BUFFERS; i++)
+    LOG(output, "\"%s\": %" SIZE_T_FORMAT "%s", buffer_names[i], SIZE_T_CAST(stage->max_buffer_sizes[i]), i != NUM_STATS_BUFFERS - 1 ? ", " : " }");
+  if (stage->allocations_known)
+  {
+    const allocation_stats_t * const allocations = &stage->allocations;
+    LOG(output, ", \"allocations\": { \"calls\": %" PRIu64 ", \"reallocations\": %" PRIu64 ", \"frees\": %" PRIu64 ", \"allocated_bytes\": %" PRIu64 ", \"peak_bytes\": %" PRIu64 ", \"buffer_growths\": %" PRIu64 " }", allocations->num_allocations, allocations->num_reallocations, allocations->num_frees, allocations->allocated_bytes, allocations->peak_bytes, allocations->num_buffer_growths);
+  }
+  else
+    LOG(output, ", \"allocations\": null");
+  if (is_total)
+  {
+    const uint64_t peak_resident_bytes = GetPeakResidentMemory();
+    if (peak_resident_bytes != 0)
+    {
+      LOG(output, ", \"peak_resident_bytes\": %" PRIu64, peak_resident_bytes);
+    }
+    else
+      LOG(output, ", \"peak_resident_bytes\": null");
+  }
+  if (stats->perf_counters)
+  {
+    LOG(output, ", \"perf_counters\": { ");
+    for (i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+      const char * const separator = i != NUM_PERF_COUNTERS - 1 ? ", " : " }";
+      if (stage->perf_counter_values.available[i])
+      {
+        LOG(output, "\"%s\": %" PRIu64 "%s", GetPerfCounterName((perf_counter_t)i), stage->perf_counter_values.values[i], separator);
+      }
+      else
+        LOG(output, "\"%s\": null%s", GetPerfCounterName((perf_counter_t)i), separator);
+    }
+  }
+  LOG(output, " }");
+}
+
+void WriteStatisticsJSON(FILE * const output, const run_stats_t * const stats)
+{
+  io_uint_t num_values = 0;
+  int values_known;
+  size_t i;
+  LOG(output, "{\n  \"mode\": \"%s\",\n  \"stages\": [", stats->mode);
+  for (i = 0; i < stats->num_stages; i++)
+  {
+    values_known = GetStageValues(stats->options, stats->stages, stats->num_stages, i, &num_values);
+    LOG(output, "%s\n    ", i != 0 ? "," : "");
+    WriteStage(output, stats, &stats->stages[i], values_known, num_values, 0);
+  }
+  LOG(output, "%s],\n  \"total\": ", stats->num_stages != 0 ? "\n  " : "");
+  values_known = GetTotalValues(stats, &num_values);
+  WriteStage(output, stats, &stats->total, values_known, num_values, 1);
+  LOG(output, "\n}\n");
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+/* Bit I/O microbenchmark (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _IOBENCH_H
+#define _IOBENCH_H
+
+#include "bit_file_buffer.h"
+
+#include <stdio.h>
+
+#define NUM_SOURCE_VALUES 1024 /* Power of two; small enough to stay in the cache */
+
+typedef enum io_operation_t
+{
+  IOO_READ_BITS = 0, /* ReadBitFileBuffer */
+  IOO_WRITE_BITS, /* WriteBitFileBuffer */
+  IOO_READ_SINGLE_VALUE, /* ReadSingleValueFromBitFileBuffer */
+  IOO_WRITE_SINGLE_VALUE, /* WriteSingleValueToBitFileBuffer */
+  NUM_IO_OPERATIONS
+} io_operation_t;
+
+typedef enum io_buffer_type_t
+{
+  IOBT_FILE = 0, /* File buffer on a (temporary) file */
+  IOBT_MEMORY, /* In-memory file buffer */
+  NUM_IO_BUFFER_TYPES
+} io_buffer_type_t;
+
+typedef struct io_bench_parameters_t
+{
+  FILE *error_log_file;
+  FILE *output_file;
+  size_t num_ops; /* Per measurement */
+  size_t repetitions;
+  size_t first_width;
+  size_t last_width;
+} io_bench_parameters_t;
+
+typedef struct io_bench_case_t
+{
+  io_operation_t operation;
+  io_buffer_type_t buffer_type;
+  int unaligned;
+  size_t width; /* Bits per operation */
+} io_bench_case_t;
+
+typedef struct io_bench_env_t
+{
+  FILE *temp_file;
+  file_buffer_t *file_buffer;
+  bit_file_buffer_t *bit_file_buffer;
+  uint8_t source_bytes[NUM_SOURCE_VALUES * 8]; /* 64 bits per operation */
+  io_uint_t source_values[NUM_SOURCE_VALUES]; /* Masked to the current width */
+  uint8_t sink_bytes[8];
+  io_uint_t sink_value;
+} io_bench_env_t;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,324 @@
+/* Microbenchmark for the bit-level I/O operations of DCIOLib
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "err_codes.h"
+#include "io.h"
+#include "log.h"
+#include "timer.h"
+#include "iobench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_WIDTH 64
+
+static const size_t IO_BUFFER_SIZE = 1024; /* 1 KiB (like the file buffers of DCCLI) */
+static const size_t DEFAULT_NUM_OPS = 256 * 1024;
+static const size_t DEFAULT_REPETITIONS = 5;
+static const size_t UNALIGNED_OFFSET_BITS = 3; /* Bits read/written before the measured operations in the unaligned case */
+
+static const char * const operation_names[NUM_IO_OPERATIONS] = { "ReadBitFileBuffer", "WriteBitFileBuffer", "ReadSingleValueFromBitFileBuffer", "WriteSingleValueToBitFileBuffer" };
+static const char * const buffer_type_names[NUM_IO_BUFFER_TYPES] = { "FBT_FILE", "FBT_MEMORY" };
+
+static void PrintUsage(FILE * const error_log_file)
+{
+  LOG(error_log_file, "DataCompressor bit I/O benchmark (DCIOBench)\n");
+  LOG(error_log_file, "Usage: [<options>]\n");
+  LOG(error_log_file, "Measures reading and writing bits with DCIOLib for all widths, aligned and unaligned, on files and in memory, and prints comma-separated values\n");
+  LOG(error_log_file, "Options: --ops=<n>: Perform n operations per measurement (default: %" SIZE_T_FORMAT ")\n", SIZE_T_CAST(DEFAULT_NUM_OPS));
+  LOG(error_log_file, "         --repetitions=<n>: Measure n times and keep the fastest (default: %" SIZE_T_FORMAT ")\n", SIZE_T_CAST(DEFAULT_REPETITIONS));
+  LOG(error_log_file, "         --widths=<first>:<last>: Only measure widths from first to last bits (default: 1:%d)\n", MAX_WIDTH);
+  LOG(error_log_file, "Examples: --ops=1048576\n");
+  LOG(error_log_file, "          --widths=8:8 --repetitions=20\n");
+}
+
+static int ParseSize(const char * const option_name, const char * const value, const char terminator, size_t * const size, FILE * const error_log_file)
+{
+  char *end_ptr;
+  *size = (size_t)IO_STRTOUL(value, &end_ptr, 10);
+  if (value[0] == '\0' || end_ptr == NULL || end_ptr[0] != terminator || *size == 0)
+  {
+    LOG_ERROR(error_log_file, "Invalid value '%s' for option '%s'\n", value, option_name);
+    return ERROR_INVALID_VALUE;
+  }
+  return NO_ERROR;
+}
+
+static int ParseParameters(const size_t argc, const char * const * const argv, io_bench_parameters_t * const parameters)
+{
+  size_t i;
+  int ret;
+  parameters->num_ops = DEFAULT_NUM_OPS;
+  parameters->repetitions = DEFAULT_REPETITIONS;
+  parameters->first_width = 1;
+  parameters->last_width = MAX_WIDTH;
+  for (i = 0; i < argc; i++)
+  {
+    if (strncmp(argv[i], "--ops=", strlen("--ops=")) == 0)
+    {
+      if ((ret = ParseSize("--ops", argv[i] + strlen("--ops="), '\0', &parameters->num_ops, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+    }
+    else if (strncmp(argv[i], "--repetitions=", strlen("--repetitions=")) == 0)
+    {
+      if ((ret = ParseSize("--repetitions", argv[i] + strlen("--repetitions="), '\0', &parameters->repetitions, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+    }
+    else if (strncmp(argv[i], "--widths=", strlen("--widths=")) == 0)
+    {
+      const char * const value = argv[i] + strlen("--widths=");
+      const char * const separator = strchr(value, ':');
+      if (separator == NULL)
+      {
+        LOG_ERROR(parameters->error_log_file, "Expected ':' in option '--widths'\n");
+        return ERROR_INVALID_FORMAT;
+      }
+      if ((ret = ParseSize("--widths", value, ':', &parameters->first_width, parameters->error_log_file)) != NO_ERROR
+        || (ret = ParseSize("--widths", separator + 1, '\0', &parameters->last_width, parameters->error_log_file)) != NO_ERROR)
+        return ret;
+      if (parameters->first_width > parameters->last_width || parameters->last_width > MAX_WIDTH)
+      {
+        LOG_ERROR(parameters->error_log_file, "The widths have to be between 1 and %d, the first not larger than the last\n", MAX_WIDTH);
+        return ERROR_INVALID_VALUE;
+      }
+    }
+    else
+    {
+      LOG_ERROR(parameters->error_log_file, "Unknown option '%s'\n", argv[i]);
+      PrintUsage(parameters->error_log_file);
+      return ERROR_INVALID_FORMAT;
+    }
+  }
+  return NO_ERROR;
+}
+
+static void FreeBenchEnvironment(io_bench_env_t * const env)
+{
+  if (env->temp_file != NULL)
+    fclose(env->temp_file);
+  FreeBitFileBuffer(env->bit_file_buffer);
+  FreeFileBuffer(env->file_buffer);
+  free(env);
+}
+
+static io_bench_env_t *AllocateBenchEnvironment(FILE * const error_log_file)
+{
+  io_bench_env_t *env;
+  uint32_t random = 2463534242U; /* xorshift32 with a fixed seed so that all runs use the same data */
+  size_t i;
+  if ((env = (io_bench_env_t*)malloc(sizeof(io_bench_env_t))) == NULL)
+  {
+    LOG_ERROR(error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes for the benchmark environment\n", SIZE_T_CAST(sizeof(io_bench_env_t)));
+    return NULL;
+  }
+  env->temp_file = tmpfile();
+  env->file_buffer = AllocateFileBuffer();
+  env->bit_file_buffer = AllocateBitFileBuffer();
+  if (env->temp_file == NULL || env->file_buffer == NULL || env->bit_file_buffer == NULL)
+  {
+    LOG_ERROR(error_log_file, "Could not create temporary file or buffers\n");
+    FreeBenchEnvironment(env);
+    return NULL;
+  }
+  for (i = 0; i < sizeof(env->source_bytes); i++)
+  {
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    env->source_bytes[i] = (uint8_t)random;
+  }
+  return env;
+}
+
+static void SetSourceValueWidth(io_bench_env_t * const env, const size_t width) /* Masks the source values so that they fit into width bits */
+{
+  const io_uint_t mask = width >= IO_SIZE_BITS ? MAX_IO_UINT_VALUE : (((io_uint_t)1 << width) - 1);
+  size_t i;
+  for (i = 0; i < NUM_SOURCE_VALUES; i++)
+  {
+    io_uint_t value;
+    memcpy(&value, &env->source_bytes[i * 8], sizeof(value));
+    env->source_values[i] = value & mask;
+  }
+}
+
+static int OpenBuffer(io_bench_env_t * const env, const io_buffer_type_t buffer_type, const file_buffer_mode_t mode)
+{
+  int ret;
+  if (buffer_type == IOBT_FILE)
+  {
+    rewind(env->temp_file);
+    ret = InitFileBuffer(env->file_buffer, env->temp_file, mode, IO_BUFFER_SIZE);
+  }
+  else
+    ret = InitFileBufferInMemory(env->file_buffer, mode, IO_BUFFER_SIZE);
+  if (ret != NO_ERROR)
+    return ret;
+  InitBitFileBuffer(env->bit_file_buffer, env->file_buffer);
+  return NO_ERROR;
+}
+
+static void CloseBuffer(io_bench_env_t * const env)
+{
+  UninitBitFileBuffer(env->bit_file_buffer);
+  UninitFileBuffer(env->file_buffer);
+}
+
+static int FillCase(const io_bench_parameters_t * const parameters, io_bench_env_t * const env, const io_bench_case_t * const bench_case, const size_t offset_bits) /* Writes the offset and, when reading, the data to be read */
+{
+  const int read = bench_case->operation == IOO_READ_BITS || bench_case->operation == IOO_READ_SINGLE_VALUE;
+  io_int_t ret;
+  size_t i;
+  if (offset_bits != 0 && (ret = WriteBitFileBuffer(env->bit_file_buffer, env->source_bytes, offset_bits)) != (io_int_t)offset_bits)
+    return ret < 0 ? (int)ret : ERROR_FILE_IO;
+  for (i = 0; read && i < parameters->num_ops; i++)
+    if ((ret = WriteBitFileBuffer(env->bit_file_buffer, &env->source_bytes[(i & (NUM_SOURCE_VALUES - 1)) * 8], bench_case->width)) != (io_int_t)bench_case->width)
+      return ret < 0 ? (int)ret : ERROR_FILE_IO;
+  return NO_ERROR;
+}
+
+static int PrepareCase(const io_bench_parameters_t * const parameters, io_bench_env_t * const env, const io_bench_case_t * const bench_case) /* Opens the buffer and positions it in front of the first measured operation. The buffer is closed on error */
+{
+  const int read = bench_case->operation == IOO_READ_BITS || bench_case->operation == IOO_READ_SINGLE_VALUE;
+  const size_t offset_bits = bench_case->unaligned ? UNALIGNED_OFFSET_BITS : 0;
+  io_int_t ret;
+  if ((ret = OpenBuffer(env, bench_case->buffer_type, FBM_WRITING)) != NO_ERROR)
+    return (int)ret;
+  if ((ret = FillCase(parameters, env, bench_case, offset_bits)) != NO_ERROR || !read)
+  {
+    if (ret != NO_ERROR)
+      CloseBuffer(env);
+    return (int)ret;
+  }
+  if (bench_case->buffer_type == IOBT_FILE) /* Read back from the start of the file */
+  {
+    CloseBuffer(env);
+    if ((ret = OpenBuffer(env, bench_case->buffer_type, FBM_READING)) != NO_ERROR)
+      return (int)ret;
+  }
+  else if ((ret = SetBitFileBufferMode(env->bit_file_buffer, FBM_READING)) != NO_ERROR)
+  {
+    CloseBuffer(env);
+    return (int)ret;
+  }
+  if (offset_bits != 0 && (ret = ReadBitFileBuffer(env->bit_file_buffer, env->sink_bytes, offset_bits)) != (io_int_t)offset_bits)
+  {
+    CloseBuffer(env);
+    return ret < 0 ? (int)ret : ERROR_FILE_IO;
+  }
+  return NO_ERROR;
+}
+
+static int RunCase(const io_bench_parameters_t * const parameters, io_bench_env_t * const env, const io_bench_case_t * const bench_case) /* The measured operations */
+{
+  bit_file_buffer_t * const bit_file_buffer = env->bit_file_buffer;
+  const size_t width = bench_case->width;
+  const size_t num_ops = parameters->num_ops;
+  io_int_t ret = (io_int_t)width;
+  size_t i;
+  switch (bench_case->operation)
+  {
+    case IOO_READ_BITS:
+      for (i = 0; i < num_ops && ret == (io_int_t)width; i++)
+        ret = ReadBitFileBuffer(bit_file_buffer, env->sink_bytes, width);
+      break;
+    case IOO_WRITE_BITS:
+      for (i = 0; i < num_ops && ret == (io_int_t)width; i++)
+        ret = WriteBitFileBuffer(bit_file_buffer, &env->source_bytes[(i & (NUM_SOURCE_VALUES - 1)) * 8], width);
+      break;
+    case IOO_READ_SINGLE_VALUE:
+      for (i = 0; i < num_ops && ret == (io_int_t)width; i++)
+        ret = ReadSingleValueFromBitFileBuffer(bit_file_buffer, &env->sink_value, width);
+      break;
+    case IOO_WRITE_SINGLE_VALUE:
+      for (i = 0; i < num_ops && ret == (io_int_t)width; i++)
+        ret = WriteSingleValueToBitFileBuffer(bit_file_buffer, &env->source_values[i & (NUM_SOURCE_VALUES - 1)], width);
+      break;
+    case NUM_IO_OPERATIONS:
+    default:
+      return ERROR_INVALID_MODE;
+  }
+  if (ret != (io_int_t)width)
+    return ret < 0 ? (int)ret : ERROR_FILE_IO;
+  if ((bench_case->operation == IOO_WRITE_BITS || bench_case->operation == IOO_WRITE_SINGLE_VALUE) && bench_case->buffer_type == IOBT_FILE) /* Include writing the buffered data to the file (in-memory buffers cannot be flushed) */
+    return FlushBitFileBuffer(bit_file_buffer);
+  return NO_ERROR;
+}
+
+static int MeasureCase(const io_bench_parameters_t * const parameters, io_bench_env_t * const env, const io_bench_case_t * const bench_case, double * const min_seconds)
+{
+  size_t i;
+  int ret;
+  *min_seconds = 0;
+  for (i = 0; i <= parameters->repetitions; i++) /* The first run is a warm-up run */
+  {
+    double start, seconds;
+    if ((ret = PrepareCase(parameters, env, bench_case)) != NO_ERROR)
+      return ret;
+    start = GetWallClockTime();
+    ret = RunCase(parameters, env, bench_case);
+    seconds = GetWallClockTime() - start;
+    CloseBuffer(env);
+    if (ret != NO_ERROR)
+      return ret;
+    if (i == 1 || (i > 1 && seconds < *min_seconds))
+      *min_seconds = seconds;
+  }
+  return NO_ERROR;
+}
+
+static void PrintResult(const io_bench_parameters_t * const parameters, const io_bench_case_t * const bench_case, const double min_seconds)
+{
+  const double seconds = min_seconds > 1e-9 ? min_seconds : 1e-9; /* Avoid division by zero with coarse timers */
+  LOG(parameters->output_file, "%s,%s,%s,%" SIZE_T_FORMAT ",%" SIZE_T_FORMAT ",%.3f,%.0f\n", operation_names[bench_case->operation], buffer_type_names[bench_case->buffer_type], bench_case->unaligned ? "unaligned" : "aligned",
+    SIZE_T_CAST(bench_case->width), SIZE_T_CAST(parameters->num_ops), seconds * 1e9 / parameters->num_ops, parameters->num_ops * (double)bench_case->width / seconds);
+  fflush(parameters->output_file); /* Show progress */
+}
+
+static int RunBenchmarks(const io_bench_parameters_t * const parameters, io_bench_env_t * const env)
+{
+  io_bench_case_t bench_case;
+  int ret, failed = 0;
+  LOG(parameters->output_file, "operation,buffer_type,alignment,width_bits,ops,ns_per_op,bits_per_s\n");
+  for (bench_case.width = parameters->first_width; bench_case.width <= parameters->last_width; bench_case.width++)
+  {
+    SetSourceValueWidth(env, bench_case.width);
+    for (bench_case.operation = IOO_READ_BITS; bench_case.operation < NUM_IO_OPERATIONS; bench_case.operation++)
+    {
+      if ((bench_case.operation == IOO_READ_SINGLE_VALUE || bench_case.operation == IOO_WRITE_SINGLE_VALUE) && bench_case.width > IO_SIZE_BITS) /* Values cannot be wider than io_uint_t */
+        continue;
+      for (bench_case.buffer_type = IOBT_FILE; bench_case.buffer_type < NUM_IO_BUFFER_TYPES; bench_case.buffer_type++)
+      {
+        for (bench_case.unaligned = 0; bench_case.unaligned <= 1; bench_case.unaligned++)
+        {
+          double min_seconds;
+          if ((ret = MeasureCase(parameters, env, &bench_case, &min_seconds)) != NO_ERROR)
+          {
+            LOG_ERROR(parameters->error_log_file, "%s while measuring %s (%s, %s, %" SIZE_T_FORMAT " bits)\n", ERROR_MESSAGE_STRING(ret), operation_names[bench_case.operation], buffer_type_names[bench_case.buffer_type], bench_case.unaligned ? "unaligned" : "aligned", SIZE_T_CAST(bench_case.width));
+            failed = 1;
+          }
+          else
+            PrintResult(parameters, &bench_case, min_seconds);
+        }
+      }
+    }
+  }
+  return failed ? ERROR_FILE_IO : NO_ERROR;
+}
+
+int main(const int argc, const char * const * const argv)
+{
+  io_bench_parameters_t parameters;
+  io_bench_env_t *env;
+  int ret;
+  parameters.error_log_file = stderr;
+  parameters.output_file = stdout;
+  if ((ret = ParseParameters(argc - 1, &argv[1], &parameters)) != NO_ERROR)
+    return ret;
+  if ((env = AllocateBenchEnvironment(parameters.error_log_file)) == NULL)
+    return ERROR_MEMORY;
+  ret = RunBenchmarks(&parameters, env);
+  FreeBenchEnvironment(env);
+  return ret;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+/* Allocation tracking (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _ALLOCATION_H
+#define _ALLOCATION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct allocation_stats_t /* Of all threads together */
+{
+  uint64_t num_allocations, num_reallocations, num_frees;
+  uint64_t allocated_bytes; /* Sum of all sizes requested by AllocateMemory and ReallocateMemory */
+  uint64_t current_bytes, peak_bytes; /* Allocated and not yet freed */
+  uint64_t num_buffer_growths; /* Resizes of full in-memory file buffers */
+} allocation_stats_t;
+
+void *AllocateMemory(const size_t size); /* Use instead of malloc so that the allocation is tracked. Must be freed with FreeMemory */
+void *ReallocateMemory(void * const memory, const size_t size); /* Use instead of realloc. memory must be NULL or have been allocated by AllocateMemory or ReallocateMemory */
+void FreeMemory(void * const memory); /* Use instead of free. memory may be NULL */
+
+void CountBufferGrowth(void);
+void GetAllocationStatistics(allocation_stats_t * const stats);
+uint64_t ResetPeakAllocatedBytes(void); /* Sets the peak to the current number of allocated bytes, e.g., to determine the peak of a processing step. Returns the previous peak */
+uint64_t ResetThreadPeakAllocatedBytes(void); /* Like ResetPeakAllocatedBytes, but only for the bytes allocated minus the bytes freed by the calling thread, e.g., to determine the peak of a processing step while other threads run other steps */
+uint64_t GetThreadPeakAllocatedBytes(void); /* Peak of the calling thread since the last call of ResetThreadPeakAllocatedBytes (or since the start of the thread) */
+
+uint64_t GetPeakResidentMemory(void); /* Peak resident set size of the process in bytes (including memory not allocated by AllocateMemory, e.g., memory-mapped files), 0 if unknown */
+
+#endif
\ No newline at end of file
@@ -9,6 +9,18 @@
 
 typedef struct bit_file_buffer_t bit_file_buffer_t;
 
+typedef struct bit_file_buffer_window_t /* Leading part of bit_file_buffer_t which is exposed for END_OF_BIT_FILE_BUFFER only. Do not access directly */
+{
+  file_buffer_mode_t mode; /* Mode of the underlying file buffer (cached) */
+  uint8_t used_bits; /* Reading: number of unread bits in the accumulator; Writing: number of bits in the accumulator not yet written to the file buffer */
+} bit_file_buffer_window_t;
+
+/* Same as EndOfBitFileBuffer, but inline without a function call as long as there are unread bits in the accumulator. Evaluates bit_file_buffer more than once */
+#define END_OF_BIT_FILE_BUFFER(bit_file_buffer) ((((const bit_file_buffer_window_t*)(bit_file_buffer))->mode == FBM_READING && ((const bit_file_buffer_window_t*)(bit_file_buffer))->used_bits != 0) ? 0 : EndOfBitFileBuffer(bit_file_buffer))
+
+/* Maximum number of bits which can be peeked at once */
+#define MAX_PEEK_BIT_SIZE 57
+
 bit_file_buffer_t *AllocateBitFileBuffer(void);
 void FreeBitFileBuffer(bit_file_buffer_t * const bit_file_buffer);
 
@@ -24,10 +36,22 @@ int SetBitFileBufferMode(bit_file_buffer_t * const bit_file_buffer, const file_b
 io_int_t ReadBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, uint8_t * const output, const size_t output_bit_size);
 io_int_t WriteBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, const uint8_t * const input, const size_t input_bit_size);
 
+io_int_t PeekBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, io_uint_t * const value, const size_t value_bit_size); /* Reads value_bit_size bits (at most MAX_PEEK_BIT_SIZE) into the LSBs of value without consuming them. Returns the number of available bits; missing bits at EOF are zero */
+io_int_t SkipBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, const size_t num_bits); /* Consumes num_bits bits. Returns fewer bits than requested at EOF */
+
+io_int_t AcquireBitFileBufferReadSpan(bit_file_buffer_t * const bit_file_buffer, const uint8_t ** const span, const size_t max_size); /* See AcquireFileBufferReadSpan. Requires the read position to be at a byte boundary */
+int ReleaseBitFileBufferReadSpan(bit_file_buffer_t * const bit_file_buffer, const size_t size);
+io_int_t ReserveBitFileBufferWriteSpan(bit_file_buffer_t * const bit_file_buffer, uint8_t ** const span, const size_t min_size); /* See ReserveFileBufferWriteSpan. Requires the write position to be at a byte boundary */
+int CommitBitFileBufferWriteSpan(bit_file_buffer_t * const bit_file_buffer, const size_t size);
+
 io_int_t ReadSingleValueFromBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, io_uint_t * const value, const size_t value_bit_size);
 io_int_t WriteSingleValueToBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, const io_uint_t * const value, const size_t value_bit_size);
 
+io_int_t ReadValuesFromBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, io_uint_t * const values, const size_t num_values, const size_t value_bit_size);
+io_int_t WriteValuesToBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, const io_uint_t * const values, const size_t num_values, const size_t value_bit_size);
+
 int FlushBitFileBuffer(bit_file_buffer_t * const bit_file_buffer);
+int CloseBitFileBufferPipe(bit_file_buffer_t * const bit_file_buffer); /* See CloseFileBufferPipe. When writing, left-over bits are passed on to the reading bit file buffer instead of being padded */
 
 int ClearBitFileBuffer(bit_file_buffer_t * const bit_file_buffer);
 int ResetBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, const file_buffer_mode_t mode);
@@ -8,17 +8,26 @@
 #include "io.h"
 
 typedef struct buffer_t buffer_t;
+typedef struct chunk_pool_t chunk_pool_t;
 
 typedef io_int_t refill_function_t(void * const buffer_addr, const size_t max_bytes, void * const caller_info);
 typedef io_int_t flush_function_t(const void * const buffer_addr, const size_t num_bytes, void * const caller_info);
 
+chunk_pool_t *AllocateChunkPool(void);
+void FreeChunkPool(chunk_pool_t * const chunk_pool);
+
+int InitChunkPool(chunk_pool_t * const chunk_pool, const size_t chunk_size); /* Not thread-safe, i.e., all buffers using the pool must be used by the same thread */
+void UninitChunkPool(chunk_pool_t * const chunk_pool); /* All buffers using the pool have to be uninitialized before */
+
 buffer_t *AllocateBuffer(void);
 void FreeBuffer(buffer_t * const buffer);
 
 int InitBuffer(buffer_t * const buffer, const size_t buffer_size);
+int InitRingBuffer(buffer_t * const buffer, const size_t buffer_size); /* Used bytes may wrap around the end of the buffer, i.e., refilling and writing never move data */
+int InitChunkedBuffer(buffer_t * const buffer, chunk_pool_t * const chunk_pool); /* Used bytes are stored in a list of chunks from chunk_pool which are added when writing and returned to the pool when reading, i.e., the buffer grows without moving data and ResizeBuffer has no effect */
 void UninitBuffer(buffer_t * const buffer);
 
-size_t GetBufferSize(const buffer_t * const buffer);
+size_t GetBufferSize(const buffer_t * const buffer); /* Total size of all chunks in chunked mode */
 io_int_t GetUsedBufferSize(const buffer_t * const buffer);
 
 int ResizeBuffer(buffer_t * const buffer, const size_t new_buffer_size);
@@ -28,7 +37,11 @@ int FlushBuffer(buffer_t * const buffer, flush_function_t * const flush_func, vo
 
 io_int_t PeekBuffer(const buffer_t * const buffer, uint8_t * const output, const size_t output_size);
 io_int_t ReadBuffer(buffer_t * const buffer, uint8_t * const output, const size_t output_size);
+io_int_t PeekBufferSegments(const buffer_t * const buffer, const size_t max_size, const uint8_t ** const first, size_t * const first_size, const uint8_t ** const second, size_t * const second_size); /* Up to max_size used bytes as two contiguous segments (second_size is only non-zero if the bytes wrap around in ring buffer mode) */
+io_int_t ReadBufferSegments(buffer_t * const buffer, const size_t max_size, const uint8_t ** const first, size_t * const first_size, const uint8_t ** const second, size_t * const second_size); /* Like PeekBufferSegments, but consumes the bytes. Segments remain valid until the next write or refill operation */
 io_int_t WriteBuffer(buffer_t * const buffer, const uint8_t * const input, const size_t input_size);
+io_int_t ReserveBuffer(buffer_t * const buffer, uint8_t ** const span, const size_t min_size); /* Contiguous free bytes after the used bytes which can be written directly. Only chunked buffers guarantee at least min_size bytes (by starting a new chunk) */
+int CommitBuffer(buffer_t * const buffer, const size_t size); /* Marks size bytes of the reserved span as used */
 
 void ClearBuffer(buffer_t * const buffer);
 
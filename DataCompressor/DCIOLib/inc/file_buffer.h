@@ -15,14 +15,32 @@ typedef enum file_buffer_mode_t
 } file_buffer_mode_t;
 
 typedef struct file_buffer_t file_buffer_t;
+typedef struct file_buffer_pipe_t file_buffer_pipe_t;
 
 file_buffer_t *AllocateFileBuffer(void);
 void FreeFileBuffer(file_buffer_t * const file_buffer);
 
 int InitFileBuffer(file_buffer_t * const file_buffer, FILE * const input_file, const file_buffer_mode_t mode, const size_t buffer_size);
+int InitFileBufferMapped(file_buffer_t * const file_buffer, FILE * const input_file, const size_t buffer_size); /* Reading only. Falls back to InitFileBuffer with buffer_size if the file cannot be memory-mapped */
+int InitFileBufferPrefetched(file_buffer_t * const file_buffer, FILE * const input_file, const size_t buffer_size, const size_t block_size); /* Reading only. A worker thread reads ahead up to two blocks of block_size bytes while the current one is being consumed. Falls back to synchronous reading if the thread cannot be started */
+int InitFileBufferWriteBehind(file_buffer_t * const file_buffer, FILE * const output_file, const size_t buffer_size, const size_t block_size); /* Writing only. Flushed data is collected in blocks of block_size bytes which are written by a worker thread while the caller continues. Falls back to synchronous writing if the thread cannot be started */
+int InitFileBufferPiped(file_buffer_t * const file_buffer, file_buffer_pipe_t * const pipe, const file_buffer_mode_t mode, const size_t buffer_size); /* One writing and one reading file buffer per pipe, used by different threads. Writing blocks while the pipe is full, reading blocks while it is empty until the writing file buffer has been closed (EOF) */
+int InitFileBufferFromMemory(file_buffer_t * const file_buffer, const uint8_t * const data, const size_t size); /* Reading only. Reads size bytes directly from data without copying. data must remain valid and unchanged until the file buffer is uninitialized */
+int InitFileBufferToMemory(file_buffer_t * const file_buffer, uint8_t * const data, const size_t size); /* Writing only. Writes directly to data without copying and fails with ERROR_OUTPUT_FULL as soon as more than size bytes are to be written. Write spans may be smaller than requested close to the end of data. GetActualFileOffset is the number of bytes written */
 int InitFileBufferInMemory(file_buffer_t * const file_buffer, const file_buffer_mode_t mode, const size_t buffer_size);
+int InitFileBufferInMemoryChunked(file_buffer_t * const file_buffer, const file_buffer_mode_t mode, chunk_pool_t * const chunk_pool); /* Grows by adding chunks from chunk_pool instead of resizing (copying) and returns chunks to the pool when reading */
 void UninitFileBuffer(file_buffer_t * const file_buffer);
 
+int SetFileBufferMemoryBudget(file_buffer_t * const file_buffer, const size_t memory_budget, const size_t spill_buffer_size); /* In-memory buffers only. Once more than memory_budget bytes are written, the data is moved to an unlinked temporary file which is read back through a buffer of spill_buffer_size bytes. The file is removed when clearing or resetting. 0 means unlimited */
+
+file_buffer_pipe_t *AllocateFileBufferPipe(void);
+void FreeFileBufferPipe(file_buffer_pipe_t * const pipe);
+int InitFileBufferPipe(file_buffer_pipe_t * const pipe, const size_t num_blocks, const size_t block_size); /* Bounded queue of num_blocks blocks of block_size bytes */
+void UninitFileBufferPipe(file_buffer_pipe_t * const pipe); /* After uninitializing both file buffers using it */
+
+int CloseFileBufferPipe(file_buffer_t * const file_buffer, const uint8_t trailing_byte, const uint8_t trailing_bits); /* Writing: flushes and signals EOF to the reader after trailing_bits (less than 8) left-over bits in the MSBs of trailing_byte. Reading: discards all further data so that the writer never blocks. Also done when uninitializing */
+int GetFileBufferTrailingBits(const file_buffer_t * const file_buffer, uint8_t * const trailing_byte, uint8_t * const trailing_bits); /* Left-over bits after the last byte of a closed pipe (0 bits for all other file buffers) */
+
 file_buffer_mode_t GetFileBufferMode(const file_buffer_t * const file_buffer);
 int SetFileBufferMode(file_buffer_t * const file_buffer, const file_buffer_mode_t mode);
 
@@ -35,6 +53,11 @@ io_int_t GetActualFileSize(const file_buffer_t * const file_buffer);
 io_int_t ReadFileBuffer(file_buffer_t * const file_buffer, uint8_t * const output, const size_t output_size);
 io_int_t WriteFileBuffer(file_buffer_t * const file_buffer, const uint8_t * const input, const size_t input_size);
 
+io_int_t AcquireFileBufferReadSpan(file_buffer_t * const file_buffer, const uint8_t ** const span, const size_t max_size); /* Up to max_size contiguous unread bytes which can be read in place (0 at EOF). Valid until the next operation on the file buffer */
+int ReleaseFileBufferReadSpan(file_buffer_t * const file_buffer, const size_t size); /* Marks size bytes of the acquired span as read */
+io_int_t ReserveFileBufferWriteSpan(file_buffer_t * const file_buffer, uint8_t ** const span, const size_t min_size); /* At least min_size (and at least one) contiguous bytes which can be written in place (fewer at the end of caller memory, see InitFileBufferToMemory). Valid until the next operation on the file buffer */
+int CommitFileBufferWriteSpan(file_buffer_t * const file_buffer, const size_t size); /* Marks size bytes of the reserved span as written */
+
 int FlushFileBuffer(file_buffer_t * const file_buffer);
 
 int ClearFileBuffer(file_buffer_t * const file_buffer);
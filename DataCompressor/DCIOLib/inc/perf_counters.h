@@ -0,0 +1,39 @@
+/* Hardware performance counter wrapper (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _PERF_COUNTERS_H
+#define _PERF_COUNTERS_H
+
+#include <stdint.h>
+
+typedef enum perf_counter_t
+{
+  PC_CYCLES = 0,
+  PC_INSTRUCTIONS,
+  PC_BRANCH_MISSES,
+  PC_L1D_MISSES, /* Level 1 data cache read misses */
+  PC_LLC_MISSES, /* Last level cache read misses */
+  NUM_PERF_COUNTERS
+} perf_counter_t;
+
+typedef struct perf_counters_t
+{
+  int handles[NUM_PERF_COUNTERS]; /* Negative if the counter is not available */
+} perf_counters_t;
+
+typedef struct perf_counter_values_t
+{
+  uint64_t values[NUM_PERF_COUNTERS];
+  int available[NUM_PERF_COUNTERS]; /* Not set if the counter could not be opened or was never scheduled, i.e., values is undefined */
+} perf_counter_values_t;
+
+int OpenPerfCounters(perf_counters_t * const counters, const int inherit); /* Counts the calling thread only and, if inherit is set, all threads it starts afterwards. Returns 0 if no counter is available (e.g., not Linux, no hardware support or perf_event_paranoid) */
+void StartPerfCounters(perf_counters_t * const counters); /* Resets all counters to 0 */
+void StopPerfCounters(perf_counters_t * const counters, perf_counter_values_t * const values); /* Counts of started threads are only included after they have been joined */
+void ClosePerfCounters(perf_counters_t * const counters);
+
+void ClearPerfCounterValues(perf_counter_values_t * const values); /* Marks all values as unavailable */
+const char *GetPerfCounterName(const perf_counter_t counter);
+
+#endif
\ No newline at end of file
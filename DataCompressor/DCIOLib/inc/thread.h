@@ -0,0 +1,61 @@
+/* Thread wrapper (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _THREAD_H
+#define _THREAD_H
+
+#include <stddef.h>
+
+#ifdef _WIN32
+  #include <windows.h>
+#else /* Assume POSIX threads */
+  #include <pthread.h>
+#endif
+
+typedef void thread_function_t(void * const caller_info);
+
+typedef struct thread_t
+{
+#ifdef _WIN32
+  HANDLE handle;
+#else
+  pthread_t handle;
+#endif
+  thread_function_t *function;
+  void *caller_info;
+} thread_t;
+
+typedef struct mutex_t
+{
+#ifdef _WIN32
+  CRITICAL_SECTION handle;
+#else
+  pthread_mutex_t handle;
+#endif
+} mutex_t;
+
+typedef struct condition_t
+{
+#ifdef _WIN32
+  CONDITION_VARIABLE handle;
+#else
+  pthread_cond_t handle;
+#endif
+} condition_t;
+
+int StartThread(thread_t * const thread, thread_function_t * const function, void * const caller_info); /* thread must not be moved until it has been joined */
+int JoinThread(thread_t * const thread);
+size_t GetNumberOfProcessors(void); /* Number of online processors (at least 1) */
+
+int InitMutex(mutex_t * const mutex);
+void UninitMutex(mutex_t * const mutex);
+void LockMutex(mutex_t * const mutex);
+void UnlockMutex(mutex_t * const mutex);
+
+int InitCondition(condition_t * const condition);
+void UninitCondition(condition_t * const condition);
+void WaitCondition(condition_t * const condition, mutex_t * const mutex); /* mutex must be locked */
+void SignalCondition(condition_t * const condition); /* Wakes up all waiting threads */
+
+#endif
\ No newline at end of file
@@ -0,0 +1,11 @@
+/* Timer wrapper (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _TIMER_H
+#define _TIMER_H
+
+double GetWallClockTime(void); /* Monotonic time in seconds since an arbitrary point in time, i.e., only differences are meaningful */
+double GetProcessorTime(void); /* Processor time of all threads of the process in seconds since an arbitrary point in time */
+
+#endif
\ No newline at end of file
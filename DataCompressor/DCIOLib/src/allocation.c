@@ -0,0 +1,154 @@
+/* Allocation tracking
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "allocation.h"
+
+#include <stdlib.h>
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <sys/resource.h>
+#endif
+
+#ifdef _WIN32
+  typedef volatile LONG64 counter_t;
+  #define ADD_TO_COUNTER(counter, value) ((uint64_t)InterlockedExchangeAdd64(&(counter), (LONG64)(value))) /* Returns the previous value */
+  #define SWAP_COUNTER(counter, old_value, new_value) (InterlockedCompareExchange64(&(counter), (LONG64)(new_value), (LONG64)(old_value)) == (LONG64)(old_value))
+#else /* Assume GCC-compatible atomic builtins */
+  typedef volatile uint64_t counter_t;
+  #define ADD_TO_COUNTER(counter, value) __sync_fetch_and_add(&(counter), (uint64_t)(value))
+  #define SWAP_COUNTER(counter, old_value, new_value) __sync_bool_compare_and_swap(&(counter), (uint64_t)(old_value), (uint64_t)(new_value))
+#endif
+#define READ_COUNTER(counter) ADD_TO_COUNTER(counter, 0) /* Atomic on 32-bit platforms as well */
+
+#ifdef _WIN32
+  #define THREAD_LOCAL __declspec(thread)
+#else
+  #define THREAD_LOCAL __thread
+#endif
+
+typedef union allocation_header_t /* Precedes each allocation to know its size when freeing. The union keeps the memory behind it aligned like the memory returned by malloc */
+{
+  size_t size;
+  long double long_double_alignment;
+  void *pointer_alignment;
+  uint64_t integer_alignment;
+} allocation_header_t;
+
+static counter_t num_allocations = 0, num_reallocations = 0, num_frees = 0;
+static counter_t allocated_bytes = 0, current_bytes = 0, peak_bytes = 0;
+static counter_t num_buffer_growths = 0;
+static THREAD_LOCAL int64_t thread_current_bytes = 0, thread_peak_bytes = 0; /* Negative if the thread frees memory allocated by other threads */
+
+static void AddCurrentBytes(const size_t size)
+{
+  const uint64_t new_current_bytes = ADD_TO_COUNTER(current_bytes, size) + size;
+  uint64_t old_peak_bytes;
+  while ((old_peak_bytes = READ_COUNTER(peak_bytes)) < new_current_bytes && !SWAP_COUNTER(peak_bytes, old_peak_bytes, new_current_bytes)); /* Retry if another thread changed the peak in the meantime */
+  thread_current_bytes += (int64_t)size;
+  if (thread_current_bytes > thread_peak_bytes)
+    thread_peak_bytes = thread_current_bytes;
+}
+
+static void SubtractCurrentBytes(const size_t size)
+{
+  ADD_TO_COUNTER(current_bytes, -(int64_t)size); /* Wraps around as intended */
+  thread_current_bytes -= (int64_t)size;
+}
+
+void *AllocateMemory(const size_t size)
+{
+  allocation_header_t *header;
+  if (size > (size_t)-1 - sizeof(allocation_header_t) || (header = (allocation_header_t*)malloc(sizeof(allocation_header_t) + size)) == NULL)
+    return NULL;
+  header->size = size;
+  ADD_TO_COUNTER(num_allocations, 1);
+  ADD_TO_COUNTER(allocated_bytes, size);
+  AddCurrentBytes(size);
+  return header + 1;
+}
+
+void *ReallocateMemory(void * const memory, const size_t size)
+{
+  allocation_header_t *old_header, *new_header;
+  size_t old_size;
+  if (memory == NULL)
+    return AllocateMemory(size);
+  old_header = (allocation_header_t*)memory - 1;
+  old_size = old_header->size;
+  if (size > (size_t)-1 - sizeof(allocation_header_t) || (new_header = (allocation_header_t*)realloc(old_header, sizeof(allocation_header_t) + size)) == NULL)
+    return NULL; /* The old memory remains valid */
+  new_header->size = size;
+  ADD_TO_COUNTER(num_reallocations, 1);
+  ADD_TO_COUNTER(allocated_bytes, size);
+  if (size > old_size)
+    AddCurrentBytes(size - old_size);
+  else
+    SubtractCurrentBytes(old_size - size);
+  return new_header + 1;
+}
+
+void FreeMemory(void * const memory)
+{
+  allocation_header_t *header;
+  if (memory == NULL)
+    return;
+  header = (allocation_header_t*)memory - 1;
+  ADD_TO_COUNTER(num_frees, 1);
+  SubtractCurrentBytes(header->size);
+  free(header);
+}
+
+void CountBufferGrowth(void)
+{
+  ADD_TO_COUNTER(num_buffer_growths, 1);
+}
+
+void GetAllocationStatistics(allocation_stats_t * const stats)
+{
+  stats->num_allocations = READ_COUNTER(num_allocations);
+  stats->num_reallocations = READ_COUNTER(num_reallocations);
+  stats->num_frees = READ_COUNTER(num_frees);
+  stats->allocated_bytes = READ_COUNTER(allocated_bytes);
+  stats->current_bytes = READ_COUNTER(current_bytes);
+  stats->peak_bytes = READ_COUNTER(peak_bytes);
+  stats->num_buffer_growths = READ_COUNTER(num_buffer_growths);
+}
+
+uint64_t ResetPeakAllocatedBytes(void)
+{
+  uint64_t old_peak_bytes;
+  do
+    old_peak_bytes = READ_COUNTER(peak_bytes);
+  while (!SWAP_COUNTER(peak_bytes, old_peak_bytes, READ_COUNTER(current_bytes)));
+  return old_peak_bytes;
+}
+
+uint64_t ResetThreadPeakAllocatedBytes(void)
+{
+  const uint64_t old_peak_bytes = thread_peak_bytes > 0 ? (uint64_t)thread_peak_bytes : 0;
+  thread_peak_bytes = thread_current_bytes;
+  return old_peak_bytes;
+}
+
+uint64_t GetThreadPeakAllocatedBytes(void)
+{
+  return thread_peak_bytes > 0 ? (uint64_t)thread_peak_bytes : 0;
+}
+
+uint64_t GetPeakResidentMemory(void)
+{
+#ifdef _WIN32
+  return 0; /* Would require psapi */
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return (uint64_t)usage.ru_maxrss; /* Bytes on macOS */
+#else
+  return (uint64_t)usage.ru_maxrss * 1024; /* Kilobytes on Linux */
+#endif
+#endif
+}
\ No newline at end of file
@@ -4,103 +4,97 @@
 
 #include "err_codes.h"
 #include "bit_file_buffer.h"
+#include "allocation.h"
 
 #include <stdlib.h>
 
-#define MAX_USED_BITS 8
+#define BYTE_BITS 8
+
+typedef uint64_t accumulator_t;
+
+#define ACCUMULATOR_SIZE (sizeof(accumulator_t))
+#define ACCUMULATOR_BITS (BYTE_BITS * ACCUMULATOR_SIZE)
 
 struct bit_file_buffer_t
 {
+  bit_file_buffer_window_t window; /* Must be the first member (see END_OF_BIT_FILE_BUFFER) */
   file_buffer_t *file_buffer;
-  uint8_t byte_buffer;
-  uint8_t used_bits;
+  accumulator_t accumulator; /* Bits are stored MSB first, i.e., the next bit to be read or written is the MSB */
   uint8_t extra_byte_buffer; /* Used when swapping from writing to reading mode */
   uint8_t extra_used_bits;
+  uint8_t extra_bits_loaded; /* Set when the extra bits have been moved to the accumulator */
+  uint8_t span_bytes[ACCUMULATOR_SIZE]; /* Complete bytes from the accumulator handed out as read span */
 };
 
 bit_file_buffer_t *AllocateBitFileBuffer(void)
 {
-  return (bit_file_buffer_t*)malloc(sizeof(bit_file_buffer_t));
+  return (bit_file_buffer_t*)AllocateMemory(sizeof(bit_file_buffer_t));
 }
 
 void FreeBitFileBuffer(bit_file_buffer_t * const bit_file_buffer)
 {
-  free(bit_file_buffer);
+  FreeMemory(bit_file_buffer);
 }
 
-static void ResetBufferByte(bit_file_buffer_t * const bit_file_buffer)
+static void ResetAccumulator(bit_file_buffer_t * const bit_file_buffer)
 {
-  bit_file_buffer->byte_buffer = 0;
-  switch (GetFileBufferMode(bit_file_buffer->file_buffer))
-  {
-    case FBM_READING:
-      bit_file_buffer->used_bits = MAX_USED_BITS;
-      break;
-    case FBM_WRITING:
-    default:
-      bit_file_buffer->used_bits = 0;
-      break;
-  }
-  bit_file_buffer->extra_byte_buffer = bit_file_buffer->extra_used_bits = 0;
+  bit_file_buffer->accumulator = 0;
+  bit_file_buffer->window.used_bits = 0;
+  bit_file_buffer->extra_byte_buffer = bit_file_buffer->extra_used_bits = bit_file_buffer->extra_bits_loaded = 0;
 }
 
 void InitBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, file_buffer_t * const file_buffer)
 {
   bit_file_buffer->file_buffer = file_buffer;
-  ResetBufferByte(bit_file_buffer);
+  bit_file_buffer->window.mode = GetFileBufferMode(file_buffer);
+  ResetAccumulator(bit_file_buffer);
+}
+
+static int ExtraBitsPending(const bit_file_buffer_t * const bit_file_buffer) /* Only meaningful at EOF of the underlying file buffer */
+{
+  uint8_t trailing_byte, trailing_bits;
+  if (bit_file_buffer->extra_bits_loaded)
+    return 0;
+  if (bit_file_buffer->extra_used_bits != 0)
+    return 1;
+  return GetFileBufferTrailingBits(bit_file_buffer->file_buffer, &trailing_byte, &trailing_bits) == NO_ERROR && trailing_bits != 0; /* Left-over bits of a pipe are only known at EOF */
 }
 
 int EndOfBitFileBuffer(const bit_file_buffer_t * const bit_file_buffer)
 {
-  const int eof = EndOfFileBuffer(bit_file_buffer->file_buffer);
-  if (eof < 0) /* Error */
-    return eof;
-  if (GetFileBufferMode(bit_file_buffer->file_buffer) == FBM_READING && eof)
-    return bit_file_buffer->extra_used_bits == 0 && bit_file_buffer->used_bits == MAX_USED_BITS;
-  else
+  int eof;
+  if (bit_file_buffer->window.used_bits != 0 && bit_file_buffer->window.mode == FBM_READING) /* Fast path (usually taken by END_OF_BIT_FILE_BUFFER already): there are unread bits in the accumulator */
     return 0;
+  if ((eof = EndOfFileBuffer(bit_file_buffer->file_buffer)) < 0) /* Error */
+    return eof;
+  return eof && !ExtraBitsPending(bit_file_buffer);
 }
 
 void GetActualBitFileOffset(const bit_file_buffer_t * const bit_file_buffer, io_int_t * const byte_offset, uint8_t * const bit_offset)
 {
   const io_int_t offset = GetActualFileOffset(bit_file_buffer->file_buffer);
+  io_int_t bits;
   if (offset < 0)
   {
     *byte_offset = offset;
     *bit_offset = 0;
     return;
   }
-  switch (GetFileBufferMode(bit_file_buffer->file_buffer))
+  switch (bit_file_buffer->window.mode)
   {
-    case FBM_READING:
-      if (bit_file_buffer->used_bits == MAX_USED_BITS)
-      {
-        *byte_offset = offset;
-        *bit_offset = 0;
-      }
-      else
-      {
-        *byte_offset = offset - 1;
-        *bit_offset = bit_file_buffer->used_bits;
-      }
+    case FBM_READING: /* Bits in the accumulator have already been read from the file buffer, but not by the caller */
+      bits = BYTE_BITS * offset - bit_file_buffer->window.used_bits + (bit_file_buffer->extra_bits_loaded ? bit_file_buffer->extra_used_bits : 0);
       break;
-    case FBM_WRITING:
-      if (bit_file_buffer->used_bits == MAX_USED_BITS)
-      {
-        *byte_offset = offset + 1;
-        *bit_offset = 0;
-      }
-      else
-      {
-        *byte_offset = offset;
-        *bit_offset = bit_file_buffer->used_bits;
-      }
+    case FBM_WRITING: /* Bits in the accumulator have already been written by the caller, but not to the file buffer */
+      bits = BYTE_BITS * offset + bit_file_buffer->window.used_bits;
       break;
     default:
       *byte_offset = ERROR_INVALID_MODE;
       *bit_offset = 0;
-      break;
+      return;
   }
+  *byte_offset = bits / BYTE_BITS;
+  *bit_offset = (uint8_t)(bits % BYTE_BITS);
 }
 
 void GetActualBitFileSize(const bit_file_buffer_t * const bit_file_buffer, io_int_t * const byte_size, uint8_t * const bit_size)
@@ -112,207 +106,364 @@ void GetActualBitFileSize(const bit_file_buffer_t * const bit_file_buffer, io_in
     *bit_size = 0;
     return;
   }
-  if (bit_file_buffer->extra_used_bits == MAX_USED_BITS)
-  {
-    *byte_size = size + 1;
-    *bit_size = 0;
-  }
-  else
-  {
-    *byte_size = size;
-    *bit_size = bit_file_buffer->extra_used_bits;
-  }
+  *byte_size = size;
+  *bit_size = bit_file_buffer->extra_used_bits; /* Never a full byte since full bytes are spilled when switching modes */
+}
+
+static int SpillAccumulator(bit_file_buffer_t * const bit_file_buffer) /* Writes all complete bytes from the accumulator to the file buffer and keeps the remaining bits */
+{
+  uint8_t bytes[ACCUMULATOR_SIZE];
+  const size_t num_bytes = bit_file_buffer->window.used_bits / BYTE_BITS;
+  size_t i;
+  io_int_t ret;
+  if (num_bytes == 0)
+    return NO_ERROR;
+  for (i = 0; i < num_bytes; i++)
+    bytes[i] = (uint8_t)(bit_file_buffer->accumulator >> (ACCUMULATOR_BITS - BYTE_BITS - BYTE_BITS * i));
+  if ((ret = WriteFileBuffer(bit_file_buffer->file_buffer, bytes, num_bytes)) != (io_int_t)num_bytes)
+    return ret < 0 ? (int)ret : ERROR_FILE_IO; /* Pass on errors like ERROR_OUTPUT_FULL so that they can be told apart */
+  bit_file_buffer->accumulator = num_bytes == ACCUMULATOR_SIZE ? 0 : bit_file_buffer->accumulator << (BYTE_BITS * num_bytes);
+  bit_file_buffer->window.used_bits -= (uint8_t)(BYTE_BITS * num_bytes);
+  return NO_ERROR;
 }
 
 int SetBitFileBufferMode(bit_file_buffer_t * const bit_file_buffer, const file_buffer_mode_t mode)
 {
-  const file_buffer_mode_t old_mode = GetFileBufferMode(bit_file_buffer->file_buffer);
+  const file_buffer_mode_t old_mode = bit_file_buffer->window.mode;
   int ret;
+  if (old_mode == FBM_WRITING && mode == FBM_READING) /* Write all complete bytes before the file buffer changes its mode */
+  {
+    if ((ret = SpillAccumulator(bit_file_buffer)) != NO_ERROR)
+      return ret;
+  }
   if ((ret = SetFileBufferMode(bit_file_buffer->file_buffer, mode)) != NO_ERROR)
     return ret;
+  bit_file_buffer->window.mode = mode;
   if (old_mode == mode)
     return NO_ERROR;
   else if (old_mode == FBM_WRITING && mode == FBM_READING) /* Changed from writing to reading (the other way around is not supported) */
   {
-    bit_file_buffer->extra_byte_buffer = bit_file_buffer->byte_buffer;
-    bit_file_buffer->extra_used_bits = bit_file_buffer->used_bits;
-    bit_file_buffer->used_bits = MAX_USED_BITS; /* Mark all bits as used => force next read operation to refill buffer */
+    bit_file_buffer->extra_byte_buffer = (uint8_t)(bit_file_buffer->accumulator >> (ACCUMULATOR_BITS - BYTE_BITS)); /* Left-over bits (less than one byte) */
+    bit_file_buffer->extra_used_bits = bit_file_buffer->window.used_bits;
+    bit_file_buffer->extra_bits_loaded = 0;
+    bit_file_buffer->accumulator = 0;
+    bit_file_buffer->window.used_bits = 0; /* Force next read operation to refill the accumulator */
     return NO_ERROR;
   }
   else
     return ERROR_INVALID_MODE;
 }
 
-/* TODO: Implement PeekBitFileBuffer */
+static int RefillAccumulator(bit_file_buffer_t * const bit_file_buffer) /* Appends as many complete bytes as fit into the accumulator (unused bits are always zero) */
+{
+  uint8_t bytes[ACCUMULATOR_SIZE];
+  const size_t num_bytes = (ACCUMULATOR_BITS - bit_file_buffer->window.used_bits) / BYTE_BITS;
+  io_int_t i, read = 0;
+  if (num_bytes != 0 && (read = ReadFileBuffer(bit_file_buffer->file_buffer, bytes, num_bytes)) < 0)
+    return (int)read;
+  for (i = 0; i < read; i++)
+    bit_file_buffer->accumulator |= (accumulator_t)bytes[i] << (ACCUMULATOR_BITS - BYTE_BITS - bit_file_buffer->window.used_bits - BYTE_BITS * i);
+  bit_file_buffer->window.used_bits += (uint8_t)(BYTE_BITS * read);
+  if (read != (io_int_t)num_bytes && bit_file_buffer->extra_used_bits == 0 && !bit_file_buffer->extra_bits_loaded) /* Left-over bits of a pipe are only known at EOF, which has been reached when reading less than requested */
+    GetFileBufferTrailingBits(bit_file_buffer->file_buffer, &bit_file_buffer->extra_byte_buffer, &bit_file_buffer->extra_used_bits); /* Ignore result */
+  if (read != (io_int_t)num_bytes && ExtraBitsPending(bit_file_buffer) && bit_file_buffer->window.used_bits + bit_file_buffer->extra_used_bits <= ACCUMULATOR_BITS && EndOfFileBuffer(bit_file_buffer->file_buffer) == 1) /* Special case: changed from writing to reading mode or read from a pipe and there are left-over bits after the last byte */
+  {
+    bit_file_buffer->accumulator |= (accumulator_t)bit_file_buffer->extra_byte_buffer << (ACCUMULATOR_BITS - BYTE_BITS - bit_file_buffer->window.used_bits);
+    bit_file_buffer->window.used_bits += bit_file_buffer->extra_used_bits;
+    bit_file_buffer->extra_bits_loaded = 1;
+  }
+  return NO_ERROR;
+}
 
-static int8_t ReadBitFileBufferBytewise(bit_file_buffer_t * const bit_file_buffer, uint8_t * const output, const uint8_t output_bit_size)
+io_int_t PeekBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, io_uint_t * const value, const size_t value_bit_size)
 {
-  uint8_t new_bits = output_bit_size;
-  int8_t read = 0;
-  const uint8_t old_bits = MAX_USED_BITS - bit_file_buffer->used_bits;
-  if (output_bit_size > MAX_USED_BITS)
+  int ret;
+  if (value_bit_size > MAX_PEEK_BIT_SIZE || value_bit_size > IO_SIZE_BITS)
     return ERROR_INVALID_VALUE;
-  *output = 0;
-  if (output_bit_size > old_bits)
+  if (bit_file_buffer->window.mode != FBM_READING) /* Only peek when in reading mode */
+    return ERROR_INVALID_MODE;
+  if (bit_file_buffer->window.used_bits < value_bit_size) /* Top up accumulator. This guarantees at least MAX_PEEK_BIT_SIZE bits unless EOF is reached */
   {
-    if (old_bits > 0)
-    {
-      *output |= bit_file_buffer->byte_buffer & ((1 << old_bits) - 1); /* Read remaining bits */
-      read += old_bits;
-      bit_file_buffer->used_bits = MAX_USED_BITS;
-    }
-    new_bits -= read;
-    if (ReadFileBuffer(bit_file_buffer->file_buffer, &bit_file_buffer->byte_buffer, 1) == 1) /* Refill buffer (byte) */
-      bit_file_buffer->used_bits = 0;
-    else /* No more bits to be read (possibly EOF) => abort and return what could be read (except if there are left-over bits) */
-    {
-      if (bit_file_buffer->extra_used_bits > 0) /* Special case: changed from writing to reading mode and there are left-over bits */
-      {
-        if (new_bits > bit_file_buffer->extra_used_bits) /* Don't read more bits than are available */
-          new_bits = bit_file_buffer->extra_used_bits;
-        bit_file_buffer->byte_buffer = bit_file_buffer->extra_byte_buffer >> (MAX_USED_BITS - bit_file_buffer->extra_used_bits);
-        bit_file_buffer->used_bits = MAX_USED_BITS - bit_file_buffer->extra_used_bits;
-        bit_file_buffer->extra_used_bits = 0;
-      }
-      else
-        return read; /* Abort and return */
-    }
-    if (old_bits > 0)
-      *output <<= output_bit_size - old_bits;
+    if ((ret = RefillAccumulator(bit_file_buffer)) != NO_ERROR)
+      return ret;
   }
-  *output |= (bit_file_buffer->byte_buffer & ((1 << (MAX_USED_BITS - bit_file_buffer->used_bits)) - 1)) >> (MAX_USED_BITS - new_bits - bit_file_buffer->used_bits); /* Read bits (MSB first) */
-  bit_file_buffer->used_bits += new_bits;
-  read += new_bits;
-  return read;
+  *value = value_bit_size == 0 ? 0 : (io_uint_t)(bit_file_buffer->accumulator >> (ACCUMULATOR_BITS - value_bit_size)); /* Bits after EOF are zero */
+  return bit_file_buffer->window.used_bits < value_bit_size ? bit_file_buffer->window.used_bits : value_bit_size;
 }
 
-io_int_t ReadBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, uint8_t * const output, const size_t output_bit_size)
+io_int_t SkipBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, const size_t num_bits)
 {
-  const size_t num_full_reads = output_bit_size / MAX_USED_BITS;
-  uint8_t remaining_bits = output_bit_size % MAX_USED_BITS;
-  if (GetFileBufferMode(bit_file_buffer->file_buffer) != FBM_READING) /* Only read when in reading mode */
+  size_t skipped = 0;
+  int ret;
+  if (bit_file_buffer->window.mode != FBM_READING) /* Only skip when in reading mode */
     return ERROR_INVALID_MODE;
-  if (num_full_reads > 0)
+  if (num_bits > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  while (skipped < num_bits)
   {
-    size_t i;
-    for (i = 0; i < num_full_reads; i++)
+    uint8_t bits_to_skip;
+    if (bit_file_buffer->window.used_bits == 0)
     {
-      int8_t read;
-      if ((read = ReadBitFileBufferBytewise(bit_file_buffer, &output[i], MAX_USED_BITS)) != MAX_USED_BITS)
-      {
-        output[i] <<= (MAX_USED_BITS - read); /* Realign fractional byte */
-        return i * MAX_USED_BITS + read; /* Return number of (previously) successfully read bytes plus remaining fraction */
-      }
+      if ((ret = RefillAccumulator(bit_file_buffer)) != NO_ERROR)
+        return ret;
+      if (bit_file_buffer->window.used_bits == 0) /* EOF => return number of (previously) successfully skipped bits */
+        break;
     }
+    bits_to_skip = (uint8_t)(num_bits - skipped < bit_file_buffer->window.used_bits ? num_bits - skipped : bit_file_buffer->window.used_bits);
+    bit_file_buffer->accumulator = bits_to_skip == ACCUMULATOR_BITS ? 0 : bit_file_buffer->accumulator << bits_to_skip;
+    bit_file_buffer->window.used_bits -= bits_to_skip;
+    skipped += bits_to_skip;
   }
-  if (remaining_bits > 0)
+  return skipped;
+}
+
+static io_int_t ReadBits(bit_file_buffer_t * const bit_file_buffer, accumulator_t * const value, const uint8_t num_bits) /* Reads up to 64 bits (MSB first) into the LSBs of value. Returns fewer bits than requested at EOF */
+{
+  accumulator_t current_value;
+  uint8_t old_bits, new_bits;
+  int ret;
+  if (num_bits <= bit_file_buffer->window.used_bits) /* Fast path: all bits are in the accumulator */
   {
-    uint8_t temp_byte;
-    int8_t read;
-    if ((read = ReadBitFileBufferBytewise(bit_file_buffer, &temp_byte, remaining_bits)) != remaining_bits)
-      return num_full_reads * MAX_USED_BITS + (read >= 0 ? read : 0); /* Return number of (previously) successfully read bytes (include last bits read if there was no error) */
+    if (num_bits == 0)
+      *value = 0;
     else
-      output[num_full_reads] = temp_byte << (MAX_USED_BITS - remaining_bits);
+    {
+      *value = bit_file_buffer->accumulator >> (ACCUMULATOR_BITS - num_bits);
+      bit_file_buffer->accumulator = num_bits == ACCUMULATOR_BITS ? 0 : bit_file_buffer->accumulator << num_bits;
+      bit_file_buffer->window.used_bits -= num_bits;
+    }
+    return num_bits;
+  }
+  old_bits = bit_file_buffer->window.used_bits; /* Read remaining bits first */
+  current_value = old_bits == 0 ? 0 : bit_file_buffer->accumulator >> (ACCUMULATOR_BITS - old_bits);
+  bit_file_buffer->accumulator = 0;
+  bit_file_buffer->window.used_bits = 0;
+  if ((ret = RefillAccumulator(bit_file_buffer)) != NO_ERROR)
+    return ret;
+  new_bits = num_bits - old_bits;
+  if (new_bits > bit_file_buffer->window.used_bits) /* No more bits to be read (EOF) => return what could be read */
+    new_bits = bit_file_buffer->window.used_bits;
+  if (new_bits != 0)
+  {
+    current_value = (old_bits == 0 ? 0 : current_value << new_bits) | (bit_file_buffer->accumulator >> (ACCUMULATOR_BITS - new_bits));
+    bit_file_buffer->accumulator = new_bits == ACCUMULATOR_BITS ? 0 : bit_file_buffer->accumulator << new_bits;
+    bit_file_buffer->window.used_bits -= new_bits;
+  }
+  *value = current_value;
+  return old_bits + new_bits;
+}
+
+static void StoreBytes(uint8_t * const output, const accumulator_t value, const size_t num_bits) /* Stores the num_bits MSBs of value in output (MSB first) */
+{
+  size_t i;
+  for (i = 0; i < (num_bits + BYTE_BITS - 1) / BYTE_BITS; i++)
+    output[i] = (uint8_t)(value >> (ACCUMULATOR_BITS - BYTE_BITS - BYTE_BITS * i));
+}
+
+io_int_t ReadBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, uint8_t * const output, const size_t output_bit_size)
+{
+  size_t read = 0;
+  if (bit_file_buffer->window.mode != FBM_READING) /* Only read when in reading mode */
+    return ERROR_INVALID_MODE;
+  while (read < output_bit_size)
+  {
+    const uint8_t bits_to_read = (uint8_t)(output_bit_size - read > ACCUMULATOR_BITS ? ACCUMULATOR_BITS : output_bit_size - read);
+    accumulator_t value;
+    const io_int_t ret = ReadBits(bit_file_buffer, &value, bits_to_read);
+    if (ret < 0)
+      return ret;
+    if (ret != 0)
+      StoreBytes(&output[read / BYTE_BITS], ret == (io_int_t)ACCUMULATOR_BITS ? value : value << (ACCUMULATOR_BITS - ret), (size_t)ret); /* Align MSB first (fractional bytes are padded with zeros) */
+    read += (size_t)ret;
+    if (ret != bits_to_read) /* Return number of (previously) successfully read bits */
+      return read;
   }
   return output_bit_size; /* Reading successful */
 }
 
-static int8_t WriteBitFileBufferBytewise(bit_file_buffer_t * const bit_file_buffer, const uint8_t * const input, const uint8_t input_bit_size)
+static io_int_t WriteBits(bit_file_buffer_t * const bit_file_buffer, accumulator_t value, const uint8_t num_bits) /* Writes the num_bits LSBs of value (MSB first) */
 {
-  int8_t written = 0;
-  const int8_t free_bits = MAX_USED_BITS - bit_file_buffer->used_bits;
-  int8_t new_bits;
-  if (input_bit_size > MAX_USED_BITS)
-    return ERROR_INVALID_VALUE;
-  if (input_bit_size > free_bits)
+  const uint8_t free_bits = ACCUMULATOR_BITS - bit_file_buffer->window.used_bits;
+  int ret;
+  if (num_bits == 0)
+    return 0;
+  if (num_bits != ACCUMULATOR_BITS)
+    value &= ((accumulator_t)1 << num_bits) - 1;
+  if (num_bits < free_bits) /* Fast path: all bits fit into the accumulator */
   {
-    if (free_bits > 0)
-    {
-      bit_file_buffer->byte_buffer |= (*input & ((1 << input_bit_size) - 1)) >> (input_bit_size - free_bits);
-      written += free_bits;
-    }
-    if (WriteFileBuffer(bit_file_buffer->file_buffer, &bit_file_buffer->byte_buffer, 1) == 1) /* Flush buffer (byte) */
-      bit_file_buffer->used_bits = 0;
-    else /* Writing was unsuccessful => abort and return what could be written */
+    bit_file_buffer->accumulator |= value << (free_bits - num_bits);
+    bit_file_buffer->window.used_bits += num_bits;
+  }
+  else /* Fill accumulator, spill it and keep the remaining bits */
+  {
+    const uint8_t remaining_bits = num_bits - free_bits;
+    bit_file_buffer->accumulator |= value >> remaining_bits;
+    bit_file_buffer->window.used_bits = ACCUMULATOR_BITS;
+    if ((ret = SpillAccumulator(bit_file_buffer)) != NO_ERROR) /* Writing was unsuccessful => abort */
+      return ret;
+    if (remaining_bits != 0)
     {
-      bit_file_buffer->used_bits += written;
-      return written;
+      bit_file_buffer->accumulator = value << (ACCUMULATOR_BITS - remaining_bits);
+      bit_file_buffer->window.used_bits = remaining_bits;
     }
-    bit_file_buffer->byte_buffer = 0; /* Reinitialize buffer (byte) */
   }
-  new_bits = input_bit_size - written;
-  bit_file_buffer->byte_buffer |= (*input & ((1 << new_bits) - 1)) << (MAX_USED_BITS - new_bits - bit_file_buffer->used_bits); /* Write bits (MSB first) */
-  bit_file_buffer->used_bits += new_bits;
-  written += new_bits;
-  return written;
+  return num_bits;
+}
+
+static accumulator_t LoadBytes(const uint8_t * const input, const size_t num_bits) /* Loads num_bits bits from input (MSB first) into the MSBs of the return value */
+{
+  accumulator_t value = 0;
+  size_t i;
+  for (i = 0; i < (num_bits + BYTE_BITS - 1) / BYTE_BITS; i++)
+    value |= (accumulator_t)input[i] << (ACCUMULATOR_BITS - BYTE_BITS - BYTE_BITS * i);
+  return value;
 }
 
 io_int_t WriteBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, const uint8_t * const input, const size_t input_bit_size)
 {
-  const size_t num_full_writes = input_bit_size / MAX_USED_BITS;
-  const uint8_t remaining_bits = input_bit_size % MAX_USED_BITS;
-  if (GetFileBufferMode(bit_file_buffer->file_buffer) != FBM_WRITING) /* Only write when in writing mode */
+  size_t written = 0;
+  if (bit_file_buffer->window.mode != FBM_WRITING) /* Only write when in writing mode */
     return ERROR_INVALID_MODE;
-  if (num_full_writes > 0)
+  while (written < input_bit_size)
   {
-    size_t i;
-    for (i = 0; i < num_full_writes; i++)
-    {
-      int8_t written;
-      if ((written = WriteBitFileBufferBytewise(bit_file_buffer, &input[i], MAX_USED_BITS)) != MAX_USED_BITS)
-        return i * MAX_USED_BITS + written; /* Return number of (previously) successfully written bytes plus remaining fraction */
-    }
+    const uint8_t bits_to_write = (uint8_t)(input_bit_size - written > ACCUMULATOR_BITS ? ACCUMULATOR_BITS : input_bit_size - written);
+    const accumulator_t value = LoadBytes(&input[written / BYTE_BITS], bits_to_write);
+    const io_int_t ret = WriteBits(bit_file_buffer, bits_to_write == ACCUMULATOR_BITS ? value : value >> (ACCUMULATOR_BITS - bits_to_write), bits_to_write);
+    if (ret < 0)
+      return ret;
+    written += (size_t)ret;
   }
-  if (remaining_bits > 0)
+  return input_bit_size; /* Writing successful */
+}
+
+io_int_t AcquireBitFileBufferReadSpan(bit_file_buffer_t * const bit_file_buffer, const uint8_t ** const span, const size_t max_size)
+{
+  io_int_t ret;
+  if (bit_file_buffer->window.mode != FBM_READING) /* Only read when in reading mode */
+    return ERROR_INVALID_MODE;
+  if (bit_file_buffer->window.used_bits == 0) /* Borrow from the file buffer directly */
   {
-    uint8_t temp_byte = input[num_full_writes] >> (MAX_USED_BITS - remaining_bits);
-    int8_t written;
-    if ((written = WriteBitFileBufferBytewise(bit_file_buffer, &temp_byte, remaining_bits)) != remaining_bits)
-      return num_full_writes * MAX_USED_BITS; /* Return number of (previously) successfully written bytes */
+    if ((ret = AcquireFileBufferReadSpan(bit_file_buffer->file_buffer, span, max_size)) != 0 || max_size == 0 || !ExtraBitsPending(bit_file_buffer))
+      return ret;
+    if ((ret = RefillAccumulator(bit_file_buffer)) != NO_ERROR) /* Load left-over bits after the last byte */
+      return ret;
   }
-  return input_bit_size; /* Writing successful */
+  if (bit_file_buffer->window.used_bits % BYTE_BITS != 0) /* Span must start and end at a byte boundary */
+    return ERROR_INVALID_VALUE;
+  StoreBytes(bit_file_buffer->span_bytes, bit_file_buffer->accumulator, bit_file_buffer->window.used_bits); /* Hand out the bytes which have already been read ahead */
+  *span = bit_file_buffer->span_bytes;
+  return (io_int_t)(bit_file_buffer->window.used_bits / BYTE_BITS < max_size ? bit_file_buffer->window.used_bits / BYTE_BITS : max_size);
+}
+
+int ReleaseBitFileBufferReadSpan(bit_file_buffer_t * const bit_file_buffer, const size_t size)
+{
+  if (bit_file_buffer->window.mode != FBM_READING) /* Only read when in reading mode */
+    return ERROR_INVALID_MODE;
+  if (bit_file_buffer->window.used_bits == 0) /* Span was borrowed from the file buffer */
+    return ReleaseFileBufferReadSpan(bit_file_buffer->file_buffer, size);
+  if (size > (size_t)(bit_file_buffer->window.used_bits / BYTE_BITS))
+    return ERROR_INVALID_VALUE;
+  bit_file_buffer->accumulator = size == ACCUMULATOR_SIZE ? 0 : bit_file_buffer->accumulator << (BYTE_BITS * size);
+  bit_file_buffer->window.used_bits -= (uint8_t)(BYTE_BITS * size);
+  return NO_ERROR;
+}
+
+io_int_t ReserveBitFileBufferWriteSpan(bit_file_buffer_t * const bit_file_buffer, uint8_t ** const span, const size_t min_size)
+{
+  int ret;
+  if (bit_file_buffer->window.mode != FBM_WRITING) /* Only write when in writing mode */
+    return ERROR_INVALID_MODE;
+  if (bit_file_buffer->window.used_bits % BYTE_BITS != 0) /* Span must start at a byte boundary */
+    return ERROR_INVALID_VALUE;
+  if ((ret = SpillAccumulator(bit_file_buffer)) != NO_ERROR) /* Preserve order of previously written bits */
+    return ret;
+  return ReserveFileBufferWriteSpan(bit_file_buffer->file_buffer, span, min_size);
+}
+
+int CommitBitFileBufferWriteSpan(bit_file_buffer_t * const bit_file_buffer, const size_t size)
+{
+  if (bit_file_buffer->window.mode != FBM_WRITING) /* Only write when in writing mode */
+    return ERROR_INVALID_MODE;
+  return CommitFileBufferWriteSpan(bit_file_buffer->file_buffer, size);
 }
 
 #define MAX_SIZE (sizeof(io_uint_t))
 #define MAX_BIT_SIZE (8 * MAX_SIZE)
 
-/* TODO: Optimize */
 io_int_t ReadSingleValueFromBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, io_uint_t * const value, const size_t value_bit_size)
 {
+  accumulator_t temp_value;
   io_int_t ret;
-  uint8_t bytes[MAX_SIZE];
-  size_t i;
   if (value_bit_size > MAX_BIT_SIZE)
     return ERROR_INVALID_VALUE;
-  if ((ret = ReadBitFileBuffer(bit_file_buffer, bytes, value_bit_size)) != (io_int_t)value_bit_size)
+  if (bit_file_buffer->window.mode != FBM_READING) /* Only read when in reading mode */
+    return ERROR_INVALID_MODE;
+  if ((ret = ReadBits(bit_file_buffer, &temp_value, (uint8_t)value_bit_size)) != (io_int_t)value_bit_size)
     return ret;
-  *value = 0;
-  for (i = 0; i < (value_bit_size + 7) / 8; i++)
-    *value |= (io_int_t)bytes[i] << (MAX_BIT_SIZE - 8 - 8 * i);
-  *value >>= (MAX_BIT_SIZE - value_bit_size);
+  *value = (io_uint_t)temp_value;
   return value_bit_size;
 }
 
-/* TODO: Optimize */
 io_int_t WriteSingleValueToBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, const io_uint_t * const value, const size_t value_bit_size)
 {
-  const io_uint_t temp_value = *value << (MAX_BIT_SIZE - value_bit_size);
-  uint8_t bytes[MAX_SIZE];
-  size_t i;
   if (value_bit_size > MAX_BIT_SIZE)
     return ERROR_INVALID_VALUE;
-  bytes[0] = (uint8_t)(temp_value >> (MAX_BIT_SIZE - 8)); /* Treat first byte separately to avoid shifting by 64 below */
-  for (i = 1; i < (value_bit_size + 7) / 8; i++)
-    bytes[i] = (temp_value & (((io_uint_t)1 << (MAX_BIT_SIZE - 8 * i)) - 1)) >> (MAX_BIT_SIZE - 8 - 8 * i);
-  return WriteBitFileBuffer(bit_file_buffer, bytes, value_bit_size);
+  if (bit_file_buffer->window.mode != FBM_WRITING) /* Only write when in writing mode */
+    return ERROR_INVALID_MODE;
+  return WriteBits(bit_file_buffer, (accumulator_t)*value, (uint8_t)value_bit_size);
+}
+
+io_int_t ReadValuesFromBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, io_uint_t * const values, const size_t num_values, const size_t value_bit_size)
+{
+  size_t i;
+  if (value_bit_size == 0 || value_bit_size > MAX_BIT_SIZE)
+    return ERROR_INVALID_VALUE;
+  if (num_values > MAX_USABLE_SIZE / value_bit_size)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if (bit_file_buffer->window.mode != FBM_READING) /* Only read when in reading mode */
+    return ERROR_INVALID_MODE;
+  for (i = 0; i < num_values; i++)
+  {
+    accumulator_t temp_value;
+    const io_int_t ret = ReadBits(bit_file_buffer, &temp_value, (uint8_t)value_bit_size);
+    if (ret != (io_int_t)value_bit_size) /* Return number of (previously) successfully read bits, including the bits of the incomplete last value */
+      return ret < 0 ? ret : (io_int_t)(i * value_bit_size) + ret;
+    values[i] = (io_uint_t)temp_value;
+  }
+  return num_values * value_bit_size; /* Reading successful */
+}
+
+io_int_t WriteValuesToBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, const io_uint_t * const values, const size_t num_values, const size_t value_bit_size)
+{
+  size_t i;
+  if (value_bit_size == 0 || value_bit_size > MAX_BIT_SIZE)
+    return ERROR_INVALID_VALUE;
+  if (num_values > MAX_USABLE_SIZE / value_bit_size)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if (bit_file_buffer->window.mode != FBM_WRITING) /* Only write when in writing mode */
+    return ERROR_INVALID_MODE;
+  for (i = 0; i < num_values; i++)
+  {
+    const io_int_t ret = WriteBits(bit_file_buffer, (accumulator_t)values[i], (uint8_t)value_bit_size);
+    if (ret < 0)
+      return ret;
+  }
+  return num_values * value_bit_size; /* Writing successful */
 }
 
 static int FlushBitFileBufferInternal(bit_file_buffer_t * const bit_file_buffer, int WriteFractionalBytes)
 {
-  if ((!WriteFractionalBytes && bit_file_buffer->used_bits == MAX_USED_BITS) || WriteFractionalBytes) /* Write buffer (byte) */
+  int ret;
+  if ((ret = SpillAccumulator(bit_file_buffer)) != NO_ERROR)
+    return ret;
+  if (WriteFractionalBytes && bit_file_buffer->window.used_bits != 0) /* Write remaining bits (padded with zeros) */
   {
-    if (WriteFileBuffer(bit_file_buffer->file_buffer, &bit_file_buffer->byte_buffer, 1) == 1)
-      bit_file_buffer->used_bits = 0;
+    const uint8_t last_byte = (uint8_t)(bit_file_buffer->accumulator >> (ACCUMULATOR_BITS - BYTE_BITS));
+    if (WriteFileBuffer(bit_file_buffer->file_buffer, &last_byte, 1) == 1)
+    {
+      bit_file_buffer->accumulator = 0;
+      bit_file_buffer->window.used_bits = 0;
+    }
     else /* Writing was not successful => abort */
       return ERROR_FILE_IO;
   }
@@ -321,14 +472,29 @@ static int FlushBitFileBufferInternal(bit_file_buffer_t * const bit_file_buffer,
 
 int FlushBitFileBuffer(bit_file_buffer_t * const bit_file_buffer)
 {
-  if (GetFileBufferMode(bit_file_buffer->file_buffer) != FBM_WRITING) /* Only flush when in writing mode */
+  if (bit_file_buffer->window.mode != FBM_WRITING) /* Only flush when in writing mode */
     return ERROR_INVALID_MODE;
   return FlushBitFileBufferInternal(bit_file_buffer, 0);
 }
 
+int CloseBitFileBufferPipe(bit_file_buffer_t * const bit_file_buffer)
+{
+  int ret;
+  if (bit_file_buffer->window.mode == FBM_WRITING) /* Pass left-over bits (less than one byte) on instead of padding them */
+  {
+    const int spill_ret = SpillAccumulator(bit_file_buffer);
+    if ((ret = CloseFileBufferPipe(bit_file_buffer->file_buffer, (uint8_t)(bit_file_buffer->accumulator >> (ACCUMULATOR_BITS - BYTE_BITS)), spill_ret == NO_ERROR ? bit_file_buffer->window.used_bits : 0)) != NO_ERROR)
+      return ret;
+    bit_file_buffer->accumulator = 0;
+    bit_file_buffer->window.used_bits = 0;
+    return spill_ret;
+  }
+  return CloseFileBufferPipe(bit_file_buffer->file_buffer, 0, 0);
+}
+
 void UninitBitFileBuffer(bit_file_buffer_t * const bit_file_buffer)
 {
-  if (GetFileBufferMode(bit_file_buffer->file_buffer) == FBM_WRITING)
+  if (bit_file_buffer->window.mode == FBM_WRITING)
     FlushBitFileBufferInternal(bit_file_buffer, 1); /* Ignore result */
 }
 
@@ -337,15 +503,16 @@ int ClearBitFileBuffer(bit_file_buffer_t * const bit_file_buffer)
   int ret;
   if ((ret = ClearFileBuffer(bit_file_buffer->file_buffer)) != NO_ERROR)
     return ret;
-  ResetBufferByte(bit_file_buffer);
+  ResetAccumulator(bit_file_buffer);
   return NO_ERROR;
-} 
+}
 
 int ResetBitFileBuffer(bit_file_buffer_t * const bit_file_buffer, const file_buffer_mode_t mode)
 {
   int ret;
   if ((ret = ResetFileBuffer(bit_file_buffer->file_buffer, mode)) != NO_ERROR)
     return ret;
+  bit_file_buffer->window.mode = mode;
   if ((ret = ClearBitFileBuffer(bit_file_buffer)) != NO_ERROR)
     return ret;
   return NO_ERROR;
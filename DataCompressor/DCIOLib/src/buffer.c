@@ -4,49 +4,208 @@
 
 #include "err_codes.h"
 #include "buffer.h"
+#include "allocation.h"
 
 #include <string.h>
 
+typedef struct chunk_t
+{
+  struct chunk_t *next;
+  uint8_t *data; /* Points directly behind the chunk header */
+  size_t size;
+  size_t start, end; /* Used bytes are [start, end) */
+} chunk_t;
+
+struct chunk_pool_t
+{
+  size_t chunk_size;
+  chunk_t *free_chunks; /* Released chunks for reuse (at least chunk_size bytes each) */
+};
+
 struct buffer_t
 {
   uint8_t *buffer;
-  size_t buffer_size;
-  io_int_t buffer_start;
-  io_int_t buffer_end;
+  size_t buffer_size; /* Sum of all chunk sizes in chunked mode */
+  size_t buffer_start; /* Index of the first used byte */
+  size_t used_size; /* Number of used bytes */
+  int ring; /* Ring buffer mode: used bytes may wrap around the end of the buffer */
+  chunk_pool_t *chunk_pool; /* Chunked mode (if not NULL): used bytes are stored in a list of chunks from this pool */
+  chunk_t *first_chunk, *last_chunk; /* Only the last chunk is written to. The first chunk is only empty if it is the only one */
 };
 
+chunk_pool_t *AllocateChunkPool(void)
+{
+  return (chunk_pool_t*)AllocateMemory(sizeof(chunk_pool_t));
+}
+
+void FreeChunkPool(chunk_pool_t * const chunk_pool)
+{
+  FreeMemory(chunk_pool);
+}
+
+int InitChunkPool(chunk_pool_t * const chunk_pool, const size_t chunk_size)
+{
+  if (chunk_size <= 0)
+    return ERROR_INVALID_VALUE;
+  if (chunk_size > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  chunk_pool->chunk_size = chunk_size;
+  chunk_pool->free_chunks = NULL;
+  return NO_ERROR;
+}
+
+void UninitChunkPool(chunk_pool_t * const chunk_pool)
+{
+  while (chunk_pool->free_chunks != NULL)
+  {
+    chunk_t * const chunk = chunk_pool->free_chunks;
+    chunk_pool->free_chunks = chunk->next;
+    FreeMemory(chunk);
+  }
+}
+
+static chunk_t *AcquireChunk(chunk_pool_t * const chunk_pool, const size_t min_size)
+{
+  chunk_t *chunk;
+  if (chunk_pool->free_chunks != NULL && chunk_pool->free_chunks->size >= min_size) /* Reuse released chunk */
+  {
+    chunk = chunk_pool->free_chunks;
+    chunk_pool->free_chunks = chunk->next;
+  }
+  else
+  {
+    const size_t size = min_size > chunk_pool->chunk_size ? min_size : chunk_pool->chunk_size; /* Oversized chunks are only used for large reservations */
+    if ((chunk = (chunk_t*)AllocateMemory(sizeof(chunk_t) + size)) == NULL)
+      return NULL;
+    chunk->data = (uint8_t*)(chunk + 1);
+    chunk->size = size;
+  }
+  chunk->next = NULL;
+  chunk->start = chunk->end = 0;
+  return chunk;
+}
+
+static void ReleaseChunk(chunk_pool_t * const chunk_pool, chunk_t * const chunk) /* Released chunks remain valid until they are reused */
+{
+  chunk->next = chunk_pool->free_chunks;
+  chunk_pool->free_chunks = chunk;
+}
+
+static int AppendChunk(buffer_t * const buffer, const size_t min_size)
+{
+  chunk_t *chunk;
+  if (buffer->last_chunk != NULL && buffer->first_chunk == buffer->last_chunk && buffer->last_chunk->start == buffer->last_chunk->end) /* Replace empty only chunk instead of leaving it in the list */
+  {
+    buffer->buffer_size -= buffer->last_chunk->size;
+    ReleaseChunk(buffer->chunk_pool, buffer->last_chunk);
+    buffer->first_chunk = buffer->last_chunk = NULL;
+  }
+  if ((chunk = AcquireChunk(buffer->chunk_pool, min_size)) == NULL)
+    return ERROR_MEMORY;
+  if (buffer->last_chunk != NULL)
+    buffer->last_chunk->next = chunk;
+  else
+    buffer->first_chunk = chunk;
+  buffer->last_chunk = chunk;
+  buffer->buffer_size += chunk->size;
+  return NO_ERROR;
+}
+
+static void ConsumeChunks(buffer_t * const buffer, size_t size)
+{
+  buffer->used_size -= size;
+  while (size > 0 || (buffer->first_chunk != buffer->last_chunk && buffer->first_chunk->start == buffer->first_chunk->end)) /* Also release empty chunks (from empty commits) so that the first chunk is never empty unless it is the last one */
+  {
+    chunk_t * const chunk = buffer->first_chunk;
+    const size_t chunk_used_size = chunk->end - chunk->start;
+    const size_t consumed_size = chunk_used_size < size ? chunk_used_size : size;
+    chunk->start += consumed_size;
+    size -= consumed_size;
+    if (chunk->start == chunk->end)
+    {
+      if (chunk == buffer->last_chunk) /* Keep the last chunk for writing */
+      {
+        chunk->start = chunk->end = 0;
+        break;
+      }
+      buffer->first_chunk = chunk->next; /* Release consumed chunk */
+      buffer->buffer_size -= chunk->size;
+      ReleaseChunk(buffer->chunk_pool, chunk);
+    }
+  }
+}
+
+static void ReleaseAllChunks(buffer_t * const buffer)
+{
+  while (buffer->first_chunk != NULL)
+  {
+    chunk_t * const chunk = buffer->first_chunk;
+    buffer->first_chunk = chunk->next;
+    ReleaseChunk(buffer->chunk_pool, chunk);
+  }
+  buffer->last_chunk = NULL;
+  buffer->buffer_size = 0;
+}
+
 buffer_t *AllocateBuffer(void)
 {
-  return (buffer_t*)malloc(sizeof(buffer_t));
+  return (buffer_t*)AllocateMemory(sizeof(buffer_t));
 }
 
 void FreeBuffer(buffer_t * const buffer)
 {
-  free(buffer);
+  FreeMemory(buffer);
 }
 
 void ClearBuffer(buffer_t * const buffer)
 {
+  if (buffer->chunk_pool != NULL) /* Return chunks to the pool so that other buffers can reuse them */
+    ReleaseAllChunks(buffer);
   buffer->buffer_start = 0;
-  buffer->buffer_end = -1;
+  buffer->used_size = 0;
 }
 
-int InitBuffer(buffer_t * const buffer, const size_t buffer_size)
+static int InitBufferInternal(buffer_t * const buffer, const size_t buffer_size, const int ring)
 {
   if (buffer_size <= 0)
     return ERROR_INVALID_VALUE;
   if (buffer_size > MAX_USABLE_SIZE)
     return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
   buffer->buffer_size = buffer_size;
-  if ((buffer->buffer = (uint8_t*)malloc(sizeof(uint8_t) * buffer_size)) == NULL)
+  if ((buffer->buffer = (uint8_t*)AllocateMemory(sizeof(uint8_t) * buffer_size)) == NULL)
     return ERROR_MEMORY;
+  buffer->ring = ring;
+  buffer->chunk_pool = NULL;
+  ClearBuffer(buffer);
+  return NO_ERROR;
+}
+
+int InitBuffer(buffer_t * const buffer, const size_t buffer_size)
+{
+  return InitBufferInternal(buffer, buffer_size, 0);
+}
+
+int InitRingBuffer(buffer_t * const buffer, const size_t buffer_size)
+{
+  return InitBufferInternal(buffer, buffer_size, 1);
+}
+
+int InitChunkedBuffer(buffer_t * const buffer, chunk_pool_t * const chunk_pool)
+{
+  buffer->buffer = NULL;
+  buffer->buffer_size = 0;
+  buffer->ring = 0;
+  buffer->chunk_pool = chunk_pool;
+  buffer->first_chunk = buffer->last_chunk = NULL;
   ClearBuffer(buffer);
   return NO_ERROR;
 }
 
 void UninitBuffer(buffer_t * const buffer)
 {
-  free(buffer->buffer);
+  if (buffer->chunk_pool != NULL)
+    ReleaseAllChunks(buffer);
+  FreeMemory(buffer->buffer);
 }
 
 size_t GetBufferSize(const buffer_t * const buffer)
@@ -56,95 +215,301 @@ size_t GetBufferSize(const buffer_t * const buffer)
 
 io_int_t GetUsedBufferSize(const buffer_t * const buffer)
 {
-  return buffer->buffer_end - buffer->buffer_start + 1;
+  return (io_int_t)buffer->used_size;
+}
+
+static size_t GetBufferIndex(const buffer_t * const buffer, const size_t offset) /* Index of the byte offset bytes after the first used byte */
+{
+  const size_t index = buffer->buffer_start + offset;
+  return index >= buffer->buffer_size ? index - buffer->buffer_size : index; /* Only wraps in ring buffer mode */
+}
+
+static void AdvanceBufferStart(buffer_t * const buffer, const size_t size)
+{
+  buffer->used_size -= size;
+  buffer->buffer_start = buffer->used_size == 0 ? 0 : GetBufferIndex(buffer, size); /* Start over at the beginning when empty to keep segments large */
+}
+
+static size_t GetUsedSegments(const buffer_t * const buffer, const size_t max_size, size_t * const second_size) /* Returns the size of the first segment */
+{
+  const size_t size = buffer->used_size < max_size ? buffer->used_size : max_size;
+  const size_t first_size = buffer->buffer_size - buffer->buffer_start < size ? buffer->buffer_size - buffer->buffer_start : size; /* Can only be smaller than size in ring buffer mode */
+  *second_size = size - first_size;
+  return first_size;
 }
 
 int ResizeBuffer(buffer_t * const buffer, const size_t new_buffer_size)
 {
   uint8_t *new_buf;
-  io_int_t old_used_size = buffer->buffer_end - buffer->buffer_start + 1;
-  if (new_buffer_size <= 0)
+  const size_t old_used_size = buffer->used_size;
+  if (buffer->chunk_pool != NULL) /* Chunks are added when writing */
+    return NO_ERROR;
+  if (new_buffer_size <= 0 || new_buffer_size < old_used_size)
     return ERROR_INVALID_VALUE;
   if (new_buffer_size > MAX_USABLE_SIZE)
     return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
-  if ((new_buf = (uint8_t*)malloc(sizeof(uint8_t) * new_buffer_size)) == NULL)
-    return ERROR_MEMORY;
-  memcpy(new_buf, &buffer->buffer[buffer->buffer_start], (size_t)old_used_size); /* Copy old data */
-  free(buffer->buffer);
+  if (buffer->buffer_start == 0) /* The used bytes are at the start of the buffer, i.e., reallocating keeps them and avoids copying if the buffer can be extended in place */
+  {
+    if ((new_buf = (uint8_t*)ReallocateMemory(buffer->buffer, sizeof(uint8_t) * new_buffer_size)) == NULL)
+      return ERROR_MEMORY;
+  }
+  else
+  {
+    if ((new_buf = (uint8_t*)AllocateMemory(sizeof(uint8_t) * new_buffer_size)) == NULL)
+      return ERROR_MEMORY;
+    PeekBuffer(buffer, new_buf, old_used_size); /* Copy old data */
+    FreeMemory(buffer->buffer);
+  }
   buffer->buffer = new_buf;
   buffer->buffer_size = new_buffer_size;
   buffer->buffer_start = 0;
-  buffer->buffer_end = old_used_size - 1;
+  return NO_ERROR;
+}
+
+static int RefillRingBuffer(buffer_t * const buffer, refill_function_t * const refill_func, void * const caller_info)
+{
+  while (buffer->used_size < buffer->buffer_size) /* Refill free segments after and (when wrapping around) before the used bytes */
+  {
+    const size_t free_start = GetBufferIndex(buffer, buffer->used_size);
+    const size_t free_end = free_start < buffer->buffer_start ? buffer->buffer_start : buffer->buffer_size;
+    const io_int_t size = (*refill_func)(&buffer->buffer[free_start], free_end - free_start, caller_info);
+    if (size > 0)
+      buffer->used_size += (size_t)size;
+    else
+      return (int)size; /* Return signalled error */
+    if ((size_t)size != free_end - free_start) /* No more data available at the moment */
+      break;
+  }
   return NO_ERROR;
 }
 
 int RefillBuffer(buffer_t * const buffer, refill_function_t * const refill_func, void * const caller_info)
 {
-  size_t i;
-  const io_int_t old_size = GetUsedBufferSize(buffer);
-  for (i = 0; i < (size_t)old_size; i++)
-    buffer->buffer[i] = buffer->buffer[buffer->buffer_start + i];
-  buffer->buffer_start = 0;
-  buffer->buffer_end = old_size - 1;
+  if (buffer->chunk_pool != NULL) /* Chunked buffers are not refilled since they would grow without bounds */
+    return refill_func != NULL ? ERROR_INVALID_MODE : NO_ERROR;
+  if (buffer->ring)
+    return refill_func != NULL ? RefillRingBuffer(buffer, refill_func, caller_info) : NO_ERROR;
+  if (buffer->buffer_start != 0) /* Move remaining data to the beginning of the buffer */
+  {
+    memmove(&buffer->buffer[0], &buffer->buffer[buffer->buffer_start], buffer->used_size);
+    buffer->buffer_start = 0;
+  }
   if (refill_func != NULL)
   {
-    const io_int_t size = (*refill_func)(&buffer->buffer[buffer->buffer_end + 1], (size_t)(buffer->buffer_size - old_size), caller_info);
+    const io_int_t size = (*refill_func)(&buffer->buffer[buffer->used_size], buffer->buffer_size - buffer->used_size, caller_info);
     if (size > 0)
-      buffer->buffer_end += size;
+      buffer->used_size += (size_t)size;
     else
       return (int)size; /* Return signalled error */
   }
   return NO_ERROR;
 }
 
+static io_int_t PeekChunks(const buffer_t * const buffer, uint8_t * const output, const size_t output_size)
+{
+  const chunk_t *chunk;
+  size_t size = 0;
+  for (chunk = buffer->first_chunk; chunk != NULL && size < output_size; chunk = chunk->next)
+  {
+    const size_t chunk_used_size = chunk->end - chunk->start;
+    const size_t copy_size = chunk_used_size < output_size - size ? chunk_used_size : output_size - size;
+    memcpy(output + size, &chunk->data[chunk->start], copy_size);
+    size += copy_size;
+  }
+  return (io_int_t)size;
+}
+
 io_int_t PeekBuffer(const buffer_t * const buffer, uint8_t * const output, const size_t output_size)
 {
-  const io_int_t size = GetUsedBufferSize(buffer) < (io_int_t)output_size ? GetUsedBufferSize(buffer) : (io_int_t)output_size;
+  size_t first_size, second_size;
   if (output_size > MAX_USABLE_SIZE)
-    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;  
-  memcpy(output, &buffer->buffer[buffer->buffer_start], (size_t)size);
-  return size;
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if (buffer->chunk_pool != NULL)
+    return PeekChunks(buffer, output, output_size);
+  first_size = GetUsedSegments(buffer, output_size, &second_size);
+  memcpy(output, &buffer->buffer[buffer->buffer_start], first_size);
+  if (second_size != 0)
+    memcpy(output + first_size, &buffer->buffer[0], second_size);
+  return (io_int_t)(first_size + second_size);
+}
+
+io_int_t PeekBufferSegments(const buffer_t * const buffer, const size_t max_size, const uint8_t ** const first, size_t * const first_size, const uint8_t ** const second, size_t * const second_size)
+{
+  if (max_size > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if (buffer->chunk_pool != NULL) /* Used bytes of the first two chunks */
+  {
+    const chunk_t * const first_chunk = buffer->first_chunk;
+    const chunk_t * const second_chunk = first_chunk != NULL ? first_chunk->next : NULL;
+    const size_t first_used_size = first_chunk != NULL ? first_chunk->end - first_chunk->start : 0;
+    const size_t second_used_size = second_chunk != NULL ? second_chunk->end - second_chunk->start : 0;
+    *first_size = first_used_size < max_size ? first_used_size : max_size;
+    *second_size = second_used_size < max_size - *first_size ? second_used_size : max_size - *first_size;
+    *first = first_chunk != NULL ? &first_chunk->data[first_chunk->start] : NULL;
+    *second = second_chunk != NULL ? &second_chunk->data[second_chunk->start] : NULL;
+    return (io_int_t)(*first_size + *second_size);
+  }
+  *first_size = GetUsedSegments(buffer, max_size, second_size);
+  *first = &buffer->buffer[buffer->buffer_start];
+  *second = &buffer->buffer[0];
+  return (io_int_t)(*first_size + *second_size);
 }
 
 io_int_t ReadBuffer(buffer_t * const buffer, uint8_t * const output, const size_t output_size)
 {
   const io_int_t size = PeekBuffer(buffer, output, output_size);
   if (size > 0)
-    buffer->buffer_start += size;
+  {
+    if (buffer->chunk_pool != NULL)
+      ConsumeChunks(buffer, (size_t)size);
+    else
+      AdvanceBufferStart(buffer, (size_t)size);
+  }
+  return size;
+}
+
+io_int_t ReadBufferSegments(buffer_t * const buffer, const size_t max_size, const uint8_t ** const first, size_t * const first_size, const uint8_t ** const second, size_t * const second_size)
+{
+  const io_int_t size = PeekBufferSegments(buffer, max_size, first, first_size, second, second_size);
+  if (size > 0)
+  {
+    if (buffer->chunk_pool != NULL) /* Released chunks remain valid until they are reused by the next write operation */
+      ConsumeChunks(buffer, (size_t)size);
+    else
+    {
+      buffer->buffer_start = GetBufferIndex(buffer, (size_t)size); /* Segments remain valid until the next write or refill operation */
+      buffer->used_size -= (size_t)size;
+    }
+  }
   return size;
 }
 
 int FlushBuffer(buffer_t * const buffer, flush_function_t * const flush_func, void * const caller_info)
 {
-  if (flush_func != NULL)
+  if (flush_func != NULL && buffer->chunk_pool != NULL)
+  {
+    while (buffer->used_size > 0) /* Flush chunk by chunk */
+    {
+      chunk_t * const chunk = buffer->first_chunk;
+      const size_t chunk_used_size = chunk->end - chunk->start;
+      const io_int_t size = (*flush_func)(&chunk->data[chunk->start], chunk_used_size, caller_info);
+      if (size > 0)
+        ConsumeChunks(buffer, (size_t)size);
+      if (size != (io_int_t)chunk_used_size)
+        break;
+    }
+  }
+  else if (flush_func != NULL)
   {
-    const io_int_t old_size = GetUsedBufferSize(buffer);
-    if (old_size > 0)
+    size_t first_size, second_size;
+    first_size = GetUsedSegments(buffer, buffer->used_size, &second_size);
+    if (first_size > 0)
     {
-      const io_int_t size = (*flush_func)(&buffer->buffer[buffer->buffer_start], (size_t)old_size, caller_info);
+      io_int_t size = (*flush_func)(&buffer->buffer[buffer->buffer_start], first_size, caller_info);
       if (size > 0)
-        buffer->buffer_start += size;
-      return NO_ERROR;
+        AdvanceBufferStart(buffer, (size_t)size);
+      if (size == (io_int_t)first_size && second_size > 0) /* Flush wrapped-around data as well */
+      {
+        size = (*flush_func)(&buffer->buffer[0], second_size, caller_info);
+        if (size > 0)
+          AdvanceBufferStart(buffer, (size_t)size);
+      }
     }
   }
   return NO_ERROR;
 }
 
+io_int_t ReserveBuffer(buffer_t * const buffer, uint8_t ** const span, const size_t min_size)
+{
+  size_t free_start;
+  if (buffer->chunk_pool != NULL) /* Start a new chunk if the free bytes of the last chunk are too few */
+  {
+    const size_t required_size = min_size > 0 ? min_size : 1;
+    if (required_size > MAX_USABLE_SIZE)
+      return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+    if (buffer->last_chunk == NULL || buffer->last_chunk->size - buffer->last_chunk->end < required_size)
+    {
+      int ret;
+      if ((ret = AppendChunk(buffer, required_size)) != NO_ERROR)
+        return ret;
+    }
+    *span = &buffer->last_chunk->data[buffer->last_chunk->end];
+    return (io_int_t)(buffer->last_chunk->size - buffer->last_chunk->end);
+  }
+  if (buffer->used_size == buffer->buffer_size) /* Full */
+  {
+    *span = NULL;
+    return 0;
+  }
+  if (buffer->used_size == 0) /* Start over at the beginning to provide the largest possible span */
+    buffer->buffer_start = 0;
+  else if (!buffer->ring && buffer->buffer_start != 0) /* Move remaining data to the beginning of the buffer so that all free bytes are contiguous */
+  {
+    memmove(&buffer->buffer[0], &buffer->buffer[buffer->buffer_start], buffer->used_size);
+    buffer->buffer_start = 0;
+  }
+  free_start = GetBufferIndex(buffer, buffer->used_size);
+  *span = &buffer->buffer[free_start];
+  return (io_int_t)((free_start < buffer->buffer_start ? buffer->buffer_start : buffer->buffer_size) - free_start);
+}
+
+int CommitBuffer(buffer_t * const buffer, const size_t size)
+{
+  if (buffer->chunk_pool != NULL)
+  {
+    if (buffer->last_chunk == NULL || size > buffer->last_chunk->size - buffer->last_chunk->end)
+      return ERROR_INVALID_VALUE;
+    buffer->last_chunk->end += size;
+    buffer->used_size += size;
+    return NO_ERROR;
+  }
+  if (size > buffer->buffer_size - buffer->used_size)
+    return ERROR_INVALID_VALUE;
+  buffer->used_size += size;
+  return NO_ERROR;
+}
+
+static io_int_t WriteChunks(buffer_t * const buffer, const uint8_t * const input, const size_t input_size)
+{
+  size_t written = 0;
+  while (written < input_size)
+  {
+    size_t size;
+    if (buffer->last_chunk == NULL || buffer->last_chunk->end == buffer->last_chunk->size) /* Add chunk when full */
+    {
+      if (AppendChunk(buffer, 1) != NO_ERROR)
+        break; /* Report the number of bytes written so far */
+    }
+    size = buffer->last_chunk->size - buffer->last_chunk->end;
+    if (size > input_size - written)
+      size = input_size - written;
+    memcpy(&buffer->last_chunk->data[buffer->last_chunk->end], input + written, size);
+    buffer->last_chunk->end += size;
+    buffer->used_size += size;
+    written += size;
+  }
+  return (io_int_t)written;
+}
+
 io_int_t WriteBuffer(buffer_t * const buffer, const uint8_t * const input, const size_t input_size)
 {
-  const io_int_t old_size = GetUsedBufferSize(buffer);
-  const io_int_t free_size = GetBufferSize(buffer) - old_size;
-  const size_t size = (size_t)(free_size < (io_int_t)input_size ? free_size : (io_int_t)input_size);
+  const size_t free_size = buffer->buffer_size - buffer->used_size;
+  const size_t size = free_size < input_size ? free_size : input_size;
+  size_t free_start, first_size;
   if (input_size > MAX_USABLE_SIZE)
     return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
-  if (buffer->buffer_end + size >= buffer->buffer_size) /* Make sure that there is no index overflow */
+  if (buffer->chunk_pool != NULL)
+    return WriteChunks(buffer, input, input_size);
+  if (!buffer->ring && buffer->buffer_start + buffer->used_size + size > buffer->buffer_size) /* Make sure that there is no index overflow */
   {
-    if (old_size > 0)
-      memcpy(&buffer->buffer[0], &buffer[buffer->buffer_start], (size_t)old_size); /* Move elements backwards (this would not be necessary if a ring buffer was used) */
+    memmove(&buffer->buffer[0], &buffer->buffer[buffer->buffer_start], buffer->used_size); /* Move elements backwards (not necessary in ring buffer mode) */
     buffer->buffer_start = 0;
-    buffer->buffer_end = old_size - 1;
   }
-  memcpy(&buffer->buffer[buffer->buffer_end + 1], input, size);
-  buffer->buffer_end += size;
-  return size;
-}
+  free_start = GetBufferIndex(buffer, buffer->used_size);
+  first_size = buffer->buffer_size - free_start < size ? buffer->buffer_size - free_start : size; /* Can only be smaller than size in ring buffer mode */
+  memcpy(&buffer->buffer[free_start], input, first_size);
+  if (first_size != size) /* Wrap around */
+    memcpy(&buffer->buffer[0], input + first_size, size - first_size);
+  buffer->used_size += size;
+  return (io_int_t)size;
+}
\ No newline at end of file
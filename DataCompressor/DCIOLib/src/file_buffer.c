@@ -4,31 +4,91 @@
 
 #include "err_codes.h"
 #include "file_buffer.h"
+#include "allocation.h"
+#include "thread.h"
 
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+  #define FILE_BUFFER_MMAP /* Memory-mapped input files are only supported on POSIX systems */
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
 
 typedef enum file_buffer_type_t
 {
   FBT_FILE = 0,
-  FBT_MEMORY = 1
+  FBT_MEMORY = 1,
+  FBT_MMAP = 2,
+  FBT_PREFETCH = 3,
+  FBT_WRITE_BEHIND = 4,
+  FBT_SPILLED = 5, /* In-memory buffer whose data has been moved to a temporary file */
+  FBT_PIPE = 6
 } file_buffer_type_t;
 
+#define NUM_PREFETCH_BLOCKS 2 /* Double buffering */
+#define NUM_WRITE_BEHIND_BLOCKS 4 /* Allow several blocks to be in flight while the worker is writing */
+
+typedef struct worker_t /* Blocks shared with a worker thread which reads ahead (FBT_PREFETCH) or writes behind (FBT_WRITE_BEHIND) */
+{
+  thread_t thread;
+  mutex_t mutex; /* Protects the queue state below */
+  mutex_t file_mutex; /* Held by the worker while reading from the file */
+  condition_t condition;
+  uint8_t **blocks;
+  size_t *block_used; /* Number of used bytes in each block */
+  size_t num_blocks, block_size;
+  size_t queue_start, queue_size; /* Blocks which have been read by the worker (reading) or which are to be written by the worker (writing) in queue order */
+  size_t block_offset; /* Offset in the block currently being consumed (reading) or filled (writing) by the caller (only accessed by the caller) */
+  int stop; /* Asks the worker to stop */
+  int error; /* Writing a block failed */
+  io_int_t start_offset; /* File offset at initialization (only accessed by the caller) */
+  io_int_t transferred; /* Number of bytes transferred from or to the internal buffer (only accessed by the caller) */
+} worker_t;
+
+struct file_buffer_pipe_t /* Bounded queue of blocks between a writing and a reading file buffer which are used by different threads */
+{
+  mutex_t mutex; /* Protects the queue state and flags below */
+  condition_t condition;
+  uint8_t **blocks;
+  size_t *block_used; /* Number of used bytes in each queued block */
+  size_t num_blocks, block_size;
+  size_t queue_start, queue_size; /* Blocks which have been filled by the writer, but not yet completely read by the reader, in queue order */
+  size_t write_offset; /* Offset in the block currently being filled (only accessed by the writer) */
+  size_t read_offset; /* Offset in the first queued block (only accessed by the reader) */
+  int writer_closed; /* No more blocks will be queued */
+  int reader_closed; /* No more blocks will be read, i.e., further data is discarded */
+  uint8_t trailing_byte, trailing_bits; /* Left-over bits after the last byte (valid when writer_closed is set) */
+  io_int_t written; /* Number of bytes written to the pipe (only accessed by the writer) */
+  io_int_t read; /* Number of bytes read from the pipe (only accessed by the reader) */
+};
+
 struct file_buffer_t
 {
   FILE *base_file;
-  buffer_t *io_buffer;
+  buffer_t *io_buffer; /* NULL for FBT_MMAP */
   file_buffer_mode_t mode;
   file_buffer_type_t type;
+  uint8_t *mapping; /* Read-only mapping of the whole file or caller memory without base file, which is written to in writing mode (FBT_MMAP only) */
+  size_t mapping_size;
+  size_t mapping_offset;
+  worker_t *worker; /* Read-ahead or write-behind state (FBT_PREFETCH and FBT_WRITE_BEHIND only) */
+  file_buffer_pipe_t *pipe; /* FBT_PIPE only */
+  size_t memory_budget; /* Maximum number of bytes to be buffered in memory before spilling to a temporary file (FBT_MEMORY and FBT_SPILLED only, 0 means unlimited) */
+  size_t spill_buffer_size; /* Size of the buffer for the temporary file */
+  size_t memory_buffer_size; /* Initial size of the in-memory buffer to be restored after spilling */
+  chunk_pool_t *chunk_pool; /* Chunk pool of the in-memory buffer to be restored after spilling (NULL for linear buffers) */
 };
 
 file_buffer_t *AllocateFileBuffer(void)
 {
-  return (file_buffer_t*)malloc(sizeof(file_buffer_t));
+  return (file_buffer_t*)AllocateMemory(sizeof(file_buffer_t));
 }
 
 void FreeFileBuffer(file_buffer_t * const file_buffer)
 {
-  free(file_buffer);
+  FreeMemory(file_buffer);
 }
 
 static io_int_t RefillFromFile(void * const buffer_addr, const size_t max_bytes, void * const caller_info)
@@ -38,9 +98,122 @@ static io_int_t RefillFromFile(void * const buffer_addr, const size_t max_bytes,
   return (io_int_t)fread(buffer_addr, sizeof(uint8_t), max_bytes, ((file_buffer_t * const)caller_info)->base_file);
 }
 
+static void ReadAheadFromFile(void * const caller_info)
+{
+  file_buffer_t * const file_buffer = (file_buffer_t * const)caller_info;
+  worker_t * const worker = file_buffer->worker;
+  LockMutex(&worker->mutex);
+  while (!worker->stop)
+  {
+    size_t block, read;
+    if (worker->queue_size == worker->num_blocks) /* Wait until the caller has consumed a block */
+    {
+      WaitCondition(&worker->condition, &worker->mutex);
+      continue;
+    }
+    block = (worker->queue_start + worker->queue_size) % worker->num_blocks; /* Remains the same while the caller consumes blocks */
+    UnlockMutex(&worker->mutex); /* Read without blocking the caller */
+    LockMutex(&worker->file_mutex);
+    read = fread(worker->blocks[block], sizeof(uint8_t), worker->block_size, file_buffer->base_file);
+    UnlockMutex(&worker->file_mutex);
+    LockMutex(&worker->mutex);
+    worker->block_used[block] = read;
+    worker->queue_size++;
+    SignalCondition(&worker->condition);
+    if (read != worker->block_size) /* EOF or read error => the partially filled block is the last one */
+      break;
+  }
+  UnlockMutex(&worker->mutex);
+}
+
+static io_int_t RefillFromReadAhead(void * const buffer_addr, const size_t max_bytes, void * const caller_info)
+{
+  worker_t * const worker = ((file_buffer_t * const)caller_info)->worker;
+  uint8_t * const output = (uint8_t * const)buffer_addr;
+  size_t copied = 0;
+  if (max_bytes > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  LockMutex(&worker->mutex);
+  while (copied < max_bytes)
+  {
+    const size_t block = worker->queue_start;
+    size_t size;
+    if (worker->queue_size == 0)
+    {
+      if (copied != 0) /* Return what is available instead of waiting for the next block */
+        break;
+      WaitCondition(&worker->condition, &worker->mutex);
+      continue;
+    }
+    size = worker->block_used[block] - worker->block_offset;
+    if (size > max_bytes - copied)
+      size = max_bytes - copied;
+    memcpy(output + copied, worker->blocks[block] + worker->block_offset, size);
+    copied += size;
+    worker->block_offset += size;
+    if (worker->block_offset == worker->block_used[block])
+    {
+      if (worker->block_used[block] != worker->block_size) /* Last block (EOF) is never handed back */
+        break;
+      worker->queue_start = (block + 1) % worker->num_blocks; /* Hand the block back to the worker */
+      worker->queue_size--;
+      worker->block_offset = 0;
+      SignalCondition(&worker->condition);
+    }
+  }
+  worker->transferred += (io_int_t)copied;
+  UnlockMutex(&worker->mutex);
+  return (io_int_t)copied;
+}
+
+static io_int_t RefillFromPipe(void * const buffer_addr, const size_t max_bytes, void * const caller_info)
+{
+  file_buffer_pipe_t * const pipe = ((file_buffer_t * const)caller_info)->pipe;
+  size_t block, size;
+  if (max_bytes > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  LockMutex(&pipe->mutex);
+  while (pipe->queue_size == 0 && !pipe->writer_closed) /* Wait until the writer has filled a block */
+    WaitCondition(&pipe->condition, &pipe->mutex);
+  if (pipe->queue_size == 0) /* Closed and empty => EOF */
+  {
+    UnlockMutex(&pipe->mutex);
+    return 0;
+  }
+  block = pipe->queue_start;
+  size = pipe->block_used[block] - pipe->read_offset;
+  UnlockMutex(&pipe->mutex); /* The first queued block is not accessed by the writer until it is handed back */
+  if (size > max_bytes)
+    size = max_bytes;
+  memcpy(buffer_addr, pipe->blocks[block] + pipe->read_offset, size);
+  pipe->read_offset += size;
+  pipe->read += (io_int_t)size;
+  if (pipe->read_offset == pipe->block_used[block]) /* Hand the block back to the writer */
+  {
+    LockMutex(&pipe->mutex);
+    pipe->queue_start = (block + 1) % pipe->num_blocks;
+    pipe->queue_size--;
+    pipe->read_offset = 0;
+    SignalCondition(&pipe->condition);
+    UnlockMutex(&pipe->mutex);
+  }
+  return (io_int_t)size;
+}
+
 static int RefillBufferFromFile(file_buffer_t * const file_buffer)
 {
-  return RefillBuffer(file_buffer->io_buffer, file_buffer->type == FBT_FILE ? &RefillFromFile : NULL, file_buffer);
+  switch (file_buffer->type)
+  {
+    case FBT_FILE:
+    case FBT_SPILLED:
+      return RefillBuffer(file_buffer->io_buffer, &RefillFromFile, file_buffer);
+    case FBT_PREFETCH:
+      return RefillBuffer(file_buffer->io_buffer, &RefillFromReadAhead, file_buffer);
+    case FBT_PIPE:
+      return RefillBuffer(file_buffer->io_buffer, &RefillFromPipe, file_buffer);
+    default:
+      return RefillBuffer(file_buffer->io_buffer, NULL, file_buffer);
+  }
 }
 
 static io_int_t FlushToFile(const void * const buffer_addr, const size_t num_bytes, void * const caller_info)
@@ -50,28 +223,169 @@ static io_int_t FlushToFile(const void * const buffer_addr, const size_t num_byt
   return (io_int_t)fwrite(buffer_addr, sizeof(uint8_t), num_bytes, ((file_buffer_t * const)caller_info)->base_file);
 }
 
+static void WriteBehindToFile(void * const caller_info)
+{
+  file_buffer_t * const file_buffer = (file_buffer_t * const)caller_info;
+  worker_t * const worker = file_buffer->worker;
+  LockMutex(&worker->mutex);
+  while (worker->queue_size != 0 || !worker->stop) /* Write all queued blocks before stopping */
+  {
+    const size_t block = worker->queue_start;
+    const int discard = worker->error;
+    size_t written = 0;
+    if (worker->queue_size == 0) /* Wait until the caller has filled a block */
+    {
+      WaitCondition(&worker->condition, &worker->mutex);
+      continue;
+    }
+    UnlockMutex(&worker->mutex); /* Write without blocking the caller */
+    if (!discard) /* Blocks after a failed write are discarded */
+      written = fwrite(worker->blocks[block], sizeof(uint8_t), worker->block_used[block], file_buffer->base_file);
+    LockMutex(&worker->mutex);
+    if (written != worker->block_used[block])
+      worker->error = 1;
+    worker->queue_start = (block + 1) % worker->num_blocks; /* Hand the block back to the caller */
+    worker->queue_size--;
+    SignalCondition(&worker->condition);
+  }
+  UnlockMutex(&worker->mutex);
+}
+
+static void QueueWriteBehindBlock(worker_t * const worker) /* Hands the block filled by the caller to the worker. mutex must be locked */
+{
+  worker->block_used[(worker->queue_start + worker->queue_size) % worker->num_blocks] = worker->block_offset;
+  worker->queue_size++;
+  worker->block_offset = 0;
+  SignalCondition(&worker->condition);
+}
+
+static io_int_t FlushToWriteBehind(const void * const buffer_addr, const size_t num_bytes, void * const caller_info)
+{
+  worker_t * const worker = ((file_buffer_t * const)caller_info)->worker;
+  const uint8_t * const input = (const uint8_t * const)buffer_addr;
+  size_t copied = 0;
+  if (num_bytes > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  LockMutex(&worker->mutex);
+  while (copied < num_bytes && !worker->error) /* Stop accepting data after a failed write */
+  {
+    const size_t block = (worker->queue_start + worker->queue_size) % worker->num_blocks;
+    size_t size;
+    if (worker->queue_size == worker->num_blocks) /* Wait until the worker has written a block */
+    {
+      WaitCondition(&worker->condition, &worker->mutex);
+      continue;
+    }
+    size = worker->block_size - worker->block_offset;
+    if (size > num_bytes - copied)
+      size = num_bytes - copied;
+    memcpy(worker->blocks[block] + worker->block_offset, input + copied, size);
+    copied += size;
+    worker->block_offset += size;
+    if (worker->block_offset == worker->block_size)
+      QueueWriteBehindBlock(worker);
+  }
+  worker->transferred += (io_int_t)copied;
+  UnlockMutex(&worker->mutex);
+  return (io_int_t)copied;
+}
+
+static int WaitForWriteBehind(worker_t * const worker) /* Hands the partially filled block to the worker and waits until all blocks have been written */
+{
+  int ret;
+  LockMutex(&worker->mutex);
+  while (worker->block_offset != 0 && worker->queue_size == worker->num_blocks)
+    WaitCondition(&worker->condition, &worker->mutex);
+  if (worker->block_offset != 0)
+    QueueWriteBehindBlock(worker);
+  while (worker->queue_size != 0)
+    WaitCondition(&worker->condition, &worker->mutex);
+  ret = worker->error ? ERROR_FILE_IO : NO_ERROR;
+  UnlockMutex(&worker->mutex);
+  return ret;
+}
+
+static void QueuePipeBlock(file_buffer_pipe_t * const pipe) /* Hands the block filled by the writer to the reader. mutex must be locked */
+{
+  pipe->block_used[(pipe->queue_start + pipe->queue_size) % pipe->num_blocks] = pipe->write_offset;
+  pipe->queue_size++;
+  pipe->write_offset = 0;
+  SignalCondition(&pipe->condition);
+}
+
+static io_int_t FlushToPipe(const void * const buffer_addr, const size_t num_bytes, void * const caller_info)
+{
+  file_buffer_pipe_t * const pipe = ((file_buffer_t * const)caller_info)->pipe;
+  const uint8_t * const input = (const uint8_t * const)buffer_addr;
+  size_t copied = 0;
+  if (num_bytes > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  while (copied < num_bytes)
+  {
+    size_t block, size;
+    LockMutex(&pipe->mutex);
+    while (pipe->queue_size == pipe->num_blocks && !pipe->reader_closed) /* Wait until the reader has consumed a block */
+      WaitCondition(&pipe->condition, &pipe->mutex);
+    if (pipe->reader_closed) /* Discard data which is not going to be read */
+    {
+      UnlockMutex(&pipe->mutex);
+      copied = num_bytes;
+      break;
+    }
+    block = (pipe->queue_start + pipe->queue_size) % pipe->num_blocks; /* Remains the same while the reader consumes blocks */
+    UnlockMutex(&pipe->mutex); /* The block being filled is not accessed by the reader until it is queued */
+    size = pipe->block_size - pipe->write_offset;
+    if (size > num_bytes - copied)
+      size = num_bytes - copied;
+    memcpy(pipe->blocks[block] + pipe->write_offset, input + copied, size);
+    copied += size;
+    pipe->write_offset += size;
+    if (pipe->write_offset == pipe->block_size)
+    {
+      LockMutex(&pipe->mutex);
+      QueuePipeBlock(pipe);
+      UnlockMutex(&pipe->mutex);
+    }
+  }
+  pipe->written += (io_int_t)copied;
+  return (io_int_t)copied;
+}
+
 static int FlushBufferToFile(file_buffer_t * const file_buffer)
 {
-  return FlushBuffer(file_buffer->io_buffer, file_buffer->type == FBT_FILE ? &FlushToFile : NULL, file_buffer);
+  switch (file_buffer->type)
+  {
+    case FBT_FILE:
+    case FBT_SPILLED:
+      return FlushBuffer(file_buffer->io_buffer, &FlushToFile, file_buffer);
+    case FBT_WRITE_BEHIND:
+      return FlushBuffer(file_buffer->io_buffer, &FlushToWriteBehind, file_buffer);
+    case FBT_PIPE:
+      return FlushBuffer(file_buffer->io_buffer, &FlushToPipe, file_buffer);
+    default:
+      return FlushBuffer(file_buffer->io_buffer, NULL, file_buffer);
+  }
 }
 
-static int AllocateAndInitInternalBuffer(file_buffer_t * const file_buffer, const size_t buffer_size)
+static int AllocateAndInitInternalBuffer(file_buffer_t * const file_buffer, const size_t buffer_size, const int ring, chunk_pool_t * const chunk_pool)
 {
+  buffer_t *io_buffer;
   int ret;
-  if ((file_buffer->io_buffer = AllocateBuffer()) == NULL)
+  if ((io_buffer = AllocateBuffer()) == NULL)
     return ERROR_MEMORY;
-  if ((ret = InitBuffer(file_buffer->io_buffer, buffer_size)) != 0)
+  if ((ret = chunk_pool != NULL ? InitChunkedBuffer(io_buffer, chunk_pool) : (ring ? InitRingBuffer : InitBuffer)(io_buffer, buffer_size)) != 0)
   {
-    FreeBuffer(file_buffer->io_buffer);
+    FreeBuffer(io_buffer);
     return ret;
   }
+  file_buffer->io_buffer = io_buffer; /* Only replace the current buffer on success */
   return NO_ERROR;
 }
 
 int InitFileBuffer(file_buffer_t * const file_buffer, FILE * const input_file, const file_buffer_mode_t mode, const size_t buffer_size)
 {
   int ret;
-  if ((ret = AllocateAndInitInternalBuffer(file_buffer, buffer_size)) != NO_ERROR)
+  if ((ret = AllocateAndInitInternalBuffer(file_buffer, buffer_size, 1, NULL)) != NO_ERROR) /* Ring buffer avoids moving remaining data on partial refills and flushes */
     return ret;
   file_buffer->mode = mode;
   file_buffer->base_file = input_file;
@@ -84,23 +398,440 @@ int InitFileBuffer(file_buffer_t * const file_buffer, FILE * const input_file, c
   return NO_ERROR;
 }
 
-int InitFileBufferInMemory(file_buffer_t * const file_buffer, const file_buffer_mode_t mode, const size_t buffer_size)
+int InitFileBufferMapped(file_buffer_t * const file_buffer, FILE * const input_file, const size_t buffer_size)
+{
+#ifdef FILE_BUFFER_MMAP
+  struct stat file_info;
+  io_int_t offset;
+  if (fstat(fileno(input_file), &file_info) == 0 && S_ISREG(file_info.st_mode) && file_info.st_size > 0 && (io_uint_t)file_info.st_size <= MAX_USABLE_SIZE && (offset = FTELL(input_file)) >= 0 && offset <= (io_int_t)file_info.st_size)
+  {
+    void * const mapping = mmap(NULL, (size_t)file_info.st_size, PROT_READ, MAP_PRIVATE, fileno(input_file), 0);
+    if (mapping != MAP_FAILED)
+    {
+  #ifdef MADV_SEQUENTIAL
+      madvise(mapping, (size_t)file_info.st_size, MADV_SEQUENTIAL); /* Ignore result since this is only a hint */
+  #endif
+      file_buffer->io_buffer = NULL;
+      file_buffer->mode = FBM_READING;
+      file_buffer->base_file = input_file;
+      file_buffer->type = FBT_MMAP;
+      file_buffer->mapping = (uint8_t*)mapping;
+      file_buffer->mapping_size = (size_t)file_info.st_size;
+      file_buffer->mapping_offset = (size_t)offset; /* Start reading at the current file offset */
+      return NO_ERROR;
+    }
+  }
+#endif
+  return InitFileBuffer(file_buffer, input_file, FBM_READING, buffer_size); /* Fall back to buffered reading (unsupported platform, pipes, empty files, mapping errors) */
+}
+
+int InitFileBufferFromMemory(file_buffer_t * const file_buffer, const uint8_t * const data, const size_t size)
+{
+  if (data == NULL && size != 0)
+    return ERROR_INVALID_VALUE;
+  if (size > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  file_buffer->io_buffer = NULL;
+  file_buffer->mode = FBM_READING;
+  file_buffer->base_file = NULL; /* Not to be unmapped */
+  file_buffer->type = FBT_MMAP; /* Read like a mapping */
+  file_buffer->mapping = (uint8_t*)data; /* Never written to */
+  file_buffer->mapping_size = size;
+  file_buffer->mapping_offset = 0;
+  return NO_ERROR;
+}
+
+int InitFileBufferToMemory(file_buffer_t * const file_buffer, uint8_t * const data, const size_t size)
+{
+  if (data == NULL && size != 0)
+    return ERROR_INVALID_VALUE;
+  if (size > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  file_buffer->io_buffer = NULL;
+  file_buffer->mode = FBM_WRITING;
+  file_buffer->base_file = NULL; /* Not to be unmapped */
+  file_buffer->type = FBT_MMAP; /* Written like a mapping */
+  file_buffer->mapping = data;
+  file_buffer->mapping_size = size;
+  file_buffer->mapping_offset = 0;
+  return NO_ERROR;
+}
+
+static void FreeBlocks(uint8_t ** const blocks, size_t * const block_used, const size_t num_blocks)
+{
+  size_t i;
+  if (blocks != NULL)
+  {
+    for (i = 0; i < num_blocks; i++)
+      FreeMemory(blocks[i]);
+  }
+  FreeMemory(blocks);
+  FreeMemory(block_used);
+}
+
+static int AllocateBlocks(uint8_t *** const blocks_addr, size_t ** const block_used_addr, const size_t num_blocks, const size_t block_size)
+{
+  uint8_t **blocks;
+  size_t *block_used, i;
+  block_used = (size_t*)AllocateMemory(sizeof(size_t) * num_blocks);
+  if ((blocks = (uint8_t**)AllocateMemory(sizeof(uint8_t*) * num_blocks)) != NULL)
+  {
+    for (i = 0; i < num_blocks; i++)
+      blocks[i] = (uint8_t*)AllocateMemory(sizeof(uint8_t) * block_size);
+  }
+  if (blocks == NULL || block_used == NULL)
+  {
+    FreeBlocks(blocks, block_used, num_blocks);
+    return ERROR_MEMORY;
+  }
+  for (i = 0; i < num_blocks; i++)
+  {
+    if (blocks[i] == NULL)
+    {
+      FreeBlocks(blocks, block_used, num_blocks);
+      return ERROR_MEMORY;
+    }
+  }
+  *blocks_addr = blocks;
+  *block_used_addr = block_used;
+  return NO_ERROR;
+}
+
+static void FreeWorker(worker_t * const worker)
+{
+  FreeBlocks(worker->blocks, worker->block_used, worker->num_blocks);
+  FreeMemory(worker);
+}
+
+static int AllocateWorker(worker_t ** const worker_addr, const size_t num_blocks, const size_t block_size)
+{
+  worker_t *worker;
+  int ret;
+  if ((worker = (worker_t*)AllocateMemory(sizeof(worker_t))) == NULL)
+    return ERROR_MEMORY;
+  worker->num_blocks = num_blocks;
+  if ((ret = AllocateBlocks(&worker->blocks, &worker->block_used, num_blocks, block_size)) != NO_ERROR)
+  {
+    FreeMemory(worker);
+    return ret;
+  }
+  *worker_addr = worker;
+  return NO_ERROR;
+}
+
+static int StartWorker(file_buffer_t * const file_buffer, thread_function_t * const function, const size_t num_blocks, const size_t block_size)
+{
+  worker_t *worker;
+  int ret;
+  if ((ret = AllocateWorker(&worker, num_blocks, block_size)) != NO_ERROR)
+    return ret;
+  worker->block_size = block_size;
+  worker->queue_start = worker->queue_size = worker->block_offset = 0;
+  worker->stop = worker->error = 0;
+  worker->start_offset = FTELL(file_buffer->base_file);
+  if (worker->start_offset < 0) /* Not seekable, e.g., pipes */
+    worker->start_offset = 0;
+  worker->transferred = 0;
+  if (InitMutex(&worker->mutex) != NO_ERROR)
+  {
+    FreeWorker(worker);
+    return ERROR_LIBRARY_INIT;
+  }
+  if (InitMutex(&worker->file_mutex) != NO_ERROR)
+  {
+    UninitMutex(&worker->mutex);
+    FreeWorker(worker);
+    return ERROR_LIBRARY_INIT;
+  }
+  if (InitCondition(&worker->condition) != NO_ERROR)
+  {
+    UninitMutex(&worker->file_mutex);
+    UninitMutex(&worker->mutex);
+    FreeWorker(worker);
+    return ERROR_LIBRARY_INIT;
+  }
+  file_buffer->worker = worker;
+  if (StartThread(&worker->thread, function, file_buffer) != NO_ERROR)
+  {
+    UninitCondition(&worker->condition);
+    UninitMutex(&worker->file_mutex);
+    UninitMutex(&worker->mutex);
+    FreeWorker(worker);
+    file_buffer->worker = NULL;
+    return ERROR_LIBRARY_CALL;
+  }
+  return NO_ERROR;
+}
+
+static void StopWorker(file_buffer_t * const file_buffer)
+{
+  worker_t * const worker = file_buffer->worker;
+  LockMutex(&worker->mutex);
+  worker->stop = 1;
+  SignalCondition(&worker->condition);
+  UnlockMutex(&worker->mutex);
+  JoinThread(&worker->thread); /* Ignore result */
+  UninitCondition(&worker->condition);
+  UninitMutex(&worker->file_mutex);
+  UninitMutex(&worker->mutex);
+  FreeWorker(worker);
+  file_buffer->worker = NULL;
+}
+
+static int InitFileBufferWithWorker(file_buffer_t * const file_buffer, FILE * const file, const file_buffer_mode_t mode, const size_t buffer_size, const size_t block_size)
+{
+  int ret;
+  if (block_size <= 0)
+    return ERROR_INVALID_VALUE;
+  if (block_size > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if ((ret = AllocateAndInitInternalBuffer(file_buffer, buffer_size, 1, NULL)) != NO_ERROR)
+    return ret;
+  file_buffer->mode = mode;
+  file_buffer->base_file = file;
+  if ((mode == FBM_READING ? StartWorker(file_buffer, &ReadAheadFromFile, NUM_PREFETCH_BLOCKS, block_size) : StartWorker(file_buffer, &WriteBehindToFile, NUM_WRITE_BEHIND_BLOCKS, block_size)) != NO_ERROR) /* Fall back to synchronous I/O if the worker thread cannot be started */
+  {
+    file_buffer->type = FBT_FILE;
+    file_buffer->worker = NULL;
+  }
+  else
+    file_buffer->type = mode == FBM_READING ? FBT_PREFETCH : FBT_WRITE_BEHIND;
+  if (mode == FBM_READING)
+    return RefillBufferFromFile(file_buffer);
+  return NO_ERROR;
+}
+
+int InitFileBufferPrefetched(file_buffer_t * const file_buffer, FILE * const input_file, const size_t buffer_size, const size_t block_size)
+{
+  return InitFileBufferWithWorker(file_buffer, input_file, FBM_READING, buffer_size, block_size);
+}
+
+int InitFileBufferWriteBehind(file_buffer_t * const file_buffer, FILE * const output_file, const size_t buffer_size, const size_t block_size)
+{
+  return InitFileBufferWithWorker(file_buffer, output_file, FBM_WRITING, buffer_size, block_size);
+}
+
+file_buffer_pipe_t *AllocateFileBufferPipe(void)
+{
+  return (file_buffer_pipe_t*)AllocateMemory(sizeof(file_buffer_pipe_t));
+}
+
+void FreeFileBufferPipe(file_buffer_pipe_t * const pipe)
+{
+  FreeMemory(pipe);
+}
+
+int InitFileBufferPipe(file_buffer_pipe_t * const pipe, const size_t num_blocks, const size_t block_size)
 {
   int ret;
-  if ((ret = AllocateAndInitInternalBuffer(file_buffer, buffer_size)) != NO_ERROR)
+  if (num_blocks <= 0 || block_size <= 0)
+    return ERROR_INVALID_VALUE;
+  if (block_size > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if ((ret = AllocateBlocks(&pipe->blocks, &pipe->block_used, num_blocks, block_size)) != NO_ERROR)
+    return ret;
+  pipe->num_blocks = num_blocks;
+  pipe->block_size = block_size;
+  pipe->queue_start = pipe->queue_size = pipe->write_offset = pipe->read_offset = 0;
+  pipe->writer_closed = pipe->reader_closed = 0;
+  pipe->trailing_byte = pipe->trailing_bits = 0;
+  pipe->written = pipe->read = 0;
+  if (InitMutex(&pipe->mutex) != NO_ERROR)
+  {
+    FreeBlocks(pipe->blocks, pipe->block_used, pipe->num_blocks);
+    return ERROR_LIBRARY_INIT;
+  }
+  if (InitCondition(&pipe->condition) != NO_ERROR)
+  {
+    UninitMutex(&pipe->mutex);
+    FreeBlocks(pipe->blocks, pipe->block_used, pipe->num_blocks);
+    return ERROR_LIBRARY_INIT;
+  }
+  return NO_ERROR;
+}
+
+void UninitFileBufferPipe(file_buffer_pipe_t * const pipe)
+{
+  UninitCondition(&pipe->condition);
+  UninitMutex(&pipe->mutex);
+  FreeBlocks(pipe->blocks, pipe->block_used, pipe->num_blocks);
+}
+
+int InitFileBufferPiped(file_buffer_t * const file_buffer, file_buffer_pipe_t * const pipe, const file_buffer_mode_t mode, const size_t buffer_size)
+{
+  int ret;
+  if ((ret = AllocateAndInitInternalBuffer(file_buffer, buffer_size, 1, NULL)) != NO_ERROR)
+    return ret;
+  file_buffer->mode = mode;
+  file_buffer->base_file = NULL;
+  file_buffer->type = FBT_PIPE;
+  file_buffer->pipe = pipe;
+  return NO_ERROR; /* Do not refill when reading since this would block until the writer has started */
+}
+
+int CloseFileBufferPipe(file_buffer_t * const file_buffer, const uint8_t trailing_byte, const uint8_t trailing_bits)
+{
+  file_buffer_pipe_t *pipe;
+  int ret = NO_ERROR;
+  if (file_buffer->type != FBT_PIPE)
+    return ERROR_INVALID_MODE;
+  if (trailing_bits >= 8)
+    return ERROR_INVALID_VALUE;
+  pipe = file_buffer->pipe;
+  if (file_buffer->mode == FBM_WRITING)
+  {
+    if (FlushBufferToFile(file_buffer) != NO_ERROR || GetUsedBufferSize(file_buffer->io_buffer) != 0)
+      ret = ERROR_FILE_IO; /* Close anyway so that the reader does not wait forever */
+    LockMutex(&pipe->mutex);
+    if (!pipe->writer_closed)
+    {
+      while (pipe->write_offset != 0 && pipe->queue_size == pipe->num_blocks && !pipe->reader_closed)
+        WaitCondition(&pipe->condition, &pipe->mutex);
+      if (pipe->write_offset != 0 && !pipe->reader_closed) /* Queue the last, partially filled block */
+        QueuePipeBlock(pipe);
+      pipe->trailing_byte = trailing_byte;
+      pipe->trailing_bits = trailing_bits;
+      pipe->writer_closed = 1;
+      SignalCondition(&pipe->condition);
+    }
+    UnlockMutex(&pipe->mutex);
+  }
+  else
+  {
+    LockMutex(&pipe->mutex);
+    pipe->reader_closed = 1;
+    SignalCondition(&pipe->condition);
+    UnlockMutex(&pipe->mutex);
+  }
+  return ret;
+}
+
+int GetFileBufferTrailingBits(const file_buffer_t * const file_buffer, uint8_t * const trailing_byte, uint8_t * const trailing_bits)
+{
+  file_buffer_pipe_t *pipe;
+  *trailing_byte = *trailing_bits = 0;
+  if (file_buffer->type != FBT_PIPE || file_buffer->mode != FBM_READING)
+    return NO_ERROR; /* Only pipes carry left-over bits */
+  pipe = file_buffer->pipe;
+  LockMutex(&pipe->mutex);
+  if (pipe->writer_closed)
+  {
+    *trailing_byte = pipe->trailing_byte;
+    *trailing_bits = pipe->trailing_bits;
+  }
+  UnlockMutex(&pipe->mutex);
+  return NO_ERROR;
+}
+
+static int InitFileBufferInMemoryInternal(file_buffer_t * const file_buffer, const file_buffer_mode_t mode, const size_t buffer_size, chunk_pool_t * const chunk_pool)
+{
+  int ret;
+  if ((ret = AllocateAndInitInternalBuffer(file_buffer, buffer_size, 0, chunk_pool)) != NO_ERROR) /* Linear or chunked buffer since data is only appended when writing and only consumed when reading */
     return ret;
   file_buffer->mode = mode;
   file_buffer->base_file = NULL;
   file_buffer->type = FBT_MEMORY;
+  file_buffer->memory_budget = 0;
+  file_buffer->memory_buffer_size = buffer_size;
+  file_buffer->chunk_pool = chunk_pool;
   return NO_ERROR;
 }
 
+int InitFileBufferInMemory(file_buffer_t * const file_buffer, const file_buffer_mode_t mode, const size_t buffer_size)
+{
+  return InitFileBufferInMemoryInternal(file_buffer, mode, buffer_size, NULL);
+}
+
+int InitFileBufferInMemoryChunked(file_buffer_t * const file_buffer, const file_buffer_mode_t mode, chunk_pool_t * const chunk_pool)
+{
+  return InitFileBufferInMemoryInternal(file_buffer, mode, 0, chunk_pool);
+}
+
 void UninitFileBuffer(file_buffer_t * const file_buffer)
 {
+  if (file_buffer->type == FBT_MMAP)
+  {
+#ifdef FILE_BUFFER_MMAP
+    if (file_buffer->base_file != NULL) /* Caller memory is not unmapped */
+      munmap(file_buffer->mapping, file_buffer->mapping_size); /* Ignore result */
+#endif
+    return;
+  }
   if (file_buffer->mode == FBM_WRITING)
     FlushBufferToFile(file_buffer); /* Ignore result */
+  if (file_buffer->type == FBT_WRITE_BEHIND)
+    WaitForWriteBehind(file_buffer->worker); /* Ignore result */
+  if (file_buffer->type == FBT_PREFETCH || file_buffer->type == FBT_WRITE_BEHIND)
+    StopWorker(file_buffer);
+  if (file_buffer->type == FBT_PIPE)
+    CloseFileBufferPipe(file_buffer, 0, 0); /* Ignore result. No-op if the writer has already been closed */
   UninitBuffer(file_buffer->io_buffer);
   FreeBuffer(file_buffer->io_buffer);
+  if (file_buffer->type == FBT_SPILLED)
+    fclose(file_buffer->base_file); /* Ignore result. Temporary files are removed automatically */
+}
+
+static int SpillToFile(file_buffer_t * const file_buffer) /* Moves the in-memory data to a new temporary file */
+{
+  buffer_t * const memory_buffer = file_buffer->io_buffer;
+  int ret;
+  if ((file_buffer->base_file = tmpfile()) == NULL)
+    return ERROR_FILE_IO;
+  if ((ret = AllocateAndInitInternalBuffer(file_buffer, file_buffer->spill_buffer_size, 1, NULL)) != NO_ERROR)
+  {
+    fclose(file_buffer->base_file); /* Ignore result */
+    file_buffer->base_file = NULL;
+    return ret;
+  }
+  if (FlushBuffer(memory_buffer, &FlushToFile, file_buffer) != NO_ERROR || GetUsedBufferSize(memory_buffer) != 0)
+  {
+    UninitBuffer(file_buffer->io_buffer);
+    FreeBuffer(file_buffer->io_buffer);
+    file_buffer->io_buffer = memory_buffer; /* Keep what has not been flushed */
+    fclose(file_buffer->base_file); /* Ignore result */
+    file_buffer->base_file = NULL;
+    return ERROR_FILE_IO;
+  }
+  UninitBuffer(memory_buffer);
+  FreeBuffer(memory_buffer);
+  file_buffer->type = FBT_SPILLED;
+  return NO_ERROR;
+}
+
+static int SpillIfOverBudget(file_buffer_t * const file_buffer)
+{
+  if (file_buffer->type != FBT_MEMORY || file_buffer->memory_budget == 0 || (size_t)GetUsedBufferSize(file_buffer->io_buffer) <= file_buffer->memory_budget)
+    return NO_ERROR;
+  return SpillToFile(file_buffer);
+}
+
+static int RestoreFromSpill(file_buffer_t * const file_buffer) /* Discards the temporary file and goes back to an empty in-memory buffer */
+{
+  buffer_t * const spill_buffer = file_buffer->io_buffer;
+  int ret;
+  if ((ret = AllocateAndInitInternalBuffer(file_buffer, file_buffer->memory_buffer_size, 0, file_buffer->chunk_pool)) != NO_ERROR)
+    return ret;
+  UninitBuffer(spill_buffer);
+  FreeBuffer(spill_buffer);
+  fclose(file_buffer->base_file); /* Ignore result */
+  file_buffer->base_file = NULL;
+  file_buffer->type = FBT_MEMORY;
+  return NO_ERROR;
+}
+
+int SetFileBufferMemoryBudget(file_buffer_t * const file_buffer, const size_t memory_budget, const size_t spill_buffer_size)
+{
+  if (file_buffer->type != FBT_MEMORY && file_buffer->type != FBT_SPILLED)
+    return ERROR_INVALID_MODE;
+  if (memory_budget != 0 && spill_buffer_size <= 0)
+    return ERROR_INVALID_VALUE;
+  if (spill_buffer_size > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  file_buffer->memory_budget = memory_budget;
+  file_buffer->spill_buffer_size = spill_buffer_size;
+  if (file_buffer->mode == FBM_WRITING)
+    return SpillIfOverBudget(file_buffer);
+  return NO_ERROR;
 }
 
 file_buffer_mode_t GetFileBufferMode(const file_buffer_t * const file_buffer)
@@ -112,6 +843,17 @@ int SetFileBufferMode(file_buffer_t * const file_buffer, const file_buffer_mode_
 {
   if (file_buffer->mode == mode)
     return NO_ERROR;
+  if (file_buffer->type == FBT_MMAP || file_buffer->type == FBT_PREFETCH || file_buffer->type == FBT_WRITE_BEHIND || file_buffer->type == FBT_PIPE) /* Mappings and read-ahead buffers are read-only, write-behind buffers are write-only, pipes have a fixed direction */
+    return ERROR_INVALID_MODE;
+  if (file_buffer->type == FBT_SPILLED) /* Read back the temporary file from the start. Appending after reading is not supported */
+  {
+    if (file_buffer->mode != FBM_WRITING || mode != FBM_READING)
+      return ERROR_INVALID_MODE;
+    if (FlushBufferToFile(file_buffer) != NO_ERROR || GetUsedBufferSize(file_buffer->io_buffer) != 0 || FSEEK(file_buffer->base_file, 0, SEEK_SET) != 0)
+      return ERROR_FILE_IO;
+    file_buffer->mode = mode;
+    return NO_ERROR;
+  }
   if ((file_buffer->mode == FBM_WRITING && mode == FBM_READING) || (file_buffer->mode == FBM_READING && mode == FBM_WRITING))
   {
     file_buffer->mode = mode;
@@ -123,6 +865,12 @@ int SetFileBufferMode(file_buffer_t * const file_buffer, const file_buffer_mode_
 
 size_t GetFileBufferSize(const file_buffer_t * const file_buffer)
 {
+  if (file_buffer->type == FBT_MMAP)
+    return file_buffer->mapping_size;
+  if (file_buffer->type == FBT_PREFETCH || file_buffer->type == FBT_WRITE_BEHIND) /* Include the worker's blocks */
+    return GetBufferSize(file_buffer->io_buffer) + file_buffer->worker->num_blocks * file_buffer->worker->block_size;
+  if (file_buffer->type == FBT_PIPE && file_buffer->mode == FBM_WRITING) /* Count the pipe's blocks only once */
+    return GetBufferSize(file_buffer->io_buffer) + file_buffer->pipe->num_blocks * file_buffer->pipe->block_size;
   return GetBufferSize(file_buffer->io_buffer);
 }
 
@@ -130,6 +878,8 @@ int EndOfFileBuffer(file_buffer_t * const file_buffer)
 {
   if (file_buffer->mode != FBM_READING) /* There can be no EOF when not in reading mode */
     return ERROR_INVALID_MODE;
+  if (file_buffer->type == FBT_MMAP)
+    return file_buffer->mapping_offset == file_buffer->mapping_size;
   if (GetUsedBufferSize(file_buffer->io_buffer) == 0)
   {
     int ret;
@@ -141,7 +891,15 @@ int EndOfFileBuffer(file_buffer_t * const file_buffer)
 
 io_int_t GetActualFileOffset(const file_buffer_t * const file_buffer)
 {
-  if (file_buffer->type != FBT_FILE)
+  if (file_buffer->type == FBT_MMAP)
+    return (io_int_t)file_buffer->mapping_offset;
+  if (file_buffer->type == FBT_PREFETCH) /* The file offset is ahead by the bytes read by the worker */
+    return file_buffer->worker->start_offset + file_buffer->worker->transferred - GetUsedBufferSize(file_buffer->io_buffer);
+  if (file_buffer->type == FBT_WRITE_BEHIND) /* The file offset is behind by the bytes yet to be written by the worker */
+    return file_buffer->worker->start_offset + file_buffer->worker->transferred + GetUsedBufferSize(file_buffer->io_buffer);
+  if (file_buffer->type == FBT_PIPE)
+    return file_buffer->mode == FBM_READING ? file_buffer->pipe->read - GetUsedBufferSize(file_buffer->io_buffer) : file_buffer->pipe->written + GetUsedBufferSize(file_buffer->io_buffer);
+  if (file_buffer->type != FBT_FILE && file_buffer->type != FBT_SPILLED)
     return GetUsedBufferSize(file_buffer->io_buffer);
   else
   {
@@ -161,20 +919,69 @@ io_int_t GetActualFileSize(const file_buffer_t * const file_buffer)
 {
   if (file_buffer->mode != FBM_READING) /* There is no file size when not in reading mode */
     return ERROR_INVALID_MODE;
-  if (file_buffer->type != FBT_FILE)
+  if (file_buffer->type == FBT_MMAP) /* No need to seek since the mapping covers the whole file */
+    return (io_int_t)file_buffer->mapping_size;
+  if (file_buffer->type != FBT_FILE && file_buffer->type != FBT_PREFETCH && file_buffer->type != FBT_SPILLED)
     return GetUsedBufferSize(file_buffer->io_buffer);
   else
   {
-    const io_uint_t curent_offset = FTELL(file_buffer->base_file); /* Save current file offset */
-    io_uint_t ret_val;
+    mutex_t * const file_mutex = file_buffer->type == FBT_PREFETCH ? &file_buffer->worker->file_mutex : NULL; /* Do not seek while the worker is reading */
+    io_uint_t curent_offset, ret_val;
+    if (file_mutex != NULL)
+      LockMutex(file_mutex);
+    curent_offset = FTELL(file_buffer->base_file); /* Save current file offset */
     FSEEK(file_buffer->base_file, 0, SEEK_END); /* Go to EOF */
     ret_val = (io_int_t)FTELL(file_buffer->base_file);
     FSEEK(file_buffer->base_file, curent_offset, SEEK_SET); /* Go back to original file offset */
+    if (file_mutex != NULL)
+      UnlockMutex(file_mutex);
     return ret_val;
   }
 }
 
-/* TODO: Implement PeekFileBuffer */
+io_int_t AcquireFileBufferReadSpan(file_buffer_t * const file_buffer, const uint8_t ** const span, const size_t max_size)
+{
+  const uint8_t *second_span;
+  size_t span_size, second_span_size;
+  io_int_t ret;
+  if (file_buffer->mode != FBM_READING) /* No reading when not in reading mode */
+    return ERROR_INVALID_MODE;
+  if (max_size > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if (file_buffer->type == FBT_MMAP) /* Span points directly into the mapping */
+  {
+    const size_t remaining_size = file_buffer->mapping_size - file_buffer->mapping_offset;
+    *span = &file_buffer->mapping[file_buffer->mapping_offset];
+    return (io_int_t)(remaining_size < max_size ? remaining_size : max_size);
+  }
+  if (GetUsedBufferSize(file_buffer->io_buffer) == 0)
+  {
+    if ((ret = RefillBufferFromFile(file_buffer)) != NO_ERROR)
+      return ret;
+  }
+  if ((ret = PeekBufferSegments(file_buffer->io_buffer, max_size, span, &span_size, &second_span, &second_span_size)) < 0)
+    return ret;
+  return (io_int_t)span_size; /* Only the first segment is contiguous */
+}
+
+int ReleaseFileBufferReadSpan(file_buffer_t * const file_buffer, const size_t size)
+{
+  const uint8_t *first_span, *second_span;
+  size_t first_span_size, second_span_size;
+  if (file_buffer->mode != FBM_READING) /* No reading when not in reading mode */
+    return ERROR_INVALID_MODE;
+  if (file_buffer->type == FBT_MMAP)
+  {
+    if (size > file_buffer->mapping_size - file_buffer->mapping_offset)
+      return ERROR_INVALID_VALUE;
+    file_buffer->mapping_offset += size;
+    return NO_ERROR;
+  }
+  if (size > (size_t)GetUsedBufferSize(file_buffer->io_buffer))
+    return ERROR_INVALID_VALUE;
+  ReadBufferSegments(file_buffer->io_buffer, size, &first_span, &first_span_size, &second_span, &second_span_size); /* Consume without copying */
+  return NO_ERROR;
+}
 
 io_int_t ReadFileBuffer(file_buffer_t * const file_buffer, uint8_t * const output, const size_t output_size)
 {
@@ -184,6 +991,14 @@ io_int_t ReadFileBuffer(file_buffer_t * const file_buffer, uint8_t * const outpu
     return ERROR_INVALID_MODE;
   if (output_size > MAX_USABLE_SIZE)
     return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if (file_buffer->type == FBT_MMAP) /* Copy directly from the mapping without refilling */
+  {
+    const size_t remaining_size = file_buffer->mapping_size - file_buffer->mapping_offset;
+    read = remaining_size < output_size ? remaining_size : output_size;
+    memcpy(output, &file_buffer->mapping[file_buffer->mapping_offset], read);
+    file_buffer->mapping_offset += read;
+    return (io_int_t)read;
+  }
   while (output_size - read > 0 && (ret = ReadBuffer(file_buffer->io_buffer, &output[0] + read, output_size - read)) != (io_int_t)(output_size - read))
   {
     if (ret == 0 && EndOfFileBuffer(file_buffer)) /* Note: EOF check is necessary since checking only for ret > 0 may fail if the buffer is empty, but EOF is not yet reached */
@@ -198,8 +1013,11 @@ io_int_t ReadFileBuffer(file_buffer_t * const file_buffer, uint8_t * const outpu
 
 #define RESIZE_BUFFER() { \
   int buf_ret; \
-  if ((buf_ret = ResizeBuffer(file_buffer->io_buffer, 2 * GetBufferSize(file_buffer->io_buffer))) != NO_ERROR) /*Double buffer size and retry*/ \
+  const size_t old_buf_size = GetBufferSize(file_buffer->io_buffer); \
+  if ((buf_ret = ResizeBuffer(file_buffer->io_buffer, 2 * old_buf_size)) != NO_ERROR) /*Double buffer size and retry*/ \
     return (io_int_t)buf_ret; \
+  if (GetBufferSize(file_buffer->io_buffer) != old_buf_size) /* Chunked buffers grow when writing instead */ \
+    CountBufferGrowth(); \
 }
 
 io_int_t WriteFileBuffer(file_buffer_t * const file_buffer, const uint8_t * const input, const size_t input_size)
@@ -210,9 +1028,17 @@ io_int_t WriteFileBuffer(file_buffer_t * const file_buffer, const uint8_t * cons
     return ERROR_INVALID_MODE;
   if (input_size > MAX_USABLE_SIZE)
     return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if (file_buffer->type == FBT_MMAP) /* Copy directly to the caller memory, which cannot grow */
+  {
+    const size_t remaining_size = file_buffer->mapping_size - file_buffer->mapping_offset;
+    written = remaining_size < input_size ? remaining_size : input_size;
+    memcpy(&file_buffer->mapping[file_buffer->mapping_offset], input, written);
+    file_buffer->mapping_offset += written;
+    return written == input_size ? (io_int_t)written : ERROR_OUTPUT_FULL;
+  }
   if ((old_size = GetUsedBufferSize(file_buffer->io_buffer)) == (io_int_t)GetBufferSize(file_buffer->io_buffer)) /* Flush or resize buffer if full (prevents unwriteable full buffer when input_size is 1 and buffer size is greater than 1) */
   {
-    if (file_buffer->type == FBT_FILE) /* Flush to file */
+    if (file_buffer->type != FBT_MEMORY) /* Flush to file */
     {
       if (FlushBufferToFile(file_buffer) != NO_ERROR)
         return ERROR_FILE_IO; /* Nothing was written => abort */
@@ -226,30 +1052,90 @@ io_int_t WriteFileBuffer(file_buffer_t * const file_buffer, const uint8_t * cons
   {
     if (ret > 0)
       written += (size_t)ret;
-    if (file_buffer->type == FBT_FILE) /* Flush to file */
+    if (file_buffer->type != FBT_MEMORY) /* Flush to file */
     {
       old_size = GetUsedBufferSize(file_buffer->io_buffer);
-      if ((ret = FlushBufferToFile(file_buffer)) != old_size)
-        return written - (old_size - ret); /* old_size bytes were expected to be written, but only ret were actually written => abort and report the total actual number written so far (this could be handled differently to allow partial flushing) */
+      if (FlushBufferToFile(file_buffer) != NO_ERROR || GetUsedBufferSize(file_buffer->io_buffer) == old_size)
+        return written; /* Nothing could be flushed => abort and report the total number buffered so far (partial flushes leave the remaining data in the buffer) */
     }
     else /* Resize buffer */
     {
       RESIZE_BUFFER();
     }
   }
+  if (ret > 0 && SpillIfOverBudget(file_buffer) != NO_ERROR)
+    return ERROR_FILE_IO;
   return written + ret; /* ret bytes weren written in the last iteration, the rest is from previous iterations */
 }
 
+io_int_t ReserveFileBufferWriteSpan(file_buffer_t * const file_buffer, uint8_t ** const span, const size_t min_size)
+{
+  io_int_t span_size;
+  if (file_buffer->mode != FBM_WRITING) /* No writing when not in writing mode */
+    return ERROR_INVALID_MODE;
+  if (min_size > MAX_USABLE_SIZE)
+    return ERROR_VALUE_LARGER_THAN_USABLE_SIZE;
+  if (file_buffer->type == FBT_MMAP) /* Span points directly into the caller memory, i.e., it may be smaller than min_size close to its end */
+  {
+    const size_t remaining_size = file_buffer->mapping_size - file_buffer->mapping_offset;
+    if (remaining_size == 0)
+      return ERROR_OUTPUT_FULL;
+    *span = &file_buffer->mapping[file_buffer->mapping_offset];
+    return (io_int_t)remaining_size;
+  }
+  while ((span_size = ReserveBuffer(file_buffer->io_buffer, span, min_size)) == 0 || (size_t)span_size < min_size)
+  {
+    const io_int_t old_size = GetUsedBufferSize(file_buffer->io_buffer);
+    if (file_buffer->type != FBT_MEMORY && old_size != 0) /* Flush to file */
+    {
+      if (FlushBufferToFile(file_buffer) != NO_ERROR || GetUsedBufferSize(file_buffer->io_buffer) == old_size)
+        return ERROR_FILE_IO; /* Nothing could be flushed => abort */
+    }
+    else /* Resize buffer (also for files if the buffer is smaller than min_size) */
+    {
+      int ret;
+      const size_t new_size = 2 * GetBufferSize(file_buffer->io_buffer);
+      if ((ret = ResizeBuffer(file_buffer->io_buffer, new_size < (size_t)old_size + min_size ? (size_t)old_size + min_size : new_size)) != NO_ERROR)
+        return (io_int_t)ret;
+    }
+  }
+  return span_size;
+}
+
+int CommitFileBufferWriteSpan(file_buffer_t * const file_buffer, const size_t size)
+{
+  int ret;
+  if (file_buffer->mode != FBM_WRITING) /* No writing when not in writing mode */
+    return ERROR_INVALID_MODE;
+  if (file_buffer->type == FBT_MMAP)
+  {
+    if (size > file_buffer->mapping_size - file_buffer->mapping_offset)
+      return ERROR_INVALID_VALUE;
+    file_buffer->mapping_offset += size;
+    return NO_ERROR;
+  }
+  if ((ret = CommitBuffer(file_buffer->io_buffer, size)) != NO_ERROR)
+    return ret;
+  return SpillIfOverBudget(file_buffer);
+}
+
 int FlushFileBuffer(file_buffer_t * const file_buffer)
 {
-  io_int_t old_size = GetUsedBufferSize(file_buffer->io_buffer);
-  if (file_buffer->type != FBT_FILE)
+  if (file_buffer->type == FBT_MMAP && file_buffer->mode == FBM_WRITING) /* Written to the caller memory directly */
+    return NO_ERROR;
+  if (file_buffer->type != FBT_FILE && file_buffer->type != FBT_WRITE_BEHIND)
     return ERROR_FILE_IO;
-  return FlushBufferToFile(file_buffer) == old_size;
+  if (FlushBufferToFile(file_buffer) != NO_ERROR || GetUsedBufferSize(file_buffer->io_buffer) != 0)
+    return ERROR_FILE_IO; /* Not all buffered bytes could be flushed */
+  if (file_buffer->type == FBT_WRITE_BEHIND) /* Completion barrier */
+    return WaitForWriteBehind(file_buffer->worker);
+  return NO_ERROR;
 }
 
 int ClearFileBuffer(file_buffer_t * const file_buffer)
 {
+  if (file_buffer->type == FBT_SPILLED)
+    return RestoreFromSpill(file_buffer);
   if (file_buffer->type != FBT_MEMORY)
     return ERROR_FILE_IO;
   ClearBuffer(file_buffer->io_buffer);
@@ -259,8 +1145,8 @@ int ClearFileBuffer(file_buffer_t * const file_buffer)
 int ResetFileBuffer(file_buffer_t * const file_buffer, const file_buffer_mode_t mode)
 {
   int ret;
-  file_buffer->mode = mode;
   if ((ret = ClearFileBuffer(file_buffer)) != NO_ERROR)
     return ret;
+  file_buffer->mode = mode;
   return NO_ERROR;
 }
\ No newline at end of file
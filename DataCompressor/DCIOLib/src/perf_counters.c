@@ -0,0 +1,127 @@
+/* Hardware performance counter wrapper
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "perf_counters.h"
+
+#ifdef __linux__
+  #include <string.h>
+  #include <unistd.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <linux/perf_event.h>
+#endif
+
+static const char * const counter_names[NUM_PERF_COUNTERS] = { "cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses" };
+
+#ifdef __linux__
+#define CACHE_READ_MISSES(cache) ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const uint32_t counter_types[NUM_PERF_COUNTERS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE };
+static const uint64_t counter_configs[NUM_PERF_COUNTERS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES, CACHE_READ_MISSES(PERF_COUNT_HW_CACHE_L1D), CACHE_READ_MISSES(PERF_COUNT_HW_CACHE_LL) };
+
+static int OpenPerfCounter(const perf_counter_t counter, const int inherit)
+{
+  struct perf_event_attr attributes;
+  memset(&attributes, 0, sizeof(attributes));
+  attributes.size = sizeof(attributes);
+  attributes.type = counter_types[counter];
+  attributes.config = counter_configs[counter];
+  attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING; /* To scale multiplexed counters */
+  attributes.disabled = 1;
+  attributes.inherit = inherit ? 1 : 0;
+  attributes.exclude_kernel = 1; /* Allowed with the default perf_event_paranoid setting */
+  attributes.exclude_hv = 1;
+  return (int)syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0); /* Calling thread on any processor */
+}
+
+static int ReadPerfCounter(const int handle, uint64_t * const value)
+{
+  uint64_t data[3]; /* Value, time enabled, time running */
+  if (read(handle, data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0)
+    return 0;
+  *value = data[2] < data[1] ? (uint64_t)((double)data[0] * data[1] / data[2]) : data[0]; /* Extrapolate if the counter was multiplexed */
+  return 1;
+}
+#endif
+
+int OpenPerfCounters(perf_counters_t * const counters, const int inherit)
+{
+  size_t i;
+  int any_available = 0;
+  for (i = 0; i < NUM_PERF_COUNTERS; i++)
+  {
+#ifdef __linux__
+    counters->handles[i] = OpenPerfCounter((perf_counter_t)i, inherit);
+#else
+    (void)inherit;
+    counters->handles[i] = -1;
+#endif
+    if (counters->handles[i] >= 0)
+      any_available = 1;
+  }
+  return any_available;
+}
+
+void StartPerfCounters(perf_counters_t * const counters)
+{
+#ifdef __linux__
+  size_t i;
+  for (i = 0; i < NUM_PERF_COUNTERS; i++)
+  {
+    if (counters->handles[i] >= 0)
+    {
+      ioctl(counters->handles[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(counters->handles[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#else
+  (void)counters;
+#endif
+}
+
+void StopPerfCounters(perf_counters_t * const counters, perf_counter_values_t * const values)
+{
+  size_t i;
+  ClearPerfCounterValues(values);
+  for (i = 0; i < NUM_PERF_COUNTERS; i++)
+  {
+#ifdef __linux__
+    if (counters->handles[i] >= 0)
+    {
+      ioctl(counters->handles[i], PERF_EVENT_IOC_DISABLE, 0);
+      values->available[i] = ReadPerfCounter(counters->handles[i], &values->values[i]);
+    }
+#else
+    (void)counters;
+#endif
+  }
+}
+
+void ClosePerfCounters(perf_counters_t * const counters)
+{
+  size_t i;
+  for (i = 0; i < NUM_PERF_COUNTERS; i++)
+  {
+#ifdef __linux__
+    if (counters->handles[i] >= 0)
+      close(counters->handles[i]);
+#endif
+    counters->handles[i] = -1;
+  }
+}
+
+void ClearPerfCounterValues(perf_counter_values_t * const values)
+{
+  size_t i;
+  for (i = 0; i < NUM_PERF_COUNTERS; i++)
+  {
+    values->values[i] = 0;
+    values->available[i] = 0;
+  }
+}
+
+const char *GetPerfCounterName(const perf_counter_t counter)
+{
+  return counter_names[counter];
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+/* Thread wrapper
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "err_codes.h"
+#include "thread.h"
+
+#ifdef _WIN32
+  #include <process.h>
+#else
+  #include <unistd.h>
+#endif
+
+#ifdef _WIN32
+static unsigned __stdcall RunThread(void * const thread_addr)
+#else
+static void *RunThread(void * const thread_addr)
+#endif
+{
+  thread_t * const thread = (thread_t * const)thread_addr;
+  (*thread->function)(thread->caller_info);
+  return 0;
+}
+
+int StartThread(thread_t * const thread, thread_function_t * const function, void * const caller_info)
+{
+  thread->function = function;
+  thread->caller_info = caller_info;
+#ifdef _WIN32
+  if ((thread->handle = (HANDLE)_beginthreadex(NULL, 0, &RunThread, thread, 0, NULL)) == 0)
+    return ERROR_LIBRARY_CALL;
+#else
+  if (pthread_create(&thread->handle, NULL, &RunThread, thread) != 0)
+    return ERROR_LIBRARY_CALL;
+#endif
+  return NO_ERROR;
+}
+
+int JoinThread(thread_t * const thread)
+{
+#ifdef _WIN32
+  const int ret = WaitForSingleObject(thread->handle, INFINITE) == WAIT_OBJECT_0 ? NO_ERROR : ERROR_LIBRARY_CALL;
+  CloseHandle(thread->handle);
+  return ret;
+#else
+  return pthread_join(thread->handle, NULL) == 0 ? NO_ERROR : ERROR_LIBRARY_CALL;
+#endif
+}
+
+size_t GetNumberOfProcessors(void)
+{
+#ifdef _WIN32
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  return system_info.dwNumberOfProcessors != 0 ? (size_t)system_info.dwNumberOfProcessors : 1;
+#else
+  const long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+  return num_processors > 0 ? (size_t)num_processors : 1;
+#endif
+}
+
+int InitMutex(mutex_t * const mutex)
+{
+#ifdef _WIN32
+  InitializeCriticalSection(&mutex->handle);
+  return NO_ERROR;
+#else
+  return pthread_mutex_init(&mutex->handle, NULL) == 0 ? NO_ERROR : ERROR_LIBRARY_INIT;
+#endif
+}
+
+void UninitMutex(mutex_t * const mutex)
+{
+#ifdef _WIN32
+  DeleteCriticalSection(&mutex->handle);
+#else
+  pthread_mutex_destroy(&mutex->handle);
+#endif
+}
+
+void LockMutex(mutex_t * const mutex)
+{
+#ifdef _WIN32
+  EnterCriticalSection(&mutex->handle);
+#else
+  pthread_mutex_lock(&mutex->handle);
+#endif
+}
+
+void UnlockMutex(mutex_t * const mutex)
+{
+#ifdef _WIN32
+  LeaveCriticalSection(&mutex->handle);
+#else
+  pthread_mutex_unlock(&mutex->handle);
+#endif
+}
+
+int InitCondition(condition_t * const condition)
+{
+#ifdef _WIN32
+  InitializeConditionVariable(&condition->handle);
+  return NO_ERROR;
+#else
+  return pthread_cond_init(&condition->handle, NULL) == 0 ? NO_ERROR : ERROR_LIBRARY_INIT;
+#endif
+}
+
+void UninitCondition(condition_t * const condition)
+{
+#ifdef _WIN32
+  (void)condition; /* Condition variables do not need to be destroyed */
+#else
+  pthread_cond_destroy(&condition->handle);
+#endif
+}
+
+void WaitCondition(condition_t * const condition, mutex_t * const mutex)
+{
+#ifdef _WIN32
+  SleepConditionVariableCS(&condition->handle, &mutex->handle, INFINITE);
+#else
+  pthread_cond_wait(&condition->handle, &mutex->handle);
+#endif
+}
+
+void SignalCondition(condition_t * const condition)
+{
+#ifdef _WIN32
+  WakeAllConditionVariable(&condition->handle);
+#else
+  pthread_cond_broadcast(&condition->handle);
+#endif
+}
\ No newline at end of file
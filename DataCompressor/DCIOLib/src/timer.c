@@ -0,0 +1,45 @@
+/* Timer wrapper
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "timer.h"
+
+#include <time.h>
+#ifdef _WIN32
+  #include <windows.h>
+#endif
+
+double GetWallClockTime(void)
+{
+#ifdef _WIN32
+  LARGE_INTEGER counter, frequency;
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&frequency);
+  return (double)counter.QuadPart / frequency.QuadPart;
+#else
+  struct timespec time;
+  if (clock_gettime(CLOCK_MONOTONIC, &time) != 0)
+    return (double)clock() / CLOCKS_PER_SEC; /* Fall back to processor time */
+  return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
+
+double GetProcessorTime(void)
+{
+#ifdef _WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  ULARGE_INTEGER kernel, user;
+  if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time))
+    return (double)clock() / CLOCKS_PER_SEC;
+  kernel.LowPart = kernel_time.dwLowDateTime;
+  kernel.HighPart = kernel_time.dwHighDateTime;
+  user.LowPart = user_time.dwLowDateTime;
+  user.HighPart = user_time.dwHighDateTime;
+  return (kernel.QuadPart + user.QuadPart) * 1e-7; /* 100 ns units */
+#else
+  struct timespec time;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+    return (double)clock() / CLOCKS_PER_SEC;
+  return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
\ No newline at end of file
@@ -9,5 +9,6 @@
 #include "enc_dec.h"
 
 io_int_t Aggregate(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
+io_uint_t GetAggregateOutputBound(const io_uint_t input_bits, const options_t * const options);
 
 #endif
\ No newline at end of file
@@ -8,7 +8,38 @@
 #include "bit_file_buffer.h"
 #include "enc_dec.h"
 
+/* Number of bits (precision) to represent the coding range [0,1] */
+#define RANGE_BITS 16
+
+/* For intermediate range size calculations, we need a type which is at least twice as large as the type which specifies the ranges */
+#if 2 * RANGE_BITS > IO_SIZE_BITS
+  #error "RANGE_BITS must be at most half as large as IO_SIZE_BITS"
+#endif
+
+typedef UINT_TYPE(RANGE_BITS) range_t;
+
+#define NUMBER_OF_SYMBOLS 2 /* Binary arithmetic coding (2 symbols) */
+#define TOTAL_NUMBER_OF_SYMBOLS (NUMBER_OF_SYMBOLS + 1) /* Number of symbols including EOF symbol */
+
+typedef struct bac_state_t /* Model and coder state (one instance per encoder/decoder run so that multiple runs can take place in parallel). Do not access directly */
+{
+  size_t symbol_to_index[NUMBER_OF_SYMBOLS];
+  int index_to_symbol[TOTAL_NUMBER_OF_SYMBOLS + 1];
+  range_t symbol_frequencies[TOTAL_NUMBER_OF_SYMBOLS + 1];
+  range_t cumulative_symbol_frequencies[TOTAL_NUMBER_OF_SYMBOLS + 1];
+  range_t start_range, end_range;
+  size_t next_bits; /* Encoding only */
+  range_t current_value; /* Decoding only */
+  size_t after_eof_bits; /* Decoding only */
+} bac_state_t;
+
 io_int_t EncodeBAC(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
 io_int_t DecodeBAC(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
+io_uint_t GetBACOutputBound(const io_uint_t input_bits, const options_t * const options);
+
+/* Incremental encoding of bits which are not read from a bit file buffer (same output as EncodeBAC for the same sequence of bits) */
+void StartBACEncoder(bac_state_t * const state);
+io_int_t EncodeBACBits(bac_state_t * const state, const io_uint_t bits, const size_t num_bits, const int adaptive, bit_file_buffer_t * const out_bit_buf, FILE * const error_log_file); /* Encodes the num_bits LSBs of bits, MSB first */
+io_int_t FinishBACEncoder(bac_state_t * const state, bit_file_buffer_t * const out_bit_buf, FILE * const error_log_file);
 
 #endif
\ No newline at end of file
@@ -8,7 +8,22 @@
 #include "bit_file_buffer.h"
 #include "enc_dec.h"
 
+#include <float.h>
+
+#define FLOAT_TEXT_BUFFER_SIZE (1 /*'-'*/ + (FLT_MAX_10_EXP + 1) /*38+1 digits*/ + 1 /*'.'*/ + FLT_DIG /*Default precision*/ + 1 /*\0*/) /* Adopted from http://stackoverflow.com/questions/7235456/what-are-the-maximum-numbers-of-characters-output-by-sprintf-when-outputting-flo */
+
+typedef struct csv_reader_t /* Parser state between calls of ReadCSVValues. Do not access directly */
+{
+  size_t column;
+  char buffer[FLOAT_TEXT_BUFFER_SIZE];
+  size_t used_buffer;
+} csv_reader_t;
+
 io_int_t ReadCSV(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
 io_int_t WriteCSV(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
+io_uint_t GetCSVOutputBound(const io_uint_t input_bits, const options_t * const options);
+
+void InitCSVReader(csv_reader_t * const reader);
+io_int_t ReadCSVValues(csv_reader_t * const reader, bit_file_buffer_t * const in_bit_buf, float * const values, const size_t max_num_values, size_t * const num_values, const options_t * const options); /* Reads up to max_num_values values (fewer only at the end of the input) */
 
 #endif
\ No newline at end of file
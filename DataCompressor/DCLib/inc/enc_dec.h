@@ -10,6 +10,8 @@
 typedef struct options_t options_t; /* Forward declaration for settings parameter type */
 typedef io_int_t enc_dec_function_t(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
 
+typedef io_uint_t output_bound_function_t(const io_uint_t input_bits, const options_t * const options); /* Maximum number of output bits for input_bits input bits (MAX_IO_UINT_VALUE if there is no bound or if it is too large) */
+
 typedef struct enc_dec_t
 {
   enc_dec_function_t * const encoder;
@@ -47,6 +49,8 @@ const enc_dec_t *GetEncoder(const char * const name);
 const char * GetEncoderDescription(const char * const name);
 const char *GetEncoderNameFromFunction(enc_dec_function_t * const function, const int encoder);
 
+io_uint_t GetOutputBound(const options_t * const options, const io_uint_t input_bits); /* Worst-case number of output bits of the encoder/decoder selected by options (see output_bound_function_t) */
+
 size_t GetNumberOfOptions(void);
 void GetOptionNames(const char ** const option_names);
 int OptionNameExists(const char * const name);
@@ -0,0 +1,17 @@
+/* Fused encoder chains (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _FUSED_H
+#define _FUSED_H
+
+#include "bit_file_buffer.h"
+#include "enc_dec.h"
+
+/* Fused chains process each value through several consecutive encoders/decoders at once instead of passing all values from one encoder/decoder to the next through intermediate bit file buffers. The output is identical (on errors, the encoders/decoders after the failing one may already have written the output of previous values, whereas separate encoders/decoders stop before the next one starts).
+   Supported chains: decode csv # encode normalize [# encode diff [# encode seg [# encode bac]]] with the same valuesize for normalize, diff and seg */
+
+size_t GetNumberOfFusedEncoders(const options_t * const * const options, const size_t num_options); /* Number of encoders/decoders at the start of the list which RunFusedEncoders can process at once (0 if there is no fused chain) */
+io_int_t RunFusedEncoders(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const * const options, const size_t num_fused_options, size_t * const error_stage); /* error_stage is set to the index of the encoder/decoder in the fused chain which caused an error (if any) */
+
+#endif
\ No newline at end of file
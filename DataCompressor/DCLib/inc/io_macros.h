@@ -10,6 +10,12 @@
 #define LOG_IO_ERROR_FORMAT_STRING(read, ret, num_bits) "Only %s %" IO_INT_FORMAT " bits instead of %" SIZE_T_FORMAT "\n", (read) ? "read" : "wrote", (ret), SIZE_T_CAST((num_bits))
 #define LOG_ERROR_FORMAT_STRING(read, ret, num_bits) "%s while trying to %s %" SIZE_T_FORMAT " bits\n", ERROR_MESSAGE_STRING(ret), (read) ? "read" : "write", SIZE_T_CAST((num_bits))
 
+/* A full fixed-size output buffer (see InitFileBufferToMemory in DCIOLib) is not logged since the caller is expected to retry with a larger one */
+#define LOG_ERROR_UNLESS_OUTPUT_FULL(ret, error_log_file, ...) { \
+  if ((ret) != ERROR_OUTPUT_FULL) \
+    LOG_ERROR((error_log_file), __VA_ARGS__); \
+}
+
 #define LOG_ON_ERROR_AND_RETURN(ret, num_bits, error_log_file, read) { \
   if ((ret) != (io_int_t)(num_bits)) \
   { \
@@ -20,7 +26,7 @@
     } \
     else \
     { \
-      LOG_ERROR((error_log_file), LOG_ERROR_FORMAT_STRING((read), (ret), (num_bits))); \
+      LOG_ERROR_UNLESS_OUTPUT_FULL((ret), (error_log_file), LOG_ERROR_FORMAT_STRING((read), (ret), (num_bits))); \
       return (ret); \
     } \
   } \
@@ -37,7 +43,7 @@
     } \
     else \
     { \
-      LOG_ERROR((error_log_file), LOG_ERROR_FORMAT_STRING((read), (ret), (num_bits))); \
+      LOG_ERROR_UNLESS_OUTPUT_FULL((ret), (error_log_file), LOG_ERROR_FORMAT_STRING((read), (ret), (num_bits))); \
       (action); \
       return (ret); \
     } \
@@ -86,7 +92,119 @@
   } \
 }
 
+#define PEEK_BITS_CHECKED(value, num_bits, available_bits, in_bit_buf, error_log_file) { \
+  { \
+    io_int_t ret = PeekBitFileBuffer((in_bit_buf), (value), (num_bits)); \
+    if (ret < 0) \
+    { \
+      LOG_ERROR((error_log_file), LOG_ERROR_FORMAT_STRING(1, ret, (num_bits))); \
+      return ret; \
+    } \
+    (available_bits) = (size_t)ret; \
+  } \
+}
+
+#define SKIP_BITS_CHECKED(num_bits, in_bit_buf, error_log_file) { \
+  { \
+    io_int_t ret = SkipBitFileBuffer((in_bit_buf), (num_bits)); \
+    LOG_ON_ERROR_AND_RETURN(ret, (num_bits), (error_log_file), 1); \
+  } \
+}
+
+/* Number of values processed at once by block-based encoders/decoders */
+#define VALUE_BLOCK_SIZE 1024
+
+/* Logs and returns read errors. An incomplete last value is logged and reported through incomplete_ret instead so that the complete values read before it can still be processed and written (as when reading value by value) */
+#define LOG_ON_INCOMPLETE_BLOCK_AND_RETURN(ret, value_bits, error_log_file, read, incomplete_ret) { \
+  if ((ret) < 0) \
+  { \
+    LOG_ERROR((error_log_file), LOG_ERROR_FORMAT_STRING((read), (ret), (value_bits))); \
+    return (ret); \
+  } \
+  if ((ret) % (io_int_t)(value_bits) != 0) /* Last value is incomplete */ \
+  { \
+    LOG_ERROR((error_log_file), LOG_IO_ERROR_FORMAT_STRING((read), (ret) % (io_int_t)(value_bits), (value_bits))); \
+    (incomplete_ret) = ERROR_LIBRARY_CALL; \
+  } \
+}
+
+#define READ_BLOCK_BITS_CHECKED(bits, max_num_values, num_values, value_bits, in_bit_buf, error_log_file, incomplete_ret) { \
+  { \
+    io_int_t ret = ReadBitFileBuffer((in_bit_buf), (bits), (max_num_values) * (value_bits)); \
+    LOG_ON_INCOMPLETE_BLOCK_AND_RETURN(ret, (value_bits), (error_log_file), 1, (incomplete_ret)); \
+    (num_values) = (size_t)ret / (value_bits); \
+  } \
+}
+
+#define READ_BLOCK_VALUES_CHECKED(values, max_num_values, num_values, value_bits, in_bit_buf, error_log_file, incomplete_ret) { \
+  { \
+    io_int_t ret = ReadValuesFromBitFileBuffer((in_bit_buf), (values), (max_num_values), (value_bits)); \
+    LOG_ON_INCOMPLETE_BLOCK_AND_RETURN(ret, (value_bits), (error_log_file), 1, (incomplete_ret)); \
+    (num_values) = (size_t)ret / (value_bits); \
+  } \
+}
+
+#define WRITE_BLOCK_VALUES_CHECKED(values, num_values, value_bits, out_bit_buf, error_log_file) { \
+  { \
+    io_int_t ret = WriteValuesToBitFileBuffer((out_bit_buf), (values), (num_values), (value_bits)); \
+    LOG_ON_ERROR_AND_RETURN(ret, (num_values) * (value_bits), (error_log_file), 0); \
+  } \
+}
+
+#define LOG_SPAN_ERROR_FORMAT_STRING(ret, action, size) "%s while trying to %s %" SIZE_T_FORMAT " bytes\n", ERROR_MESSAGE_STRING(ret), (action), SIZE_T_CAST((size))
+
+#define ACQUIRE_READ_SPAN_CHECKED(span, span_size, max_size, in_bit_buf, error_log_file) { \
+  { \
+    io_int_t ret = AcquireBitFileBufferReadSpan((in_bit_buf), &(span), (max_size)); \
+    if (ret < 0) \
+    { \
+      LOG_ERROR((error_log_file), LOG_SPAN_ERROR_FORMAT_STRING(ret, "acquire", (max_size))); \
+      return ret; \
+    } \
+    (span_size) = (size_t)ret; \
+  } \
+}
+
+#define RELEASE_READ_SPAN_CHECKED(size, in_bit_buf, error_log_file) { \
+  { \
+    int ret = ReleaseBitFileBufferReadSpan((in_bit_buf), (size)); \
+    if (ret != NO_ERROR) \
+    { \
+      LOG_ERROR((error_log_file), LOG_SPAN_ERROR_FORMAT_STRING(ret, "release", (size))); \
+      return ret; \
+    } \
+  } \
+}
+
+#define RESERVE_WRITE_SPAN_CHECKED(span, span_size, min_size, out_bit_buf, error_log_file) { \
+  { \
+    io_int_t ret = ReserveBitFileBufferWriteSpan((out_bit_buf), &(span), (min_size)); \
+    if (ret < 0) \
+    { \
+      LOG_ERROR_UNLESS_OUTPUT_FULL(ret, (error_log_file), LOG_SPAN_ERROR_FORMAT_STRING(ret, "reserve", (min_size))); \
+      return ret; \
+    } \
+    (span_size) = (size_t)ret; \
+  } \
+}
+
+#define COMMIT_WRITE_SPAN_CHECKED(size, out_bit_buf, error_log_file) { \
+  { \
+    int ret = CommitBitFileBufferWriteSpan((out_bit_buf), (size)); \
+    if (ret != NO_ERROR) \
+    { \
+      LOG_ERROR((error_log_file), LOG_SPAN_ERROR_FORMAT_STRING(ret, "commit", (size))); \
+      return ret; \
+    } \
+  } \
+}
+
 #define EXTEND_IO_INT_SIGN(value, value_bits) ((value_bits) == IO_SIZE_BITS ? (value) : /* Nothing to extend */ \
   ((value) << (IO_SIZE_BITS - (value_bits))) >> (IO_SIZE_BITS - (value_bits))) /* Extend MSB */
 
+/* Saturating arithmetic for output bounds, i.e., results larger than MAX_IO_UINT_VALUE become MAX_IO_UINT_VALUE (unbounded). Arguments are evaluated more than once */
+#define OUTPUT_BOUND_SUM(a, b) ((a) > MAX_IO_UINT_VALUE - (b) ? MAX_IO_UINT_VALUE : (a) + (b))
+#define OUTPUT_BOUND_PRODUCT(a, b) ((b) != 0 && (a) > MAX_IO_UINT_VALUE / (b) ? MAX_IO_UINT_VALUE : (a) * (b))
+#define OUTPUT_BOUND_UNITS(bits, unit_bits) ((bits) / (unit_bits) + ((bits) % (unit_bits) != 0)) /* Number of units of unit_bits bits size including an incomplete last one */
+
 #endif
\ No newline at end of file
@@ -10,5 +10,6 @@
 
 io_int_t EncodeLZMH(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
 io_int_t DecodeLZMH(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
+io_uint_t GetLZMHOutputBound(const io_uint_t input_bits, const options_t * const options);
 
 #endif
\ No newline at end of file
@@ -10,5 +10,6 @@
 
 io_int_t Normalize(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
 io_int_t Denormalize(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
+io_uint_t GetNormalizationOutputBound(const io_uint_t input_bits, const options_t * const options);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,30 @@
+/* Encoder/decoder pipeline (header)
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#ifndef _PIPELINE_H
+#define _PIPELINE_H
+
+#include "bit_file_buffer.h"
+#include "enc_dec.h"
+
+typedef struct pipeline_t pipeline_t;
+
+typedef void pipeline_stage_function_t(const options_t * const * const options, const size_t first_stage, const size_t num_stages, const size_t total_stages, bit_file_buffer_t * const read_bit_buf, bit_file_buffer_t * const write_bit_buf, const int finished, void * const caller_info); /* Called before (finished is 0) and after (finished is 1, only on success) each encoder/decoder or fused chain of num_stages encoders/decoders, starting with options[first_stage] */
+
+pipeline_t *AllocatePipeline(void);
+void FreePipeline(pipeline_t * const pipeline);
+
+int InitPipeline(pipeline_t * const pipeline, options_t * const * const options, const size_t num_options, const int fuse_encoders, const size_t memory_budget); /* The options are used by reference when compressing and copied for decompressing. memory_budget limits the temporary buffers (0 means unlimited) */
+void UninitPipeline(pipeline_t * const pipeline);
+
+void SetPipelineStageFunction(pipeline_t * const pipeline, pipeline_stage_function_t * const stage_function, void * const caller_info); /* NULL disables notifications */
+int GetPipelineBufferSizes(const pipeline_t * const pipeline, size_t * const temp_read_size, size_t * const temp_write_size); /* Current size of the temporary buffers. Returns 0 if there are none (only one encoder/decoder) */
+
+int RunPipelineStages(pipeline_t * const pipeline, bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf); /* Runs all encoders/decoders one after another (compressing) */
+
+size_t GetPipelineOutputBound(const pipeline_t * const pipeline, const size_t input_size, const int compress); /* Worst-case output size in bytes of CompressToMemory (compress is not 0) or DecompressToMemory for input_size bytes of input (MAX_USABLE_SIZE if there is no usable bound) */
+int CompressToMemory(pipeline_t * const pipeline, const uint8_t * const input, const size_t input_size, uint8_t * const output, const size_t output_size, size_t * const used_output_size); /* Runs all encoders/decoders on input_size bytes of input and writes the output (padded to whole bytes) directly to output. Returns ERROR_OUTPUT_FULL (without logging an error) as soon as it does not fit into output_size bytes, i.e., the caller has to retry with a larger output buffer (at most GetPipelineOutputBound bytes) */
+int DecompressToMemory(pipeline_t * const pipeline, const uint8_t * const input, const size_t input_size, uint8_t * const output, const size_t output_size, size_t * const used_output_size); /* Runs the decoders/encoders inverse to the ones the pipeline has been initialized with in reverse order */
+
+#endif
\ No newline at end of file
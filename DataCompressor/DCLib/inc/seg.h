@@ -10,5 +10,9 @@
 
 io_int_t EncodeSEG(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
 io_int_t DecodeSEG(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options);
+io_uint_t GetSEGOutputBound(const io_uint_t input_bits, const options_t * const options);
+
+io_uint_t GetSEGCodeword(const io_int_t value, size_t * const prefix_length); /* The code word consists of prefix_length zeros, followed by the 1 + prefix_length LSBs of the return value */
+io_int_t EncodeSEGCodeword(const io_int_t value, bit_file_buffer_t * const out_bit_buf, FILE * const error_log_file);
 
 #endif
\ No newline at end of file
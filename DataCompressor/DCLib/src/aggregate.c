@@ -8,20 +8,45 @@
 
 io_int_t Aggregate(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options)
 {
-  while (!EndOfBitFileBuffer(in_bit_buf))
+  const size_t value_size = 8 * sizeof(float);
+  float values[VALUE_BLOCK_SIZE], sums[VALUE_BLOCK_SIZE];
+  float sum = 0;
+  size_t num_summed_values = 0, num_sums = 0;
+  if (options->num_values == 0) /* Nothing to aggregate */
+    return ERROR_INVALID_VALUE;
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
   {
-    float sum = 0;
-    const size_t value_size = 8 * sizeof(sum);
-    size_t i;
-    for (i = 0; i < options->num_values; i++)
+    size_t i, num_values;
+    io_int_t incomplete_ret = NO_ERROR;
+    READ_BLOCK_BITS_CHECKED((uint8_t * const)values, VALUE_BLOCK_SIZE, num_values, value_size, in_bit_buf, options->error_log_file, incomplete_ret);
+    for (i = 0; i < num_values; i++)
     {
-      float value;
-      READ_BITS_CHECKED((uint8_t * const)&value, value_size, in_bit_buf, options->error_log_file);
-      sum += value;
-      if (EndOfBitFileBuffer(in_bit_buf)) /* Stop aggregating if there are no more values */
-        break;
+      sum += values[i];
+      if (++num_summed_values == options->num_values)
+      {
+        sums[num_sums++] = sum;
+        sum = 0;
+        num_summed_values = 0;
+      }
     }
+    if (num_sums != 0)
+    {
+      WRITE_BITS_CHECKED((const uint8_t * const)sums, num_sums * value_size, out_bit_buf, options->error_log_file);
+      num_sums = 0;
+    }
+    if (incomplete_ret != NO_ERROR) /* Complete sums have been written */
+      return incomplete_ret;
+  }
+  if (num_summed_values != 0) /* Stop aggregating if there are no more values */
+  {
     WRITE_BITS_CHECKED((const uint8_t * const)&sum, value_size, out_bit_buf, options->error_log_file);
   }
   return NO_ERROR;
+}
+
+io_uint_t GetAggregateOutputBound(const io_uint_t input_bits, const options_t * const options)
+{
+  const size_t value_size = 8 * sizeof(float);
+  (void)options; /* At most one sum per value */
+  return OUTPUT_BOUND_PRODUCT(OUTPUT_BOUND_UNITS(input_bits, value_size), value_size);
 }
\ No newline at end of file
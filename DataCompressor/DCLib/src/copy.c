@@ -5,25 +5,92 @@
 #include "err_codes.h"
 #include "io_macros.h"
 #include "copy.h"
+#include "allocation.h"
 
 #include <stdlib.h>
+#include <string.h>
+
+static io_int_t CopyBytes(bit_file_buffer_t * const out_bit_buf, const uint8_t * const input, const size_t num_bytes, const options_t * const options)
+{
+  size_t copied = 0;
+  while (copied < num_bytes)
+  {
+    uint8_t *span;
+    size_t span_size;
+    RESERVE_WRITE_SPAN_CHECKED(span, span_size, 1, out_bit_buf, options->error_log_file);
+    if (span_size > num_bytes - copied)
+      span_size = num_bytes - copied;
+    memcpy(span, &input[copied], span_size);
+    COMMIT_WRITE_SPAN_CHECKED(span_size, out_bit_buf, options->error_log_file);
+    copied += span_size;
+  }
+  return NO_ERROR;
+}
+
+static io_int_t CopyByteBlocks(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, uint8_t * const buffer, const size_t num_bytes, const options_t * const options) /* Copies whole blocks in place; incomplete blocks are collected in buffer */
+{
+  size_t used_buffer = 0;
+  io_int_t ret;
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
+  {
+    const uint8_t *span;
+    size_t span_size, span_used = 0, whole_block_size;
+    ACQUIRE_READ_SPAN_CHECKED(span, span_size, MAX_USABLE_SIZE, in_bit_buf, options->error_log_file);
+    if (used_buffer != 0) /* Complete previous block first */
+    {
+      span_used = num_bytes - used_buffer < span_size ? num_bytes - used_buffer : span_size;
+      memcpy(&buffer[used_buffer], span, span_used);
+      if ((used_buffer += span_used) == num_bytes)
+      {
+        if ((ret = CopyBytes(out_bit_buf, buffer, num_bytes, options)) != NO_ERROR)
+          return ret;
+        used_buffer = 0;
+      }
+    }
+    whole_block_size = (span_size - span_used) / num_bytes * num_bytes;
+    if ((ret = CopyBytes(out_bit_buf, &span[span_used], whole_block_size, options)) != NO_ERROR)
+      return ret;
+    span_used += whole_block_size;
+    memcpy(&buffer[used_buffer], &span[span_used], span_size - span_used); /* Keep beginning of incomplete block */
+    used_buffer += span_size - span_used;
+    RELEASE_READ_SPAN_CHECKED(span_size, in_bit_buf, options->error_log_file);
+  }
+  if (used_buffer != 0) /* Incomplete last block */
+  {
+    LOG_ERROR(options->error_log_file, LOG_IO_ERROR_FORMAT_STRING(1, (io_int_t)(8 * used_buffer), 8 * num_bytes));
+    return ERROR_LIBRARY_CALL;
+  }
+  return NO_ERROR;
+}
 
 io_int_t Copy(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options)
 {
   const size_t num_bits = options->block_size_bits;
   const size_t num_bytes = (options->block_size_bits + 7) / 8; /* Always round towards +inf */
   const size_t buf_size = (size_t)(sizeof(uint8_t) * num_bytes);
-  uint8_t * const buffer = (uint8_t*)malloc(buf_size);
+  uint8_t * const buffer = (uint8_t*)AllocateMemory(buf_size);
   if (buffer == NULL)
   {
     LOG(options->error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes. Use a smaller block size\n", SIZE_T_CAST(buf_size));
     return ERROR_MEMORY;
   }
-  while (!EndOfBitFileBuffer(in_bit_buf))
+  if (num_bits % 8 == 0) /* Byte-aligned blocks can be copied without bit-wise reading and writing */
   {
-    READ_BITS_CHECKED_WITH_ACTION_ON_ERROR(buffer, num_bits, in_bit_buf, options->error_log_file, free(buffer));
-    WRITE_BITS_CHECKED_WITH_ACTION_ON_ERROR(buffer, num_bits, out_bit_buf, options->error_log_file, free(buffer));
+    const io_int_t ret = CopyByteBlocks(in_bit_buf, out_bit_buf, buffer, num_bytes, options);
+    FreeMemory(buffer);
+    return ret;
   }
-  free(buffer);
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
+  {
+    READ_BITS_CHECKED_WITH_ACTION_ON_ERROR(buffer, num_bits, in_bit_buf, options->error_log_file, FreeMemory(buffer));
+    WRITE_BITS_CHECKED_WITH_ACTION_ON_ERROR(buffer, num_bits, out_bit_buf, options->error_log_file, FreeMemory(buffer));
+  }
+  FreeMemory(buffer);
   return NO_ERROR;
+}
+
+io_uint_t GetCopyOutputBound(const io_uint_t input_bits, const options_t * const options)
+{
+  (void)options;
+  return input_bits;
 }
\ No newline at end of file
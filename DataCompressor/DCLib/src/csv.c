@@ -6,60 +6,135 @@
 #include "io_macros.h"
 #include "csv.h"
 
-#include <float.h>
-
-#define FLOAT_TEXT_BUFFER_SIZE (1 /*'-'*/ + (FLT_MAX_10_EXP + 1) /*38+1 digits*/ + 1 /*'.'*/ + FLT_DIG /*Default precision*/ + 1 /*\0*/) /* Adopted from http://stackoverflow.com/questions/7235456/what-are-the-maximum-numbers-of-characters-output-by-sprintf-when-outputting-flo */
+void InitCSVReader(csv_reader_t * const reader)
+{
+  reader->column = 1;
+  reader->used_buffer = 0;
+}
 
-io_int_t ReadCSV(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options)
+io_int_t ReadCSVValues(csv_reader_t * const reader, bit_file_buffer_t * const in_bit_buf, float * const values, const size_t max_num_values, size_t * const num_values, const options_t * const options)
 {
-  size_t column = 1;
-  char current_char;
-  const size_t current_char_size = 8 * sizeof(current_char);
-  char buffer[FLOAT_TEXT_BUFFER_SIZE] = { 0 };
-  size_t used_buffer = 0;
-  while (!EndOfBitFileBuffer(in_bit_buf))
+  *num_values = 0;
+  while (*num_values < max_num_values && !END_OF_BIT_FILE_BUFFER(in_bit_buf))
   {
-    READ_BITS_CHECKED((uint8_t * const)&current_char, current_char_size, in_bit_buf, options->error_log_file);
-    if (current_char == options->separator_char || current_char == '\n' || EndOfBitFileBuffer(in_bit_buf))
+    const uint8_t *span;
+    size_t i, span_size;
+    ACQUIRE_READ_SPAN_CHECKED(span, span_size, MAX_USABLE_SIZE, in_bit_buf, options->error_log_file); /* Scan input in place */
+    for (i = 0; i < span_size; i++)
     {
-      if (EndOfBitFileBuffer(in_bit_buf) && column == options->column /* Text character from desired column */)
-        buffer[used_buffer++] = current_char;
-      if (column == options->column)
+      const char current_char = (char)span[i];
+      int end_of_input = 0;
+      if (i == span_size - 1) /* Release span after its last character to determine whether it is the last character of the input */
+      {
+        RELEASE_READ_SPAN_CHECKED(span_size, in_bit_buf, options->error_log_file);
+        if ((end_of_input = END_OF_BIT_FILE_BUFFER(in_bit_buf)) < 0)
+          return end_of_input;
+      }
+      if (current_char == options->separator_char || current_char == '\n' || end_of_input)
+      {
+        if (end_of_input && reader->column == options->column /* Text character from desired column */ && reader->used_buffer < FLOAT_TEXT_BUFFER_SIZE - 1)
+          reader->buffer[reader->used_buffer++] = current_char;
+        if (reader->column == options->column)
+        {
+          reader->buffer[reader->used_buffer++] = '\0'; /* Make sure that the string is terminated */
+          values[(*num_values)++] = strtof(reader->buffer, NULL); /* Interpret value as float */
+          reader->used_buffer = 0; /* Reset buffer */
+        }
+        reader->column++;
+      }
+      else if (reader->column == options->column && reader->used_buffer < FLOAT_TEXT_BUFFER_SIZE - 1) /* Text character from desired column (longer texts are truncated) */
+        reader->buffer[reader->used_buffer++] = current_char;
+      if (current_char == '\n') /* Next line */
+        reader->column = 1; /* Reset column */
+      if (*num_values == max_num_values) /* Leave the rest of the span for the next call */
       {
-        float value;
-        const size_t value_size = 8 * sizeof(value);
-        buffer[used_buffer++] = '\0'; /* Make sure that the string is terminated */
-        value = strtof(buffer, NULL); /* Interpret value as float */
-        WRITE_BITS_CHECKED((const uint8_t * const)&value, value_size, out_bit_buf, options->error_log_file);
-        used_buffer = 0; /* Reset buffer */
+        if (i != span_size - 1)
+          RELEASE_READ_SPAN_CHECKED(i + 1, in_bit_buf, options->error_log_file);
+        break;
       }
-      column++;
     }
-    else if (column == options->column) /* Text character from desired column */
-      buffer[used_buffer++] = current_char;
-    if (current_char == '\n') /* Next line */
-      column = 1; /* Reset column */
   }
   return NO_ERROR;
 }
 
+io_int_t ReadCSV(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options)
+{
+  const size_t value_size = 8 * sizeof(float);
+  csv_reader_t reader;
+  float values[VALUE_BLOCK_SIZE];
+  InitCSVReader(&reader);
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
+  {
+    size_t num_values;
+    io_int_t ret;
+    if ((ret = ReadCSVValues(&reader, in_bit_buf, values, VALUE_BLOCK_SIZE, &num_values, options)) != NO_ERROR)
+      return ret;
+    WRITE_BITS_CHECKED((const uint8_t * const)values, num_values * value_size, out_bit_buf, options->error_log_file);
+  }
+  return NO_ERROR;
+}
+
+static io_int_t WriteCSVLine(bit_file_buffer_t * const out_bit_buf, const float value, const options_t * const options) /* Formats the line before writing it, i.e., only writes as many bytes as required */
+{
+  char line[FLOAT_TEXT_BUFFER_SIZE + 1 /*'\n'*/]; /* At most FLT_DIG decimal places */
+  io_int_t retval;
+  size_t j;
+  for (j = 1; j < options->column; j++) /* Create empty columns if necessary */
+    WRITE_BITS_CHECKED((const uint8_t * const)&options->separator_char, 8, out_bit_buf, options->error_log_file);
+  if ((retval = (io_int_t)sprintf(line, "%.*f\n", (int)options->num_decimal_places, value)) < 0)
+    return ERROR_MEMORY;
+  WRITE_BITS_CHECKED((const uint8_t * const)line, 8 * (size_t)retval, out_bit_buf, options->error_log_file);
+  return NO_ERROR;
+}
+
 io_int_t WriteCSV(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options)
 {
-  while (!EndOfBitFileBuffer(in_bit_buf))
+  const size_t value_size = 8 * sizeof(float);
+  const size_t max_line_size = (options->column - 1) /*Empty columns*/ + FLOAT_TEXT_BUFFER_SIZE - FLT_DIG + options->num_decimal_places + 1 /*'\n'*/;
+  float values[VALUE_BLOCK_SIZE];
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
   {
-    io_int_t retval;
-    float value;
-    const size_t value_size = 8 * sizeof(value);
-    size_t i;
-    char buffer[FLOAT_TEXT_BUFFER_SIZE];
-    READ_BITS_CHECKED((uint8_t * const)&value, value_size, in_bit_buf, options->error_log_file);
-    for (i = 1; i < options->column; i++) /* Create empty columns if necessary */
+    size_t i = 0, num_values;
+    io_int_t incomplete_ret = NO_ERROR;
+    READ_BLOCK_BITS_CHECKED((uint8_t * const)values, VALUE_BLOCK_SIZE, num_values, value_size, in_bit_buf, options->error_log_file, incomplete_ret);
+    while (i < num_values)
     {
-      WRITE_BITS_CHECKED((const uint8_t * const)&options->separator_char, 8 * sizeof(options->separator_char), out_bit_buf, options->error_log_file);
+      uint8_t *span;
+      size_t span_size, used_span = 0;
+      RESERVE_WRITE_SPAN_CHECKED(span, span_size, max_line_size, out_bit_buf, options->error_log_file);
+      if (span_size < max_line_size) /* Close to the end of fixed-size output memory (see InitFileBufferToMemory in DCIOLib) */
+      {
+        io_int_t ret;
+        if ((ret = WriteCSVLine(out_bit_buf, values[i++], options)) != NO_ERROR)
+          return ret;
+        continue;
+      }
+      for (; i < num_values && span_size - used_span >= max_line_size; i++) /* Print as many lines as fit directly into the output buffer */
+      {
+        io_int_t retval;
+        size_t j;
+        for (j = 1; j < options->column; j++) /* Create empty columns if necessary */
+          span[used_span++] = (uint8_t)options->separator_char;
+        if ((retval = (io_int_t)sprintf((char*)&span[used_span], "%.*f\n", (int)options->num_decimal_places, values[i])) < 0)
+          return ERROR_MEMORY;
+        used_span += (size_t)retval; /* Number of characters in bytes! */
+      }
+      COMMIT_WRITE_SPAN_CHECKED(used_span, out_bit_buf, options->error_log_file);
     }
-    if ((retval = (io_int_t)sprintf(buffer, "%.*f\n", (int)options->num_decimal_places, value)) < 0)
-      return ERROR_MEMORY;
-    WRITE_BITS_CHECKED((const uint8_t * const)buffer, 8 * (size_t)retval, out_bit_buf, options->error_log_file); /* Write number of characters in bytes! */
+    if (incomplete_ret != NO_ERROR) /* Complete values have been written */
+      return incomplete_ret;
   }
   return NO_ERROR;
+}
+
+io_uint_t GetCSVOutputBound(const io_uint_t input_bits, const options_t * const options)
+{
+  const size_t value_size = 8 * sizeof(float);
+  if (options->encode) /* One line per value */
+  {
+    const size_t max_line_size = (options->column - 1) /*Empty columns*/ + FLOAT_TEXT_BUFFER_SIZE - FLT_DIG + options->num_decimal_places + 1 /*'\n'*/;
+    return OUTPUT_BOUND_PRODUCT(OUTPUT_BOUND_UNITS(input_bits, value_size), (io_uint_t)(8 * max_line_size));
+  }
+  else /* Each value requires at least one character */
+    return OUTPUT_BOUND_PRODUCT(OUTPUT_BOUND_UNITS(input_bits, 8), value_size);
 }
\ No newline at end of file
@@ -8,16 +8,39 @@
 
 io_int_t EncodeDifferential(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options)
 {
+  const int check_range = options->value_size_bits != IO_SIZE_BITS;
+  const io_int_t min_diff_value = check_range ? -(io_int_t)((io_uint_t)1 << (options->value_size_bits - 1)) : 0;
+  const io_int_t max_diff_value = check_range ? (((io_int_t)1 << (options->value_size_bits - 1)) - 1) : 0;
   io_int_t last_value = 0;
-  while (!EndOfBitFileBuffer(in_bit_buf))
+  io_uint_t values[VALUE_BLOCK_SIZE], diff_values[VALUE_BLOCK_SIZE];
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
   {
-    io_int_t value, diff_value;
-    READ_VALUE_BITS_CHECKED((io_uint_t * const)&value, options->value_size_bits, in_bit_buf, options->error_log_file);
-    diff_value = value - last_value;
-    if (options->value_size_bits != IO_SIZE_BITS && (diff_value < (-(io_int_t)((io_uint_t)1 << (options->value_size_bits - 1))) || diff_value > ((((io_int_t)1 << (options->value_size_bits - 1)) - 1)))) /* Value range check */
-      return ERROR_INVALID_VALUE;
-    WRITE_VALUE_BITS_CHECKED((io_uint_t * const)&diff_value, options->value_size_bits, out_bit_buf, options->error_log_file);
-    last_value = value;
+    size_t i, num_values;
+    int out_of_range = 0;
+    io_int_t incomplete_ret = NO_ERROR;
+    READ_BLOCK_VALUES_CHECKED(values, VALUE_BLOCK_SIZE, num_values, options->value_size_bits, in_bit_buf, options->error_log_file, incomplete_ret);
+    if (num_values == 0)
+      return incomplete_ret;
+    diff_values[0] = values[0] - (io_uint_t)last_value;
+    for (i = 1; i < num_values; i++) /* Independent iterations (no loop-carried dependency) */
+      diff_values[i] = values[i] - values[i - 1];
+    if (check_range)
+    {
+      for (i = 0; i < num_values; i++) /* Value range check */
+        out_of_range |= (io_int_t)diff_values[i] < min_diff_value || (io_int_t)diff_values[i] > max_diff_value;
+      if (out_of_range) /* Write the differences before the first one out of range */
+      {
+        i = 0;
+        while ((io_int_t)diff_values[i] >= min_diff_value && (io_int_t)diff_values[i] <= max_diff_value)
+          i++;
+        WRITE_BLOCK_VALUES_CHECKED(diff_values, i, options->value_size_bits, out_bit_buf, options->error_log_file);
+        return ERROR_INVALID_VALUE;
+      }
+    }
+    WRITE_BLOCK_VALUES_CHECKED(diff_values, num_values, options->value_size_bits, out_bit_buf, options->error_log_file);
+    if (incomplete_ret != NO_ERROR) /* Complete values have been written */
+      return incomplete_ret;
+    last_value = (io_int_t)values[num_values - 1];
   }
   return NO_ERROR;
 }
@@ -25,14 +48,27 @@ io_int_t EncodeDifferential(bit_file_buffer_t * const in_bit_buf, bit_file_buffe
 io_int_t DecodeDifferential(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options)
 {
   io_int_t last_value = 0;
-  while (!EndOfBitFileBuffer(in_bit_buf))
+  io_uint_t values[VALUE_BLOCK_SIZE];
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
   {
-    io_int_t value;
-    READ_VALUE_BITS_CHECKED((io_uint_t * const)&value, options->value_size_bits, in_bit_buf, options->error_log_file);
-    value = EXTEND_IO_INT_SIGN(value, options->value_size_bits);
-    value += last_value;
-    WRITE_VALUE_BITS_CHECKED((const io_uint_t * const)&value, options->value_size_bits, out_bit_buf, options->error_log_file);
-    last_value = value;
+    size_t i, num_values;
+    io_int_t incomplete_ret = NO_ERROR;
+    READ_BLOCK_VALUES_CHECKED(values, VALUE_BLOCK_SIZE, num_values, options->value_size_bits, in_bit_buf, options->error_log_file, incomplete_ret);
+    for (i = 0; i < num_values; i++)
+    {
+      io_int_t value = EXTEND_IO_INT_SIGN((io_int_t)values[i], options->value_size_bits);
+      value += last_value;
+      values[i] = (io_uint_t)value;
+      last_value = value;
+    }
+    WRITE_BLOCK_VALUES_CHECKED(values, num_values, options->value_size_bits, out_bit_buf, options->error_log_file);
+    if (incomplete_ret != NO_ERROR) /* Complete values have been written */
+      return incomplete_ret;
   }
   return NO_ERROR;
+}
+
+io_uint_t GetDifferentialOutputBound(const io_uint_t input_bits, const options_t * const options)
+{
+  return OUTPUT_BOUND_PRODUCT(OUTPUT_BOUND_UNITS(input_bits, options->value_size_bits), options->value_size_bits); /* One difference or value per value */
 }
\ No newline at end of file
@@ -34,6 +34,7 @@ typedef struct named_enc_dec_t
   const char * const name;
   const char * const description;
   const enc_dec_t encoder_decoder;
+  output_bound_function_t * const output_bound; /* For both encoder and decoder (see options_t.encode) */
   const option_t supported_options;
 } named_enc_dec_t;
 
@@ -49,14 +50,14 @@ typedef struct option_description_t
 } option_description_t;
 
 static const named_enc_dec_t encoders_decoders[] = { /* Note: This array needs to be sorted by name so that binary search works */
-  { "aggregate", "Sums up values", { &Aggregate, NULL }, OPTION_NUM_VALUES }, /* No decoder! */
-  { "bac", "Binary arithmetic coding", { &EncodeBAC, &DecodeBAC }, OPTION_ADAPTIVE },
-  { "copy", "Copies input to output", { &Copy, &Copy }, OPTION_BLOCK_SIZE_BITS },
-  { "csv", "Comma-separated values", { &WriteCSV, &ReadCSV }, OPTION_COLUMN | OPTION_SEPARATOR_CHAR | OPTION_NUM_DECIMAL_PLACES },
-  { "diff", "Differential coding", { &EncodeDifferential, &DecodeDifferential }, OPTION_VALUE_SIZE_BITS },
-  { "lzmh", "LZMH coding", { &EncodeLZMH, &DecodeLZMH }, NO_OPTIONS },
-  { "normalize", "(De-)normalization", { &Normalize, &Denormalize }, OPTION_NORMALIZATION_FACTOR | OPTION_VALUE_SIZE_BITS },
-  { "seg", "Signed Exponential Golomb coding", { &EncodeSEG, &DecodeSEG }, OPTION_VALUE_SIZE_BITS }
+  { "aggregate", "Sums up values", { &Aggregate, NULL }, &GetAggregateOutputBound, OPTION_NUM_VALUES }, /* No decoder! */
+  { "bac", "Binary arithmetic coding", { &EncodeBAC, &DecodeBAC }, &GetBACOutputBound, OPTION_ADAPTIVE },
+  { "copy", "Copies input to output", { &Copy, &Copy }, &GetCopyOutputBound, OPTION_BLOCK_SIZE_BITS },
+  { "csv", "Comma-separated values", { &WriteCSV, &ReadCSV }, &GetCSVOutputBound, OPTION_COLUMN | OPTION_SEPARATOR_CHAR | OPTION_NUM_DECIMAL_PLACES },
+  { "diff", "Differential coding", { &EncodeDifferential, &DecodeDifferential }, &GetDifferentialOutputBound, OPTION_VALUE_SIZE_BITS },
+  { "lzmh", "LZMH coding", { &EncodeLZMH, &DecodeLZMH }, &GetLZMHOutputBound, NO_OPTIONS },
+  { "normalize", "(De-)normalization", { &Normalize, &Denormalize }, &GetNormalizationOutputBound, OPTION_NORMALIZATION_FACTOR | OPTION_VALUE_SIZE_BITS },
+  { "seg", "Signed Exponential Golomb coding", { &EncodeSEG, &DecodeSEG }, &GetSEGOutputBound, OPTION_VALUE_SIZE_BITS }
 };
 
 static const size_t num_encoders = sizeof(encoders_decoders) / sizeof(encoders_decoders[0]);
@@ -120,6 +121,17 @@ const char *GetEncoderNameFromFunction(enc_dec_function_t * const function, cons
   return NULL;
 }
 
+io_uint_t GetOutputBound(const options_t * const options, const io_uint_t input_bits)
+{
+  size_t i;
+  for (i = 0; i < num_encoders; i++)
+  {
+    if (&encoders_decoders[i].encoder_decoder == options->encoder_decoder)
+      return (*encoders_decoders[i].output_bound)(input_bits, options);
+  }
+  return MAX_IO_UINT_VALUE; /* Unknown encoder/decoder */
+}
+
 size_t GetNumberOfOptions(void)
 {
   return num_options;
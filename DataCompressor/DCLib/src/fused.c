@@ -0,0 +1,146 @@
+/* Fused encoder chains
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "err_codes.h"
+#include "io_macros.h"
+#include "csv.h"
+#include "normalize.h"
+#include "diff.h"
+#include "seg.h"
+#include "bac.h"
+#include "fused.h"
+
+typedef enum fused_stage_t /* Position of each encoder/decoder in a fused chain */
+{
+  FS_CSV = 0,
+  FS_NORMALIZE = 1,
+  FS_DIFF = 2,
+  FS_SEG = 3,
+  FS_BAC = 4,
+  NUM_FUSED_STAGES = 5
+} fused_stage_t;
+
+typedef struct fused_stage_description_t
+{
+  enc_dec_function_t * const function;
+  const int encode;
+} fused_stage_description_t;
+
+static const fused_stage_description_t fused_stages[NUM_FUSED_STAGES] = { { &ReadCSV, 0 }, { &Normalize, 1 }, { &EncodeDifferential, 1 }, { &EncodeSEG, 1 }, { &EncodeBAC, 1 } };
+
+#define MIN_FUSED_STAGES 2 /* Fusing less than two encoders/decoders would not save anything */
+
+size_t GetNumberOfFusedEncoders(const options_t * const * const options, const size_t num_options)
+{
+  size_t num_fused = 0;
+  while (num_fused < num_options && num_fused < NUM_FUSED_STAGES)
+  {
+    const options_t * const current_options = options[num_fused];
+    enc_dec_function_t * const function = current_options->encode ? current_options->encoder_decoder->encoder : current_options->encoder_decoder->decoder;
+    if (current_options->encode != fused_stages[num_fused].encode || function != fused_stages[num_fused].function)
+      break;
+    if (num_fused > FS_NORMALIZE && num_fused < FS_BAC && current_options->value_size_bits != options[FS_NORMALIZE]->value_size_bits) /* Values are passed on without repacking */
+      break;
+    num_fused++;
+  }
+  return num_fused < MIN_FUSED_STAGES ? 0 : num_fused;
+}
+
+static io_int_t EncodeSEGCodewordWithBAC(const io_int_t value, bac_state_t * const bac_state, const int adaptive, bit_file_buffer_t * const out_bit_buf, FILE * const error_log_file) /* Same bits as EncodeSEGCodeword */
+{
+  size_t prefix_length;
+  const io_uint_t value_plus_one = GetSEGCodeword(value, &prefix_length);
+  io_int_t ret;
+  if (2 * prefix_length + 1 <= IO_SIZE_BITS) /* Prefix zeros, delimiting one and postfix value residual at once */
+    return EncodeBACBits(bac_state, value_plus_one, 2 * prefix_length + 1, adaptive, out_bit_buf, error_log_file);
+  if ((ret = EncodeBACBits(bac_state, 0, prefix_length, adaptive, out_bit_buf, error_log_file)) != NO_ERROR) /* Prefix zeros */
+    return ret;
+  return EncodeBACBits(bac_state, value_plus_one, 1 + prefix_length, adaptive, out_bit_buf, error_log_file); /* Delimiting one and postfix value residual */
+}
+
+io_int_t RunFusedEncoders(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const * const options, const size_t num_fused_options, size_t * const error_stage)
+{
+  const options_t * const normalize_options = options[FS_NORMALIZE];
+  const size_t value_size_bits = normalize_options->value_size_bits;
+  FILE * const error_log_file = normalize_options->error_log_file;
+  const float min_value = -(float)((io_uint_t)1 << (value_size_bits - 1)); /* See Normalize */
+  const float max_value = (float)(((io_uint_t)1 << (value_size_bits - 1)) - 1);
+  const int check_range = value_size_bits != IO_SIZE_BITS; /* See EncodeDifferential */
+  const io_int_t min_diff_value = check_range ? -(io_int_t)((io_uint_t)1 << (value_size_bits - 1)) : 0;
+  const io_int_t max_diff_value = check_range ? (((io_int_t)1 << (value_size_bits - 1)) - 1) : 0;
+  const io_uint_t value_mask = check_range ? ((io_uint_t)1 << value_size_bits) - 1 : MAX_IO_UINT_VALUE; /* Normalized values are truncated to valuesize bits before differential coding */
+  const int adaptive = num_fused_options > FS_BAC ? options[FS_BAC]->adaptive : 0;
+  csv_reader_t reader;
+  bac_state_t bac_state;
+  io_uint_t last_value = 0;
+  float values[VALUE_BLOCK_SIZE];
+  io_uint_t int_values[VALUE_BLOCK_SIZE];
+  io_int_t ret;
+  InitCSVReader(&reader);
+  if (num_fused_options > FS_BAC)
+    StartBACEncoder(&bac_state);
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
+  {
+    size_t i, num_values;
+    int out_of_range = 0;
+    *error_stage = FS_CSV;
+    if ((ret = ReadCSVValues(&reader, in_bit_buf, values, VALUE_BLOCK_SIZE, &num_values, options[FS_CSV])) != NO_ERROR)
+      return ret;
+    *error_stage = FS_NORMALIZE;
+    for (i = 0; i < num_values; i++) /* Normalize */
+    {
+      float value = values[i];
+      if (value > 0)
+        value = (value * normalize_options->normalization_factor + (float)0.5); /* Round towards +inf */
+      else if (value < 0)
+        value = (value * normalize_options->normalization_factor - (float)0.5); /* Round towards -inf */
+      out_of_range |= value < min_value || value > max_value; /* Value range check */
+      values[i] = value;
+    }
+    if (out_of_range) /* Only convert the values before the first one out of range (see Normalize) */
+    {
+      num_values = 0;
+      while (!(values[num_values] < min_value || values[num_values] > max_value))
+        num_values++;
+    }
+    for (i = 0; i < num_values; i++)
+      int_values[i] = (io_uint_t)(io_int_t)values[i];
+    if (num_fused_options == FS_DIFF)
+      WRITE_BLOCK_VALUES_CHECKED(int_values, num_values, value_size_bits, out_bit_buf, error_log_file);
+    if (out_of_range)
+      return ERROR_INVALID_VALUE;
+    if (num_fused_options == FS_DIFF)
+      continue;
+    *error_stage = FS_DIFF;
+    for (i = 0; i < num_values; i++) /* Differential coding */
+    {
+      const io_uint_t value = int_values[i] & value_mask;
+      int_values[i] = value - last_value;
+      last_value = value;
+      out_of_range |= check_range && ((io_int_t)int_values[i] < min_diff_value || (io_int_t)int_values[i] > max_diff_value); /* Value range check */
+    }
+    if (out_of_range) /* Only write the differences before the first one out of range (see EncodeDifferential) */
+    {
+      num_values = 0;
+      while ((io_int_t)int_values[num_values] >= min_diff_value && (io_int_t)int_values[num_values] <= max_diff_value)
+        num_values++;
+    }
+    if (num_fused_options == FS_SEG)
+      WRITE_BLOCK_VALUES_CHECKED(int_values, num_values, value_size_bits, out_bit_buf, error_log_file);
+    if (out_of_range)
+      return ERROR_INVALID_VALUE;
+    if (num_fused_options == FS_SEG)
+      continue;
+    *error_stage = num_fused_options - 1; /* SEG or BAC (which writes the output) */
+    for (i = 0; i < num_values; i++) /* Exponential Golomb coding (and binary arithmetic coding) */
+    {
+      const io_int_t diff_value = EXTEND_IO_INT_SIGN((io_int_t)int_values[i], value_size_bits);
+      if ((ret = (num_fused_options > FS_BAC ? EncodeSEGCodewordWithBAC(diff_value, &bac_state, adaptive, out_bit_buf, error_log_file) : EncodeSEGCodeword(diff_value, out_bit_buf, error_log_file))) != NO_ERROR)
+        return ret;
+    }
+  }
+  if (num_fused_options > FS_BAC)
+    return FinishBACEncoder(&bac_state, out_bit_buf, error_log_file);
+  return NO_ERROR;
+}
\ No newline at end of file
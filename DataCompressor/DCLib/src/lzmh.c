@@ -107,6 +107,7 @@ static const CODE_ELEMENT tree[TREE_LENGHT] = {
 
 
 #include <stdio.h>
+#include <string.h>
 
 size_t getPosInBuffer(int pos, size_t size) {
   while (pos < 0) {
@@ -118,6 +119,28 @@ size_t getPosInBuffer(int pos, size_t size) {
   return (size_t) pos;
 }
 
+/**
+* fillBuffer
+* reads up to num_bytes bytes from the input in place and appends them to
+* the circular buffer
+*
+* @return	NO_ERROR (or negative value on error)
+*/
+static io_int_t fillBuffer(bit_file_buffer_t * const in_bit_buf, uint8_t * const buffer, const size_t size, size_t * const write_pos, size_t num_bytes, const options_t * const options) {
+  while (num_bytes > 0 && !END_OF_BIT_FILE_BUFFER(in_bit_buf)) {
+    const uint8_t *span;
+    size_t span_size, first_size;
+    ACQUIRE_READ_SPAN_CHECKED(span, span_size, num_bytes, in_bit_buf, options->error_log_file);
+    first_size = span_size < size - *write_pos ? span_size : size - *write_pos;
+    memcpy(&buffer[*write_pos], span, first_size);
+    memcpy(&buffer[0], &span[first_size], span_size - first_size); /* Wrap around */
+    *write_pos = getPosInBuffer((int)(*write_pos + span_size), size);
+    RELEASE_READ_SPAN_CHECKED(span_size, in_bit_buf, options->error_log_file);
+    num_bytes -= span_size;
+  }
+  return NO_ERROR;
+}
+
 /**
 * Compress
 * compresses the data in the buffer and writes the result to the same buffer.
@@ -136,16 +159,17 @@ io_int_t EncodeLZMH(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * co
      but also for the Huffmancoding. */
   int           	maxlength, length, bestlength;
 
-  static HUFFLIST	list[HUFF_LIST_LENGTH];
+  HUFFLIST	list[HUFF_LIST_LENGTH];
   code_t		code_sym = 0;
   int8_t		code_length = 0;
 
-  static uint8_t	internBuffer[INTERN_BUFFER_LENGTH];
+  uint8_t	internBuffer[INTERN_BUFFER_LENGTH]; /* Not static so that multiple encoders can run in parallel */
   size_t		internBufferWrite = 0;
   size_t		internBufferRead = 0;
   size_t                internBufferHistory = 0;
 
   uint8_t		i;	/* used for several purposes */
+  io_int_t		ret;
 
   /* Initialize Symbollist */
   for (i = 0; i < HUFF_LIST_LENGTH; i++) {
@@ -158,19 +182,14 @@ io_int_t EncodeLZMH(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * co
     offsets[(size_t)i] = 0;
   }
 
+  memset(internBuffer, 0, sizeof(internBuffer)); /* Same initial state as with static storage */
+
   /* Fill Buffer */
-  while (!EndOfBitFileBuffer(in_bit_buf) &&
-          (internBufferWrite < INTERN_BUFFER_LENGTH))
-  {
-      READ_VALUE_BITS_CHECKED((io_uint_t * const)&code_sym, 8, in_bit_buf, options->error_log_file);
-      internBuffer[internBufferWrite] = (uint8_t)code_sym;
-      internBufferWrite++;
-  }
-  if (internBufferWrite >= INTERN_BUFFER_LENGTH) {
-      internBufferWrite -= INTERN_BUFFER_LENGTH;
+  if ((ret = fillBuffer(in_bit_buf, internBuffer, INTERN_BUFFER_LENGTH, &internBufferWrite, INTERN_BUFFER_LENGTH, options)) != NO_ERROR) {
+    return ret;
   }
 
-  while (!EndOfBitFileBuffer(in_bit_buf) || internBufferWrite != internBufferRead) {
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf) || internBufferWrite != internBufferRead) {
     code_sym = 0;
     if (internBufferHistory != 0) {
       maxoffset = LZ_MAX_OFFSET;
@@ -350,15 +369,9 @@ io_int_t EncodeLZMH(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * co
     }
 
     /* Fill Buffer */
-    while (!EndOfBitFileBuffer(in_bit_buf) &&
-            (internBufferWrite != internBufferHistory))
-    {
-        READ_VALUE_BITS_CHECKED((io_uint_t * const)&code_sym, 8, in_bit_buf, options->error_log_file);
-        internBuffer[internBufferWrite] = (uint8_t)code_sym;
-        internBufferWrite++;
-        if (internBufferWrite >= INTERN_BUFFER_LENGTH) {
-            internBufferWrite -= INTERN_BUFFER_LENGTH;
-        }
+    if ((ret = fillBuffer(in_bit_buf, internBuffer, INTERN_BUFFER_LENGTH, &internBufferWrite,
+            getPosInBuffer((int)internBufferHistory - (int)internBufferWrite, INTERN_BUFFER_LENGTH), options)) != NO_ERROR) {
+      return ret;
     }
 
     /*printf("internBufferRead: %d, internBufferWrite: %d, internBufferHistory: %d\n",
@@ -393,7 +406,7 @@ io_int_t DecodeLZMH(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * co
   uint32_t		code_sym = 0;
   int8_t		code_length = 0;
 
-  static uint8_t        internBuffer[LZ_MAX_OFFSET];
+  uint8_t        internBuffer[LZ_MAX_OFFSET]; /* Not static so that multiple decoders can run in parallel */
   size_t                internBufferPos = 0;
 
   for (i = 0; i < HUFF_LIST_LENGTH; i++) {
@@ -403,13 +416,18 @@ io_int_t DecodeLZMH(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * co
   for (i = 0; i < 4; i++) {
     offsets[i] = 0;
   }
+  memset(internBuffer, 0, sizeof(internBuffer)); /* Same initial state as with static storage */
 
   /* Main decompression loop */
   do {
-    while (!EndOfBitFileBuffer(in_bit_buf) && (CODE_BUFFER - code_length) >= 8) {
-      code_length += 1;
-      READ_VALUE_BITS_CHECKED((io_uint_t * const)&tmp, 1, in_bit_buf, options->error_log_file);
-      code_sym |= tmp << (CODE_BUFFER - code_length);
+    if (!END_OF_BIT_FILE_BUFFER(in_bit_buf) && (CODE_BUFFER - code_length) >= 8) {
+      /* Refill code buffer at once up to 7 bits below its size */
+      size_t refill_length = (size_t)(CODE_BUFFER - 7 - code_length);
+      size_t available_bits;
+      PEEK_BITS_CHECKED(&tmp, refill_length, available_bits, in_bit_buf, options->error_log_file);
+      SKIP_BITS_CHECKED(available_bits, in_bit_buf, options->error_log_file);
+      code_sym |= (uint32_t)(tmp << (CODE_BUFFER - code_length - refill_length));
+      code_length += (int8_t)available_bits;
     }
     if ((code_sym & 0x80000000) != 0) {
       /* Huffman Code */
@@ -568,7 +586,15 @@ io_int_t DecodeLZMH(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * co
       }
     }
     /*printf("Outpos: %d, Outsize: %d\n", (int)outpos, (int)outsize);*/
-  } while (!EndOfBitFileBuffer(in_bit_buf) || code_sym > 0);
+  } while (!END_OF_BIT_FILE_BUFFER(in_bit_buf) || code_sym > 0);
 
   return NO_ERROR;
 }
+
+io_uint_t GetLZMHOutputBound(const io_uint_t input_bits, const options_t * const options)
+{
+  if (options->encode) /* Literals take at most HUFF_BYTE_LENGTH + 2 bits; matches of at least 3 bytes take fewer bits than as many literals */
+    return OUTPUT_BOUND_PRODUCT(OUTPUT_BOUND_UNITS(input_bits, 8), HUFF_BYTE_LENGTH + 2);
+  else /* The longest match (LZ_MAX_LENGTH bytes) is coded with at least 14 bits. The code buffer may contain up to CODE_BUFFER bits at EOF */
+    return OUTPUT_BOUND_PRODUCT(OUTPUT_BOUND_SUM(input_bits, CODE_BUFFER) / 14 + 1, 8 * LZ_MAX_LENGTH);
+}
\ No newline at end of file
@@ -8,35 +8,72 @@
 
 io_int_t Normalize(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options)
 {
-  while (!EndOfBitFileBuffer(in_bit_buf))
+  const float min_value = -(float)((io_uint_t)1 << (options->value_size_bits - 1));
+  const float max_value = (float)(((io_uint_t)1 << (options->value_size_bits - 1)) - 1);
+  const size_t value_size = 8 * sizeof(float);
+  float values[VALUE_BLOCK_SIZE];
+  io_uint_t normalized_values[VALUE_BLOCK_SIZE];
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
   {
-    float value;
-    const size_t value_size = 8 * sizeof(value);
-    io_int_t normalized_value;
-    READ_BITS_CHECKED((uint8_t * const)&value, value_size, in_bit_buf, options->error_log_file);
-    if (value > 0)
-      value = (value * options->normalization_factor + (float)0.5); /* Round towards +inf */
-    else if (value < 0)
-      value = (value * options->normalization_factor - (float)0.5); /* Round towards -inf */
-    if (value < (-(float)((io_uint_t)1 << (options->value_size_bits - 1))) || value > (((io_uint_t)1 << (options->value_size_bits - 1)) - 1)) /* Value range check */
+    size_t i, num_values;
+    int out_of_range = 0;
+    io_int_t incomplete_ret = NO_ERROR;
+    READ_BLOCK_BITS_CHECKED((uint8_t * const)values, VALUE_BLOCK_SIZE, num_values, value_size, in_bit_buf, options->error_log_file, incomplete_ret);
+    for (i = 0; i < num_values; i++)
+    {
+      float value = values[i];
+      if (value > 0)
+        value = (value * options->normalization_factor + (float)0.5); /* Round towards +inf */
+      else if (value < 0)
+        value = (value * options->normalization_factor - (float)0.5); /* Round towards -inf */
+      out_of_range |= value < min_value || value > max_value; /* Value range check */
+      values[i] = value;
+    }
+    if (out_of_range) /* Only convert and write the values before the first one out of range */
+    {
+      num_values = 0;
+      while (!(values[num_values] < min_value || values[num_values] > max_value))
+        num_values++;
+    }
+    for (i = 0; i < num_values; i++) /* Values in range only (the conversion of other values is undefined) */
+      normalized_values[i] = (io_uint_t)(io_int_t)values[i];
+    WRITE_BLOCK_VALUES_CHECKED(normalized_values, num_values, options->value_size_bits, out_bit_buf, options->error_log_file);
+    if (out_of_range)
       return ERROR_INVALID_VALUE;
-    normalized_value = (io_int_t)value;
-    WRITE_VALUE_BITS_CHECKED((const io_uint_t * const)&normalized_value, options->value_size_bits, out_bit_buf, options->error_log_file);
+    if (incomplete_ret != NO_ERROR) /* Complete values have been written */
+      return incomplete_ret;
   }
   return NO_ERROR;
 }
 
 io_int_t Denormalize(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options)
 {
-  while (!EndOfBitFileBuffer(in_bit_buf))
+  const size_t denormalized_value_size = 8 * sizeof(float);
+  const double reciprocal_factor = 1.0 / options->normalization_factor;
+  io_uint_t normalized_values[VALUE_BLOCK_SIZE];
+  float denormalized_values[VALUE_BLOCK_SIZE];
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
   {
-    io_int_t normalized_value;
-    float denormalized_value;
-    const size_t denormalized_value_size = 8 * sizeof(denormalized_value);
-    READ_VALUE_BITS_CHECKED((io_uint_t * const)&normalized_value, options->value_size_bits, in_bit_buf, options->error_log_file);
-    normalized_value = EXTEND_IO_INT_SIGN(normalized_value, options->value_size_bits);
-    denormalized_value = (float)normalized_value / options->normalization_factor;
-    WRITE_BITS_CHECKED((const uint8_t * const)&denormalized_value, denormalized_value_size, out_bit_buf, options->error_log_file);
+    size_t i, num_values;
+    io_int_t incomplete_ret = NO_ERROR;
+    READ_BLOCK_VALUES_CHECKED(normalized_values, VALUE_BLOCK_SIZE, num_values, options->value_size_bits, in_bit_buf, options->error_log_file, incomplete_ret);
+    for (i = 0; i < num_values; i++)
+    {
+      const io_int_t normalized_value = EXTEND_IO_INT_SIGN((io_int_t)normalized_values[i], options->value_size_bits);
+      denormalized_values[i] = (float)((double)(float)normalized_value * reciprocal_factor); /* Same result as (float)normalized_value / normalization_factor, but without a division and independent of floating-point optimizations: The quotient of two floats is either a float or at least 2^-48 (relative) away from the middle between two floats, whereas the double product is at most 2^-52 (relative) away from the quotient */
+    }
+    WRITE_BITS_CHECKED((const uint8_t * const)denormalized_values, num_values * denormalized_value_size, out_bit_buf, options->error_log_file);
+    if (incomplete_ret != NO_ERROR) /* Complete values have been written */
+      return incomplete_ret;
   }
   return NO_ERROR;
+}
+
+io_uint_t GetNormalizationOutputBound(const io_uint_t input_bits, const options_t * const options)
+{
+  const size_t float_value_size = 8 * sizeof(float);
+  if (options->encode)
+    return OUTPUT_BOUND_PRODUCT(OUTPUT_BOUND_UNITS(input_bits, float_value_size), options->value_size_bits);
+  else
+    return OUTPUT_BOUND_PRODUCT(OUTPUT_BOUND_UNITS(input_bits, options->value_size_bits), float_value_size);
 }
\ No newline at end of file
@@ -0,0 +1,370 @@
+/* Encoder/decoder pipeline
+   Part of DataCompressor
+   DataCompressor contributors, 2026 */
+
+#include "err_codes.h"
+#include "io_macros.h"
+#include "fused.h"
+#include "pipeline.h"
+#include "allocation.h"
+
+static const size_t TEMP_CHUNK_SIZE = 64 * 1024; /* 64 KiB */
+static const size_t TEMP_SPILL_BUFFER_SIZE = 64 * 1024; /* 64 KiB (only used when a temporary buffer exceeds its memory budget) */
+
+struct pipeline_t
+{
+  const options_t **options; /* References to the caller's options */
+  options_t *inverse_options; /* Copies with inverted direction in reverse order */
+  const options_t **inverse_option_list;
+  size_t num_options;
+  int invertible; /* All encoders/decoders have an inverse */
+  int fuse_encoders;
+  chunk_pool_t *temp_chunk_pool; /* Shared by the temporary buffers so that chunks consumed by one encoder/decoder can be reused for the output of the same one */
+  file_buffer_t *temp_read_buf, *temp_write_buf;
+  bit_file_buffer_t *temp_read_bit_buf, *temp_write_bit_buf; /* NULL with only one encoder/decoder */
+  file_buffer_t *memory_in_buf, *memory_out_buf;
+  bit_file_buffer_t *memory_in_bit_buf, *memory_out_bit_buf; /* NULL until the first in-memory call. Initialized on the caller's input and output memory per call */
+  pipeline_stage_function_t *stage_function;
+  void *caller_info;
+};
+
+pipeline_t *AllocatePipeline(void)
+{
+  return (pipeline_t*)AllocateMemory(sizeof(pipeline_t));
+}
+
+void FreePipeline(pipeline_t * const pipeline)
+{
+  FreeMemory(pipeline);
+}
+
+static void FreeTempBuffers(pipeline_t * const pipeline)
+{
+  if (pipeline->temp_write_bit_buf != NULL)
+    FreeBitFileBuffer(pipeline->temp_write_bit_buf);
+  if (pipeline->temp_read_bit_buf != NULL)
+    FreeBitFileBuffer(pipeline->temp_read_bit_buf);
+  if (pipeline->temp_write_buf != NULL)
+    FreeFileBuffer(pipeline->temp_write_buf);
+  if (pipeline->temp_read_buf != NULL)
+    FreeFileBuffer(pipeline->temp_read_buf);
+  if (pipeline->temp_chunk_pool != NULL)
+    FreeChunkPool(pipeline->temp_chunk_pool);
+  pipeline->temp_write_bit_buf = pipeline->temp_read_bit_buf = NULL;
+  pipeline->temp_write_buf = pipeline->temp_read_buf = NULL;
+  pipeline->temp_chunk_pool = NULL;
+}
+
+static void FreeOptions(pipeline_t * const pipeline)
+{
+  FreeMemory((void*)pipeline->inverse_option_list);
+  FreeMemory(pipeline->inverse_options);
+  FreeMemory((void*)pipeline->options);
+}
+
+static int InitOptions(pipeline_t * const pipeline, options_t * const * const options, const size_t num_options)
+{
+  size_t i;
+  pipeline->options = (const options_t**)AllocateMemory(num_options * sizeof(const options_t*));
+  pipeline->inverse_options = (options_t*)AllocateMemory(num_options * sizeof(options_t));
+  pipeline->inverse_option_list = (const options_t**)AllocateMemory(num_options * sizeof(const options_t*));
+  if (pipeline->options == NULL || pipeline->inverse_options == NULL || pipeline->inverse_option_list == NULL)
+  {
+    LOG_ERROR(options[0]->error_log_file, "Error allocating %" SIZE_T_FORMAT " bytes for pipeline options\n", SIZE_T_CAST(num_options * (2 * sizeof(const options_t*) + sizeof(options_t))));
+    FreeOptions(pipeline);
+    return ERROR_MEMORY;
+  }
+  pipeline->num_options = num_options;
+  pipeline->invertible = 1;
+  for (i = 0; i < num_options; i++)
+  {
+    options_t * const inverse_options = &pipeline->inverse_options[num_options - 1 - i];
+    pipeline->options[i] = options[i];
+    *inverse_options = *options[i];
+    inverse_options->encode = !options[i]->encode;
+    pipeline->inverse_option_list[num_options - 1 - i] = inverse_options;
+    if ((inverse_options->encode ? inverse_options->encoder_decoder->encoder : inverse_options->encoder_decoder->decoder) == NULL) /* E.g., aggregate has no decoder */
+      pipeline->invertible = 0;
+  }
+  return NO_ERROR;
+}
+
+static int InitTempBuffers(pipeline_t * const pipeline, FILE * const error_log_file, const size_t memory_budget)
+{
+  int ret;
+  if ((pipeline->temp_chunk_pool = AllocateChunkPool()) == NULL || (pipeline->temp_read_buf = AllocateFileBuffer()) == NULL || (pipeline->temp_write_buf = AllocateFileBuffer()) == NULL
+    || (pipeline->temp_read_bit_buf = AllocateBitFileBuffer()) == NULL || (pipeline->temp_write_bit_buf = AllocateBitFileBuffer()) == NULL)
+  {
+    LOG_ERROR(error_log_file, "Error allocating temporary buffers\n");
+    FreeTempBuffers(pipeline);
+    return ERROR_MEMORY;
+  }
+  if ((ret = InitChunkPool(pipeline->temp_chunk_pool, TEMP_CHUNK_SIZE)) != NO_ERROR)
+  {
+    LOG_ERROR(error_log_file, "%s while initializing temporary chunk pool\n", ERROR_MESSAGE_STRING(ret));
+    FreeTempBuffers(pipeline);
+    return ERROR_LIBRARY_INIT;
+  }
+  if ((ret = InitFileBufferInMemoryChunked(pipeline->temp_read_buf, FBM_READING, pipeline->temp_chunk_pool)) != NO_ERROR)
+  {
+    LOG_ERROR(error_log_file, "%s while initializing temporary reading buffer\n", ERROR_MESSAGE_STRING(ret));
+    UninitChunkPool(pipeline->temp_chunk_pool);
+    FreeTempBuffers(pipeline);
+    return ERROR_LIBRARY_INIT;
+  }
+  if ((ret = InitFileBufferInMemoryChunked(pipeline->temp_write_buf, FBM_WRITING, pipeline->temp_chunk_pool)) != NO_ERROR)
+  {
+    LOG_ERROR(error_log_file, "%s while initializing temporary writing buffer\n", ERROR_MESSAGE_STRING(ret));
+    UninitFileBuffer(pipeline->temp_read_buf);
+    UninitChunkPool(pipeline->temp_chunk_pool);
+    FreeTempBuffers(pipeline);
+    return ERROR_LIBRARY_INIT;
+  }
+  InitBitFileBuffer(pipeline->temp_read_bit_buf, pipeline->temp_read_buf);
+  InitBitFileBuffer(pipeline->temp_write_bit_buf, pipeline->temp_write_buf);
+  if (memory_budget != 0) /* Split the budget between both temporary buffers since the reading one may still be in memory while the writing one is filled */
+  {
+    const size_t temp_buffer_budget = memory_budget / 2 != 0 ? memory_budget / 2 : 1;
+    if ((ret = SetFileBufferMemoryBudget(pipeline->temp_read_buf, temp_buffer_budget, TEMP_SPILL_BUFFER_SIZE)) != NO_ERROR || (ret = SetFileBufferMemoryBudget(pipeline->temp_write_buf, temp_buffer_budget, TEMP_SPILL_BUFFER_SIZE)) != NO_ERROR)
+    {
+      LOG_ERROR(error_log_file, "%s while setting the memory budget of the temporary buffers\n", ERROR_MESSAGE_STRING(ret));
+      return ERROR_LIBRARY_INIT; /* Initialized, i.e., uninitialized with the pipeline */
+    }
+  }
+  return NO_ERROR;
+}
+
+static void UninitTempBuffers(pipeline_t * const pipeline)
+{
+  if (pipeline->temp_read_bit_buf == NULL)
+    return;
+  UninitBitFileBuffer(pipeline->temp_write_bit_buf);
+  UninitBitFileBuffer(pipeline->temp_read_bit_buf);
+  UninitFileBuffer(pipeline->temp_write_buf);
+  UninitFileBuffer(pipeline->temp_read_buf);
+  UninitChunkPool(pipeline->temp_chunk_pool); /* After all temporary buffers have returned their chunks */
+  FreeTempBuffers(pipeline);
+}
+
+int InitPipeline(pipeline_t * const pipeline, options_t * const * const options, const size_t num_options, const int fuse_encoders, const size_t memory_budget)
+{
+  int ret;
+  if (num_options == 0)
+    return ERROR_INVALID_VALUE;
+  pipeline->fuse_encoders = fuse_encoders;
+  pipeline->temp_chunk_pool = NULL;
+  pipeline->temp_read_buf = pipeline->temp_write_buf = NULL;
+  pipeline->temp_read_bit_buf = pipeline->temp_write_bit_buf = NULL;
+  pipeline->memory_in_buf = pipeline->memory_out_buf = NULL;
+  pipeline->memory_in_bit_buf = pipeline->memory_out_bit_buf = NULL;
+  pipeline->stage_function = NULL;
+  pipeline->caller_info = NULL;
+  if ((ret = InitOptions(pipeline, options, num_options)) != NO_ERROR)
+    return ret;
+  if (num_options > 1 && (ret = InitTempBuffers(pipeline, options[0]->error_log_file, memory_budget)) != NO_ERROR) /* Only required with at least two encoders/decoders */
+  {
+    UninitTempBuffers(pipeline);
+    FreeOptions(pipeline);
+    return ret;
+  }
+  return NO_ERROR;
+}
+
+static void FreeMemoryBuffers(pipeline_t * const pipeline)
+{
+  if (pipeline->memory_out_bit_buf == NULL)
+    return;
+  FreeBitFileBuffer(pipeline->memory_out_bit_buf);
+  FreeBitFileBuffer(pipeline->memory_in_bit_buf);
+  FreeFileBuffer(pipeline->memory_out_buf);
+  FreeFileBuffer(pipeline->memory_in_buf);
+}
+
+void UninitPipeline(pipeline_t * const pipeline)
+{
+  FreeMemoryBuffers(pipeline);
+  UninitTempBuffers(pipeline);
+  FreeOptions(pipeline);
+}
+
+void SetPipelineStageFunction(pipeline_t * const pipeline, pipeline_stage_function_t * const stage_function, void * const caller_info)
+{
+  pipeline->stage_function = stage_function;
+  pipeline->caller_info = caller_info;
+}
+
+int GetPipelineBufferSizes(const pipeline_t * const pipeline, size_t * const temp_read_size, size_t * const temp_write_size)
+{
+  if (pipeline->temp_read_buf == NULL)
+  {
+    *temp_read_size = *temp_write_size = 0;
+    return 0;
+  }
+  *temp_read_size = GetFileBufferSize(pipeline->temp_read_buf);
+  *temp_write_size = GetFileBufferSize(pipeline->temp_write_buf);
+  return 1;
+}
+
+static void SwapTempBuffers(pipeline_t * const pipeline)
+{
+  file_buffer_t * const temp = pipeline->temp_read_buf;
+  bit_file_buffer_t * const temp_bit = pipeline->temp_read_bit_buf;
+  pipeline->temp_read_buf = pipeline->temp_write_buf; /* Swap file buffer pointers as well so that they point to the correct buffers */
+  pipeline->temp_write_buf = temp;
+  pipeline->temp_read_bit_buf = pipeline->temp_write_bit_buf;
+  pipeline->temp_write_bit_buf = temp_bit;
+}
+
+static int SwitchTempBuffers(pipeline_t * const pipeline, FILE * const error_log_file)
+{
+  int ret;
+  if ((ret = SetBitFileBufferMode(pipeline->temp_write_bit_buf, FBM_READING)) != NO_ERROR)
+  {
+    LOG_ERROR(error_log_file, "Could not switch mode of temporary buffer\n");
+    return ret;
+  }
+  SwapTempBuffers(pipeline); /* Old data can now be read from the reading buffer; the writing buffer has to be reset */
+  if ((ret = ResetBitFileBuffer(pipeline->temp_write_bit_buf, FBM_WRITING)) != NO_ERROR) /* Also removes the temporary file if the old data had been spilled */
+  {
+    LOG_ERROR(error_log_file, "Could not reset temporary buffer\n");
+    return ret;
+  }
+  return NO_ERROR;
+}
+
+static int RunStages(pipeline_t * const pipeline, const options_t * const * const options, bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf)
+{
+  FILE * const error_log_file = options[0]->error_log_file;
+  size_t i, num_stages;
+  int ret;
+  if (pipeline->temp_read_bit_buf != NULL && ((ret = ResetBitFileBuffer(pipeline->temp_read_bit_buf, FBM_READING)) != NO_ERROR || (ret = ResetBitFileBuffer(pipeline->temp_write_bit_buf, FBM_WRITING)) != NO_ERROR)) /* Discard left-overs from previous errors */
+  {
+    LOG_ERROR(error_log_file, "Could not reset temporary buffers\n");
+    return ret;
+  }
+  for (i = 0; i < pipeline->num_options; i += num_stages)
+  {
+    const options_t * const current_options = options[i];
+    const size_t num_fused = pipeline->fuse_encoders ? GetNumberOfFusedEncoders(&options[i], pipeline->num_options - i) : 0; /* Encoders/decoders which can be processed in one pass */
+    enc_dec_function_t * const enc_dec = current_options->encode ? current_options->encoder_decoder->encoder : current_options->encoder_decoder->decoder;
+    bit_file_buffer_t *read_bit_buf, *write_bit_buf;
+    io_int_t enc_ret;
+    size_t error_stage = 0;
+    num_stages = num_fused != 0 ? num_fused : 1;
+    read_bit_buf = i == 0 ? in_bit_buf : pipeline->temp_read_bit_buf; /* First read from input, rest from memory */
+    write_bit_buf = i + num_stages == pipeline->num_options ? out_bit_buf : pipeline->temp_write_bit_buf; /* Last write to output, rest to memory */
+    if (pipeline->stage_function != NULL)
+      (*pipeline->stage_function)(options, i, num_stages, pipeline->num_options, read_bit_buf, write_bit_buf, 0, pipeline->caller_info);
+    if ((enc_ret = (num_fused != 0 ? RunFusedEncoders(read_bit_buf, write_bit_buf, &options[i], num_fused, &error_stage) : (*enc_dec)(read_bit_buf, write_bit_buf, current_options))) != NO_ERROR)
+    {
+      if (enc_ret == ERROR_OUTPUT_FULL) /* Reported to the caller only (see ProcessInMemory) */
+        return ERROR_OUTPUT_FULL;
+      LOG_ERROR(error_log_file, "%s while executing encoder/decoder %" SIZE_T_FORMAT " of %" SIZE_T_FORMAT "\n", ERROR_MESSAGE_STRING(enc_ret), SIZE_T_CAST(i + error_stage + 1), SIZE_T_CAST(pipeline->num_options));
+      return ERROR_LIBRARY_CALL;
+    }
+    if (pipeline->stage_function != NULL)
+      (*pipeline->stage_function)(options, i, num_stages, pipeline->num_options, read_bit_buf, write_bit_buf, 1, pipeline->caller_info);
+    if (i + num_stages < pipeline->num_options && SwitchTempBuffers(pipeline, error_log_file) != NO_ERROR) /* Switch temporary buffer from writing to reading after all but the last encoder/decoder */
+      return ERROR_LIBRARY_CALL;
+  }
+  return NO_ERROR;
+}
+
+int RunPipelineStages(pipeline_t * const pipeline, bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf)
+{
+  return RunStages(pipeline, pipeline->options, in_bit_buf, out_bit_buf);
+}
+
+size_t GetPipelineOutputBound(const pipeline_t * const pipeline, const size_t input_size, const int compress)
+{
+  const options_t * const * const options = compress ? pipeline->options : pipeline->inverse_option_list;
+  io_uint_t bound = OUTPUT_BOUND_PRODUCT((io_uint_t)input_size, 8);
+  size_t i;
+  if (!compress && !pipeline->invertible)
+    return MAX_USABLE_SIZE;
+  for (i = 0; i < pipeline->num_options; i++) /* Fused encoders/decoders produce the same output */
+    bound = GetOutputBound(options[i], bound);
+  bound = OUTPUT_BOUND_UNITS(bound, 8); /* The last byte is padded */
+  return bound < MAX_USABLE_SIZE ? (size_t)bound : MAX_USABLE_SIZE;
+}
+
+static int InitMemoryBuffers(pipeline_t * const pipeline, FILE * const error_log_file)
+{
+  if (pipeline->memory_out_bit_buf != NULL) /* Already allocated by a previous call */
+    return NO_ERROR;
+  if ((pipeline->memory_in_buf = AllocateFileBuffer()) == NULL || (pipeline->memory_out_buf = AllocateFileBuffer()) == NULL
+    || (pipeline->memory_in_bit_buf = AllocateBitFileBuffer()) == NULL || (pipeline->memory_out_bit_buf = AllocateBitFileBuffer()) == NULL)
+  {
+    LOG_ERROR(error_log_file, "Error allocating in-memory buffers\n");
+    if (pipeline->memory_in_bit_buf != NULL)
+      FreeBitFileBuffer(pipeline->memory_in_bit_buf);
+    if (pipeline->memory_out_buf != NULL)
+      FreeFileBuffer(pipeline->memory_out_buf);
+    if (pipeline->memory_in_buf != NULL)
+      FreeFileBuffer(pipeline->memory_in_buf);
+    pipeline->memory_in_buf = pipeline->memory_out_buf = NULL;
+    pipeline->memory_in_bit_buf = pipeline->memory_out_bit_buf = NULL;
+    return ERROR_MEMORY;
+  }
+  return NO_ERROR;
+}
+
+static int FinishMemoryOutput(bit_file_buffer_t * const out_bit_buf, size_t * const used_output_size) /* Pads the output with zeros to a whole byte like when writing to a file */
+{
+  const uint8_t zero = 0;
+  io_int_t byte_offset, ret;
+  uint8_t bit_offset;
+  GetActualBitFileOffset(out_bit_buf, &byte_offset, &bit_offset);
+  if (bit_offset != 0 && (ret = WriteBitFileBuffer(out_bit_buf, &zero, 8 - bit_offset)) != 8 - bit_offset)
+    return ret < 0 ? (int)ret : ERROR_FILE_IO;
+  if ((ret = FlushBitFileBuffer(out_bit_buf)) != NO_ERROR) /* Write the remaining bytes of the accumulator */
+    return (int)ret;
+  *used_output_size = (size_t)byte_offset + (bit_offset != 0);
+  return NO_ERROR;
+}
+
+static int ProcessInMemory(pipeline_t * const pipeline, const options_t * const * const options, const uint8_t * const input, const size_t input_size, uint8_t * const output, const size_t output_size, size_t * const used_output_size)
+{
+  FILE * const error_log_file = options[0]->error_log_file;
+  int ret;
+  *used_output_size = 0;
+  if ((ret = InitMemoryBuffers(pipeline, error_log_file)) != NO_ERROR)
+    return ret;
+  if ((ret = InitFileBufferFromMemory(pipeline->memory_in_buf, input, input_size)) != NO_ERROR)
+  {
+    LOG_ERROR(error_log_file, "%s while initializing in-memory input buffer\n", ERROR_MESSAGE_STRING(ret));
+    return ret;
+  }
+  if ((ret = InitFileBufferToMemory(pipeline->memory_out_buf, output, output_size)) != NO_ERROR)
+  {
+    LOG_ERROR(error_log_file, "%s while initializing in-memory output buffer\n", ERROR_MESSAGE_STRING(ret));
+    UninitFileBuffer(pipeline->memory_in_buf);
+    return ret;
+  }
+  InitBitFileBuffer(pipeline->memory_in_bit_buf, pipeline->memory_in_buf);
+  InitBitFileBuffer(pipeline->memory_out_bit_buf, pipeline->memory_out_buf);
+  ret = RunStages(pipeline, options, pipeline->memory_in_bit_buf, pipeline->memory_out_bit_buf);
+  if (ret == NO_ERROR && (ret = FinishMemoryOutput(pipeline->memory_out_bit_buf, used_output_size)) != NO_ERROR && ret != ERROR_OUTPUT_FULL)
+    LOG_ERROR(error_log_file, "%s while finishing the in-memory output\n", ERROR_MESSAGE_STRING(ret));
+  UninitBitFileBuffer(pipeline->memory_out_bit_buf); /* The output is incomplete on error */
+  UninitFileBuffer(pipeline->memory_out_buf);
+  UninitBitFileBuffer(pipeline->memory_in_bit_buf);
+  UninitFileBuffer(pipeline->memory_in_buf);
+  return ret;
+}
+
+int CompressToMemory(pipeline_t * const pipeline, const uint8_t * const input, const size_t input_size, uint8_t * const output, const size_t output_size, size_t * const used_output_size)
+{
+  return ProcessInMemory(pipeline, pipeline->options, input, input_size, output, output_size, used_output_size);
+}
+
+int DecompressToMemory(pipeline_t * const pipeline, const uint8_t * const input, const size_t input_size, uint8_t * const output, const size_t output_size, size_t * const used_output_size)
+{
+  if (!pipeline->invertible)
+  {
+    *used_output_size = 0;
+    LOG_ERROR(pipeline->options[0]->error_log_file, "At least one encoder/decoder of the pipeline cannot be inverted\n");
+    return ERROR_INVALID_MODE;
+  }
+  return ProcessInMemory(pipeline, pipeline->inverse_option_list, input, input_size, output, output_size, used_output_size);
+}
\ No newline at end of file
@@ -8,46 +8,77 @@
 
 static const io_uint_t zeros[1] = { 0 };
 
-static io_int_t EncodeUEGCodeword(const io_uint_t value, bit_file_buffer_t * const out_bit_buf, FILE * const error_log_file)
+io_uint_t GetSEGCodeword(const io_int_t value, size_t * const prefix_length)
 {
-  const io_uint_t value_plus_one = value + 1;
+  const io_uint_t value_plus_one = (value > 0 ? 2 * (io_uint_t)IO_ABS(value) - 1 : 2 * (io_uint_t)IO_ABS(value)) + 1; /* Odd code words encode positive values (even code words encode negative values and zero) */
   io_uint_t temp_value = value_plus_one;
-  size_t prefix_length = 0;
+  *prefix_length = 0;
   while ((temp_value >>= 1) != 0) /* Determine prefix length */
-    prefix_length++;
-  WRITE_VALUE_BITS_CHECKED(zeros, prefix_length, out_bit_buf, error_log_file); /* Write prefix zeros */
-  WRITE_VALUE_BITS_CHECKED(&value_plus_one, 1 + prefix_length, out_bit_buf, error_log_file); /* Write delimiting one and postfix value residual */
-  return NO_ERROR;
+    (*prefix_length)++;
+  return value_plus_one;
 }
 
-static io_int_t EncodeSEGCodeword(const io_int_t value, bit_file_buffer_t * const out_bit_buf, FILE * const error_log_file)
+io_int_t EncodeSEGCodeword(const io_int_t value, bit_file_buffer_t * const out_bit_buf, FILE * const error_log_file)
 {
-  if (value > 0)
-    return EncodeUEGCodeword(2 * (io_uint_t)IO_ABS(value) - 1, out_bit_buf, error_log_file);
-  else /* if (value <= 0) */
-    return EncodeUEGCodeword(2 * (io_uint_t)IO_ABS(value), out_bit_buf, error_log_file);
+  size_t prefix_length;
+  const io_uint_t value_plus_one = GetSEGCodeword(value, &prefix_length);
+  if (2 * prefix_length + 1 <= IO_SIZE_BITS) /* Write prefix zeros, delimiting one and postfix value residual at once */
+  {
+    WRITE_VALUE_BITS_CHECKED(&value_plus_one, 2 * prefix_length + 1, out_bit_buf, error_log_file);
+  }
+  else
+  {
+    WRITE_VALUE_BITS_CHECKED(zeros, prefix_length, out_bit_buf, error_log_file); /* Write prefix zeros */
+    WRITE_VALUE_BITS_CHECKED(&value_plus_one, 1 + prefix_length, out_bit_buf, error_log_file); /* Write delimiting one and postfix value residual */
+  }
+  return NO_ERROR;
 }
 
 io_int_t EncodeSEG(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options)
 {
   io_int_t ret;
-  while (!EndOfBitFileBuffer(in_bit_buf))
+  io_uint_t values[VALUE_BLOCK_SIZE];
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
   {
-    io_int_t current_value;
-    READ_VALUE_BITS_CHECKED((io_uint_t * const)&current_value, options->value_size_bits, in_bit_buf, options->error_log_file);
-    current_value = EXTEND_IO_INT_SIGN(current_value, options->value_size_bits);
-    if ((ret = EncodeSEGCodeword(current_value, out_bit_buf, options->error_log_file)) != NO_ERROR)
-      return ret;
+    size_t i, num_values;
+    io_int_t incomplete_ret = NO_ERROR;
+    READ_BLOCK_VALUES_CHECKED(values, VALUE_BLOCK_SIZE, num_values, options->value_size_bits, in_bit_buf, options->error_log_file, incomplete_ret);
+    for (i = 0; i < num_values; i++)
+    {
+      const io_int_t current_value = EXTEND_IO_INT_SIGN((io_int_t)values[i], options->value_size_bits);
+      if ((ret = EncodeSEGCodeword(current_value, out_bit_buf, options->error_log_file)) != NO_ERROR)
+        return ret;
+    }
+    if (incomplete_ret != NO_ERROR) /* Complete values have been encoded */
+      return incomplete_ret;
   }
   return NO_ERROR;
 }
 
+/* Number of bits to look ahead for decoding complete code words at once */
+#define PEEK_BITS (MAX_PEEK_BIT_SIZE > IO_SIZE_BITS ? IO_SIZE_BITS : MAX_PEEK_BIT_SIZE)
+
 static io_int_t DecodeUEGCodeword(const size_t max_value_size_bits, io_uint_t * const value, int * const eos, bit_file_buffer_t * const in_bit_buf, FILE * const error_log_file)
 {
-  size_t prefix_length = 0;
-  io_uint_t current_bit = 0;
+  size_t prefix_length = 0, available_bits;
+  io_uint_t current_bit = 0, next_bits;
   *eos = 0;
-  while (current_bit == 0 && !EndOfBitFileBuffer(in_bit_buf)) /* Read prefix */
+  PEEK_BITS_CHECKED(&next_bits, PEEK_BITS, available_bits, in_bit_buf, error_log_file);
+  if (next_bits != 0) /* Fast path: delimiting one is within the next bits */
+  {
+    while ((next_bits & ((io_uint_t)1 << (PEEK_BITS - 1 - prefix_length))) == 0) /* Determine prefix length */
+      prefix_length++;
+    if (prefix_length >= max_value_size_bits) /* Max. prefix length for 64 bit values is 64 */
+      return ERROR_INVALID_FORMAT;
+    if (2 * prefix_length + 1 <= available_bits) /* Code word is complete => decode it at once */
+    {
+      *value = (next_bits >> (PEEK_BITS - (2 * prefix_length + 1))) - 1; /* Prefix zeros, delimiting one and postfix value residual */
+      SKIP_BITS_CHECKED(2 * prefix_length + 1, in_bit_buf, error_log_file);
+      return NO_ERROR;
+    }
+    prefix_length = 0; /* Decode incomplete code words bit by bit to detect the end of the stream */
+  }
+  while (current_bit == 0 && !END_OF_BIT_FILE_BUFFER(in_bit_buf)) /* Read prefix */
   {
     READ_VALUE_BITS_CHECKED(&current_bit, (size_t)1, in_bit_buf, error_log_file);
     if (current_bit == 0)
@@ -55,7 +86,7 @@ static io_int_t DecodeUEGCodeword(const size_t max_value_size_bits, io_uint_t *
     if (prefix_length >= max_value_size_bits) /* Max. prefix length for 64 bit values is 64 */
       return ERROR_INVALID_FORMAT;
   }
-  if (EndOfBitFileBuffer(in_bit_buf) && prefix_length != 0) /* EOF during prefix */
+  if (END_OF_BIT_FILE_BUFFER(in_bit_buf) && prefix_length != 0) /* EOF during prefix */
   {
     *eos = 1; /* Signal end of stream and abort */
     return NO_ERROR;
@@ -81,15 +112,34 @@ static io_int_t DecodeSEGCodeword(const size_t max_value_size_bits, io_int_t * c
 
 io_int_t DecodeSEG(bit_file_buffer_t * const in_bit_buf, bit_file_buffer_t * const out_bit_buf, const options_t * const options)
 {
-  while (!EndOfBitFileBuffer(in_bit_buf))
+  io_uint_t values[VALUE_BLOCK_SIZE];
+  size_t num_values = 0;
+  while (!END_OF_BIT_FILE_BUFFER(in_bit_buf))
   {
     io_int_t current_value, ret;
     int eos;
     if ((ret = DecodeSEGCodeword(options->value_size_bits, &current_value, &eos, in_bit_buf, options->error_log_file)) != NO_ERROR)
+    {
+      WRITE_BLOCK_VALUES_CHECKED(values, num_values, options->value_size_bits, out_bit_buf, options->error_log_file); /* Write the values decoded before the error */
       return ret;
+    }
     if (eos) /* Exit on EOS indicator */
       break;
-    WRITE_VALUE_BITS_CHECKED((const io_uint_t * const)&current_value, options->value_size_bits, out_bit_buf, options->error_log_file);
+    values[num_values++] = (io_uint_t)current_value;
+    if (num_values == VALUE_BLOCK_SIZE) /* Write full blocks */
+    {
+      WRITE_BLOCK_VALUES_CHECKED(values, num_values, options->value_size_bits, out_bit_buf, options->error_log_file);
+      num_values = 0;
+    }
   }
+  WRITE_BLOCK_VALUES_CHECKED(values, num_values, options->value_size_bits, out_bit_buf, options->error_log_file); /* Write remaining values */
   return NO_ERROR;
+}
+
+io_uint_t GetSEGOutputBound(const io_uint_t input_bits, const options_t * const options)
+{
+  if (options->encode) /* The prefix of a value of valuesize bits is at most valuesize bits long */
+    return OUTPUT_BOUND_PRODUCT(OUTPUT_BOUND_UNITS(input_bits, options->value_size_bits), 2 * options->value_size_bits + 1);
+  else /* Each code word is at least one bit long */
+    return OUTPUT_BOUND_PRODUCT(input_bits, options->value_size_bits);
 }
\ No newline at end of file
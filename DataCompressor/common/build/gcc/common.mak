@@ -10,6 +10,10 @@ DIFF ?= diff
 CFLAGS += -c
 LDFLAGS += -static
 
+#Threads are used to read ahead from input files
+CFLAGS += -pthread
+LDFLAGS += -pthread
+
 DEBUG_CFLAGS = -D_DEBUG -g -pg
 DEBUG_LDFLAGS = -pg
 RELEASE_CFLAGS = -O2 -ffast-math
@@ -13,9 +13,10 @@
 #define ERROR_INVALID_MODE -4
 #define ERROR_FILE_IO -5
 #define ERROR_MEMORY -6
+#define ERROR_OUTPUT_FULL -7
 
 #define MAX_COMMON_ERROR NO_ERROR
-#define MIN_COMMON_ERROR ERROR_MEMORY
+#define MIN_COMMON_ERROR ERROR_OUTPUT_FULL
 
 static const char * const _common_error_messages[] = { "Successful",
                                                        "Invalid value",
@@ -23,7 +24,8 @@ static const char * const _common_error_messages[] = { "Successful",
                                                        "Invalid format",
                                                        "Invalid mode",
                                                        "File I/O error",
-                                                       "Memory error" };
+                                                       "Memory error",
+                                                       "Output buffer full" };
 
 #define ERROR_LIBRARY_INIT -10
 #define ERROR_LIBRARY_CALL -11